@@ -0,0 +1,688 @@
+// Reproducible throughput numbers for tracking regressions between releases, as one JSON
+// document with a section per question:
+//   codecs   every compressor the factory knows, encode and decode across input sizes and base
+//            distributions, next to the shared kernels: the base frequency count, the byte
+//            histogram and the Huffman tree build
+//   input    two passes over a file through 64 KB std::ifstream reads, against a MappedFile
+//   cm       the context-mixing codec at several orders on repetitive input
+//   entropy  HuffmanTable against the four-lane RansTable on in-memory buffers, with one
+//            bitstream against HuffmanTable::STREAM_COUNT, and HuffmanGenome's BaseCode kernels
+// Each measurement is repeated, and the median, minimum and maximum MB/s (microseconds for the
+// tree build) are reported with bits per symbol and a round-trip check where there is one.
+//
+// Usage: compressor_bench [--sizes 1M,16M] [--repetitions 5] [--sections codecs,cm]
+//                         [--methods pack2,cm] [--orders 12,16] [--output results.json]
+
+#include "BaseClassifier.h"
+#include "BaseCode.h"
+#include "BitIO.h"
+#include "ByteHistogram.h"
+#include "CompressorFactory.h"
+#include "ContextModelGenome.h"
+#include "HuffmanTable.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include "RansTable.h"
+#include <CLI11.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const char *const ALL_METHODS[] = {"huffmangenome", "huffman", "rle", "combined", "pack2", "cm"};
+    const char BASES[] = {'A', 'C', 'G', 'T'};
+
+    // Synthetic inputs with different statistics; all are A/C/G/T only, so every codec accepts them
+    std::string generate(const std::string &distribution, size_t size)
+    {
+        std::mt19937 rng(42);
+        std::string genome;
+        genome.reserve(size);
+        if (distribution == "uniform")
+        {
+            while (genome.size() < size)
+                genome.push_back(BASES[rng() & 3]);
+        }
+        else if (distribution == "at_rich")
+        {
+            // 35% A, 35% T, 15% C, 15% G: what Huffman codes can exploit
+            std::discrete_distribution<int> pick({35, 15, 15, 35});
+            while (genome.size() < size)
+                genome.push_back(BASES[pick(rng)]);
+        }
+        else if (distribution == "repetitive")
+        {
+            // Mutated copies of earlier segments, the structure context models exploit
+            while (genome.size() < std::min<size_t>(size, 4096))
+                genome.push_back(BASES[rng() & 3]);
+            while (genome.size() < size)
+            {
+                size_t length = 500 + rng() % 5000;
+                size_t source = rng() % (genome.size() - std::min(genome.size() - 1, length));
+                for (size_t i = 0; i < length && source + i < genome.size(); ++i)
+                    genome.push_back(rng() % 50 == 0 ? BASES[rng() & 3] : genome[source + i]);
+            }
+        }
+        else
+        {
+            // Homopolymer runs of 1 to 64 bases, the case run-length coding is for
+            while (genome.size() < size)
+                genome.append(1 + rng() % 64, BASES[rng() & 3]);
+        }
+        genome.resize(size);
+        return genome;
+    }
+
+    // Swallows the codecs' progress lines while in scope
+    struct QuietOutput
+    {
+        std::ostringstream sink;
+        std::streambuf *saved;
+        QuietOutput() : saved(std::cout.rdbuf(sink.rdbuf())) {}
+        ~QuietOutput() { std::cout.rdbuf(saved); }
+    };
+
+    double seconds(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // One value per repetition, reported as median, min and max
+    struct Spread
+    {
+        std::vector<double> values;
+
+        void add(double value) { values.push_back(value); }
+
+        void addThroughput(size_t bytes, double elapsed)
+        {
+            values.push_back(static_cast<double>(bytes) / (1024.0 * 1024.0) / std::max(elapsed, 1e-9));
+        }
+
+        void write(std::ostream &out) const
+        {
+            std::vector<double> sorted = values;
+            std::sort(sorted.begin(), sorted.end());
+            size_t n = sorted.size();
+            double median = n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+            out << "{\"median\": " << median << ", \"min\": " << sorted.front() << ", \"max\": " << sorted.back()
+                << "}";
+        }
+    };
+
+
+    // Times `body` once per repetition, as MB/s over `bytes`
+    template <typename Body>
+    Spread throughput(size_t bytes, int repetitions, Body body)
+    {
+        Spread spread;
+        for (int r = 0; r < repetitions; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            body();
+            spread.addThroughput(bytes, seconds(start));
+        }
+        return spread;
+    }
+
+    double bitsPerSymbol(size_t bytes, size_t symbols)
+    {
+        return 8.0 * static_cast<double>(bytes) / static_cast<double>(std::max<size_t>(symbols, 1));
+    }
+
+    // Encode and decode of one coder on one input
+    struct Coding
+    {
+        double bitsPerSymbol = 0.0;
+        bool roundTrip = true;
+        Spread encode;
+        Spread decode;
+    };
+
+    // Results are streamed as one JSON object with an array per section, comma-separated
+    class JsonResults
+    {
+    public:
+        JsonResults(std::ostream &out, int repetitions) : out(out), first(true), open(false)
+        {
+            out << "{\n  \"repetitions\": " << repetitions;
+        }
+
+        // Starts the array `name`; the results that follow go into it
+        void section(const std::string &name)
+        {
+            close();
+            out << ",\n  \"" << name << "\": [";
+            first = true;
+            open = true;
+        }
+
+        void finish()
+        {
+            close();
+            out << "\n}\n";
+        }
+
+        void kernel(const std::string &name, const std::string &distribution, size_t bytes, const std::string &unit,
+                    const Spread &spread)
+        {
+            begin();
+            out << "{\"kernel\": \"" << name << "\", \"distribution\": \"" << distribution << "\", \"bytes\": " << bytes
+                << ", \"" << unit << "\": ";
+            spread.write(out);
+            out << "}";
+        }
+
+        void codec(const std::string &method, const std::string &distribution, size_t bytes, const Coding &coding)
+        {
+            begin();
+            out << "{\"compressor\": \"" << method << "\", \"distribution\": \"" << distribution
+                << "\", \"bytes\": " << bytes;
+            write(coding, "bits_per_base");
+        }
+
+        void contextOrder(int order, const std::string &distribution, size_t bytes, const Coding &coding)
+        {
+            begin();
+            out << "{\"order\": " << order << ", \"distribution\": \"" << distribution << "\", \"bytes\": " << bytes;
+            write(coding, "bits_per_base");
+        }
+
+        void backend(const std::string &name, const std::string &source, size_t symbols, const Coding &coding)
+        {
+            begin();
+            out << "{\"backend\": \"" << name << "\", \"source\": \"" << source << "\", \"symbols\": " << symbols;
+            write(coding, "bits_per_symbol");
+        }
+
+        void inputPath(const std::string &name, size_t bytes, bool sameData, const Spread &spread)
+        {
+            begin();
+            out << "{\"input_path\": \"" << name << "\", \"bytes\": " << bytes
+                << ", \"same_data\": " << (sameData ? "true" : "false") << ", \"mb_per_s\": ";
+            spread.write(out);
+            out << "}";
+        }
+
+    private:
+        std::ostream &out;
+        bool first;
+        bool open;
+
+        void begin()
+        {
+            out << (first ? "\n    " : ",\n    ");
+            first = false;
+        }
+
+        void close()
+        {
+            if (open)
+            {
+                out << "\n  ]";
+            }
+            open = false;
+        }
+
+        void write(const Coding &coding, const char *bitsName)
+        {
+            out << ", \"" << bitsName << "\": " << coding.bitsPerSymbol
+                << ", \"round_trip\": " << (coding.roundTrip ? "true" : "false") << ", \"encode_mb_per_s\": ";
+            coding.encode.write(out);
+            out << ", \"decode_mb_per_s\": ";
+            coding.decode.write(out);
+            out << "}";
+        }
+    };
+
+    void benchKernels(JsonResults &results, const std::string &distribution, const std::string &genome, int repetitions)
+    {
+        Spread count;
+        std::array<uint64_t, HuffmanTable::ALPHABET_SIZE> histogram{};
+        for (int r = 0; r < repetitions; ++r)
+        {
+            uint64_t counts[4] = {0, 0, 0, 0};
+            auto start = std::chrono::steady_clock::now();
+            BaseClassifier::countBases(genome.data(), genome.size(), counts);
+            count.addThroughput(genome.size(), seconds(start));
+            for (int i = 0; i < 4; ++i)
+                histogram[static_cast<unsigned char>(BASES[i])] = counts[i];
+        }
+        results.kernel("frequency_count", distribution, genome.size(), "mb_per_s", count);
+
+        Spread bytes;
+        const unsigned char *data = reinterpret_cast<const unsigned char *>(genome.data());
+        for (int r = 0; r < repetitions; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            ByteHistogram::Counts counts = ByteHistogram::count(data, genome.size(), 0);
+            bytes.addThroughput(genome.size(), seconds(start));
+            if (counts['A'] > genome.size())
+                std::cerr << "bench: impossible count\n"; // keeps the count from being optimised away
+        }
+        results.kernel("byte_histogram", distribution, genome.size(), "mb_per_s", bytes);
+
+        // The tree is tiny next to the data, so the build is timed in batches to get above clock resolution
+        const int BUILDS = 10000;
+        Spread build;
+        for (int r = 0; r < repetitions; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (int b = 0; b < BUILDS; ++b)
+            {
+                HuffmanTable table;
+                table.buildFromCounts(histogram);
+            }
+            build.add(seconds(start) / BUILDS * 1e6);
+        }
+        results.kernel("tree_build", distribution, genome.size(), "microseconds", build);
+    }
+
+    // `configure` is applied to each codec before it runs, e.g. to set the context order
+    Coding timeCodec(const std::string &method, const std::function<void(Compressor &)> &configure,
+                     const std::string &input, size_t bytes, int repetitions)
+    {
+        const std::string archive = "bench_archive.bin";
+        const std::string decoded = "bench_decoded.txt";
+        Coding coding;
+        for (int r = 0; r < repetitions; ++r)
+        {
+            std::unique_ptr<Compressor> compressor = CompressorFactory::createCompressor(method);
+            if (configure)
+            {
+                configure(*compressor);
+            }
+            {
+                QuietOutput quiet;
+                auto start = std::chrono::steady_clock::now();
+                compressor->encodeFromFile(input, archive);
+                coding.encode.addThroughput(bytes, seconds(start));
+
+                start = std::chrono::steady_clock::now();
+                compressor->decodeFromFile(archive, decoded);
+                coding.decode.addThroughput(bytes, seconds(start));
+            }
+            coding.bitsPerSymbol = bitsPerSymbol(MappedFile(archive).size(), bytes);
+            coding.roundTrip = coding.roundTrip && compressor->validateDecodedFile(input, decoded);
+        }
+        std::remove(archive.c_str());
+        std::remove(decoded.c_str());
+        return coding;
+    }
+
+    // Stand-in for the per-byte work of a pass; the checksum keeps it from being optimised away
+    uint64_t scan(const char *data, size_t size, std::array<uint64_t, 256> &counts)
+    {
+        uint64_t checksum = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            unsigned char byte = static_cast<unsigned char>(data[i]);
+            counts[byte]++;
+            checksum += byte;
+        }
+        return checksum;
+    }
+
+    // The two ways a compressor can walk its input twice (count, then encode)
+    uint64_t twoPassIfstream(const std::string &filename)
+    {
+        const size_t BUFFER_SIZE = 65536;
+        std::array<uint64_t, 256> counts{};
+        uint64_t checksum = 0;
+        std::ifstream infile(filename, std::ios::binary);
+        std::vector<char> buffer(BUFFER_SIZE);
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            while (infile.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || infile.gcount())
+            {
+                checksum += scan(buffer.data(), static_cast<size_t>(infile.gcount()), counts);
+            }
+            infile.clear();
+            infile.seekg(0, std::ios::beg);
+        }
+        return checksum;
+    }
+
+    uint64_t twoPassMapped(const std::string &filename)
+    {
+        std::array<uint64_t, 256> counts{};
+        uint64_t checksum = 0;
+        MappedFile input(filename);
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            checksum += scan(input.data(), input.size(), counts);
+        }
+        return checksum;
+    }
+
+    void benchInput(JsonResults &results, const std::string &input, size_t bytes, int repetitions)
+    {
+        // Warm the page cache so both paths measure reads from memory, not the disk
+        twoPassMapped(input);
+
+        uint64_t streamChecksum = 0;
+        uint64_t mappedChecksum = 0;
+        Spread stream = throughput(2 * bytes, repetitions, [&]() { streamChecksum = twoPassIfstream(input); });
+        Spread mapped = throughput(2 * bytes, repetitions, [&]() { mappedChecksum = twoPassMapped(input); });
+        const bool sameData = streamChecksum == mappedChecksum;
+        results.inputPath("ifstream", bytes, sameData, stream);
+        results.inputPath("mapped_file", bytes, sameData, mapped);
+    }
+
+    // Symbol source for the entropy backends
+    struct Source
+    {
+        std::string name;
+        std::vector<double> weights; // relative symbol weights, symbol = index
+    };
+
+    std::vector<unsigned char> generateSymbols(const Source &source, size_t size)
+    {
+        std::mt19937 rng(42);
+        std::discrete_distribution<int> pick(source.weights.begin(), source.weights.end());
+        std::vector<unsigned char> data(size);
+        for (unsigned char &symbol : data)
+        {
+            symbol = static_cast<unsigned char>(pick(rng));
+        }
+        return data;
+    }
+
+    // A buffer coded as HuffmanTable::STREAM_COUNT streams, one per segment
+    struct SplitStreams
+    {
+        std::vector<unsigned char> bytes;
+        uint64_t bitLengths[HuffmanTable::STREAM_COUNT];
+        const unsigned char *starts[HuffmanTable::STREAM_COUNT];
+
+        // encodeSegment(writer, begin, end) writes the codes of symbols [begin, end)
+        template <typename EncodeSegment>
+        void encode(size_t count, EncodeSegment encodeSegment)
+        {
+            bytes.clear();
+            size_t offsets[HuffmanTable::STREAM_COUNT];
+            for (int s = 0; s < HuffmanTable::STREAM_COUNT; ++s)
+            {
+                offsets[s] = bytes.size();
+                BitWriter writer(bytes);
+                encodeSegment(writer, HuffmanTable::streamOffset(count, s), HuffmanTable::streamOffset(count, s + 1));
+                bitLengths[s] = writer.bitsWritten();
+                writer.finish();
+            }
+            for (int s = 0; s < HuffmanTable::STREAM_COUNT; ++s)
+            {
+                starts[s] = bytes.data() + offsets[s];
+            }
+        }
+    };
+
+    void benchEntropy(JsonResults &results, const Source &source, size_t size, int repetitions)
+    {
+        std::vector<unsigned char> data = generateSymbols(source, size);
+        std::array<uint64_t, 256> counts{};
+        for (unsigned char symbol : data)
+        {
+            counts[symbol]++;
+        }
+        std::vector<char> decoded(size + HuffmanTable::DECODE_SLACK);
+
+        HuffmanTable huffman;
+        huffman.buildFromCounts(counts);
+        std::vector<unsigned char> bits;
+        Coding coding;
+        coding.encode = throughput(size, repetitions, [&]()
+        {
+            bits.clear();
+            BitWriter writer(bits);
+            for (unsigned char symbol : data)
+            {
+                writer.write(huffman.getCode(symbol), huffman.getLength(symbol));
+            }
+            writer.finish();
+        });
+        uint64_t bitCount = 0;
+        for (unsigned char symbol : data)
+        {
+            bitCount += static_cast<uint64_t>(huffman.getLength(symbol));
+        }
+        coding.decode = throughput(size, repetitions, [&]()
+        {
+            BitReader reader(bits.data(), bits.size(), bitCount);
+            huffman.decode(reader, decoded.data(), size);
+        });
+        coding.bitsPerSymbol = bitsPerSymbol(bits.size(), size);
+        coding.roundTrip = std::memcmp(decoded.data(), data.data(), size) == 0;
+        results.backend("huffman", source.name, size, coding);
+
+        SplitStreams split;
+        coding.encode = throughput(size, repetitions, [&]()
+        {
+            split.encode(size, [&](BitWriter &writer, size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    writer.write(huffman.getCode(data[i]), huffman.getLength(data[i]));
+                }
+            });
+        });
+        std::fill(decoded.begin(), decoded.end(), 0);
+        coding.decode = throughput(size, repetitions, [&]()
+        {
+            huffman.decodeStreams(split.starts, split.bitLengths, decoded.data(), size);
+        });
+        coding.bitsPerSymbol = bitsPerSymbol(split.bytes.size(), size);
+        coding.roundTrip = std::memcmp(decoded.data(), data.data(), size) == 0;
+        results.backend("huffman_x" + std::to_string(HuffmanTable::STREAM_COUNT), source.name, size, coding);
+
+        if (source.weights.size() == 4)
+        {
+            // The same bases as letters, through the kernels for a four-symbol code
+            std::string bases(size, 'A');
+            std::array<uint64_t, 256> baseCounts{};
+            for (size_t i = 0; i < size; ++i)
+            {
+                bases[i] = BASES[data[i]];
+                baseCounts[static_cast<unsigned char>(bases[i])]++;
+            }
+            HuffmanTable baseTable;
+            baseTable.buildFromCounts(baseCounts);
+            const BaseCode code(baseTable);
+
+            std::vector<unsigned char> baseBits;
+            uint64_t baseBitCount = 0;
+            coding.encode = throughput(size, repetitions, [&]()
+            {
+                baseBits.clear();
+                BitWriter writer(baseBits);
+                code.encode(bases.data(), size, writer);
+                baseBitCount = writer.bitsWritten();
+                writer.finish();
+            });
+            coding.decode = throughput(size, repetitions, [&]()
+            {
+                code.decode(baseBits.data(), baseBitCount, decoded.data(), size);
+            });
+            coding.bitsPerSymbol = bitsPerSymbol(baseBits.size(), size);
+            coding.roundTrip = std::memcmp(decoded.data(), bases.data(), size) == 0;
+            results.backend("base_code", source.name, size, coding);
+
+            coding.encode = throughput(size, repetitions, [&]()
+            {
+                split.encode(size, [&](BitWriter &writer, size_t begin, size_t end)
+                {
+                    code.encode(bases.data() + begin, end - begin, writer);
+                });
+            });
+            std::fill(decoded.begin(), decoded.end(), 0);
+            coding.decode = throughput(size, repetitions, [&]()
+            {
+                code.decodeStreams(split.starts, split.bitLengths, decoded.data(), size);
+            });
+            coding.bitsPerSymbol = bitsPerSymbol(split.bytes.size(), size);
+            coding.roundTrip = std::memcmp(decoded.data(), bases.data(), size) == 0;
+            results.backend("base_code_x" + std::to_string(HuffmanTable::STREAM_COUNT), source.name, size, coding);
+        }
+
+        RansTable rans;
+        rans.buildFromCounts(counts);
+        std::vector<unsigned char> stream;
+        coding.encode = throughput(size, repetitions, [&]()
+        {
+            stream.clear();
+            rans.encode(data.data(), data.size(), stream);
+        });
+        std::vector<unsigned char> output(size);
+        coding.decode = throughput(size, repetitions, [&]()
+        {
+            rans.decode(stream.data(), stream.size(), output.data(), size);
+        });
+        coding.bitsPerSymbol = bitsPerSymbol(stream.size(), size);
+        coding.roundTrip = output == data;
+        results.backend("rans", source.name, size, coding);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    CLI::App app{"Benchmarks the compressors, input paths, context orders and entropy backends; prints JSON"};
+    std::vector<size_t> sizes = {1024 * 1024, 16 * 1024 * 1024};
+    int repetitions = 5;
+    std::vector<std::string> sections = {"codecs", "input", "cm", "entropy"};
+    std::vector<std::string> methods(std::begin(ALL_METHODS), std::end(ALL_METHODS));
+    std::vector<std::string> distributions = {"uniform", "at_rich", "repetitive", "runs"};
+    std::vector<int> orders = {11, 12, 16, 20};
+    std::string outputFile;
+    app.add_option("--sizes", sizes, "Input sizes in bases, e.g. 1M,16M")
+        ->delimiter(',')
+        ->transform(CLI::AsSizeValue(false));
+    app.add_option("--repetitions", repetitions, "Timed runs per measurement")->check(CLI::PositiveNumber);
+    app.add_option("--sections", sections, "Sections to run: codecs, input, cm, entropy")
+        ->delimiter(',')
+        ->check(CLI::IsMember({"codecs", "input", "cm", "entropy"}));
+    app.add_option("--methods", methods, "Compressors to run in the codecs section")
+        ->delimiter(',')
+        ->check(CLI::IsMember({"huffmangenome", "huffman", "rle", "combined", "pack2", "cm"}));
+    app.add_option("--distributions", distributions, "Base distributions: uniform, at_rich, repetitive, runs")
+        ->delimiter(',')
+        ->check(CLI::IsMember({"uniform", "at_rich", "repetitive", "runs"}));
+    app.add_option("--orders", orders, "Context orders for the cm section")
+        ->delimiter(',')
+        ->check(CLI::Range(ContextModelGenome::MIN_ORDER, ContextModelGenome::MAX_ORDER));
+    app.add_option("--output", outputFile, "Write the JSON here instead of stdout");
+    CLI11_PARSE(app, argc, argv);
+
+    Logger::getInstance().enableLogging(false);
+
+    std::ofstream file;
+    if (!outputFile.empty())
+    {
+        file.open(outputFile);
+        if (!file)
+        {
+            std::cerr << "Error: Unable to open output file '" << outputFile << "'.\n";
+            return 1;
+        }
+    }
+    std::ostream &out = outputFile.empty() ? std::cout : file;
+    out << std::setprecision(6);
+
+    auto wanted = [&sections](const std::string &name)
+    {
+        return std::find(sections.begin(), sections.end(), name) != sections.end();
+    };
+    const std::string input = "bench_input.txt";
+    auto writeInput = [&input](const std::string &genome)
+    {
+        std::ofstream(input, std::ios::binary).write(genome.data(), static_cast<std::streamsize>(genome.size()));
+    };
+
+    JsonResults results(out, repetitions);
+    if (wanted("codecs"))
+    {
+        results.section("codecs");
+        for (size_t size : sizes)
+        {
+            for (const std::string &distribution : distributions)
+            {
+                const std::string genome = generate(distribution, size);
+                writeInput(genome);
+                std::cerr << "bench: codecs, " << size << " bases, " << distribution << "\n";
+
+                benchKernels(results, distribution, genome, repetitions);
+                for (const std::string &method : methods)
+                {
+                    results.codec(method, distribution, size, timeCodec(method, nullptr, input, size, repetitions));
+                }
+            }
+        }
+    }
+
+    if (wanted("input"))
+    {
+        results.section("input");
+        for (size_t size : sizes)
+        {
+            writeInput(generate("uniform", size));
+            std::cerr << "bench: input, " << size << " bytes\n";
+            benchInput(results, input, size, repetitions);
+        }
+    }
+
+    if (wanted("cm"))
+    {
+        // Repeats with point mutations give the high orders something to find, as in real genomes
+        results.section("cm");
+        for (size_t size : sizes)
+        {
+            writeInput(generate("repetitive", size));
+            for (int order : orders)
+            {
+                std::cerr << "bench: cm, " << size << " bases, order " << order << "\n";
+                Coding coding = timeCodec("cm", [order](Compressor &codec) { codec.setContextOrder(order); }, input,
+                                          size, repetitions);
+                results.contextOrder(order, "repetitive", size, coding);
+            }
+        }
+    }
+    std::remove(input.c_str());
+
+    if (wanted("entropy"))
+    {
+        std::vector<double> tokens(64);
+        for (size_t i = 0; i < tokens.size(); ++i)
+        {
+            tokens[i] = 1.0 / static_cast<double>((i % 16 + 1) * (i % 16 + 1)); // short runs dominate, like RLE tokens
+        }
+        const std::vector<Source> sources = {
+            {"uniform_bases", {1, 1, 1, 1}},
+            {"at_rich_bases", {0.35, 0.15, 0.15, 0.35}},
+            {"skewed_bases", {0.7, 0.1, 0.1, 0.1}},
+            {"rle_tokens", tokens},
+        };
+        results.section("entropy");
+        for (size_t size : sizes)
+        {
+            for (const Source &source : sources)
+            {
+                std::cerr << "bench: entropy, " << size << " symbols, " << source.name << "\n";
+                benchEntropy(results, source, size, repetitions);
+            }
+        }
+    }
+
+    results.finish();
+    return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef BASECLASSIFIER_H
+#define BASECLASSIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Byte classifier for genome text. Both scans stop at the first byte that is not
+// A, C, G or T (either case) and return its offset, or `size` when every byte is a
+// base. Uses SSE2/AVX2 when the CPU has them.
+class BaseClassifier {
+public:
+    static size_t findInvalid(const char* data, size_t size);
+
+    // Also adds the number of A, C, G and T before the returned offset to counts[0..3].
+    static size_t countBases(const char* data, size_t size, uint64_t counts[4]);
+
+    // Also appends the offset of every case change to `caseToggles`, taking the byte
+    // before data[0] as upper case. Feeds a CaseMask.
+    static size_t countBases(const char* data, size_t size, uint64_t counts[4], std::vector<uint64_t>& caseToggles);
+};
+
+#endif
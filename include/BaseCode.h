@@ -0,0 +1,60 @@
+#ifndef BASECODE_H
+#define BASECODE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "BitIO.h"
+#include "HuffmanTable.h"
+
+// Kernels for a Huffman code over A, C, G and T. Such a code has one of two shapes:
+// balanced, every base 2 bits, which is plain 2-bit packing; or variable, which covers
+// (1,2,3,3) and the codes of fewer than four bases, all at most 3 bits. The shape is
+// fixed when the code is built, and each has its own encode and decode loop.
+class BaseCode {
+public:
+    BaseCode();
+    // Codes and lengths are taken from `table`, keyed 'A', 'C', 'G', 'T'
+    explicit BaseCode(const HuffmanTable& table);
+
+    bool isBalanced() const { return balanced; }
+
+    // Appends the codes of bases[0, count) to `writer`. Every byte must be A, C, G or T,
+    // in either case.
+    void encode(const char* bases, size_t count, BitWriter& writer) const;
+
+    // Decodes the `bitLength` bits at `data` into upper-case bases and returns how many there
+    // were. `output` needs room for maxBases + HuffmanTable::DECODE_SLACK bytes. Throws if
+    // the bits are not a sequence of codes or hold more than maxBases bases.
+    size_t decode(const unsigned char* data, uint64_t bitLength, char* output, size_t maxBases) const;
+
+    // The same for a block of `count` bases coded as HuffmanTable::STREAM_COUNT streams,
+    // one per segment; the variable shape decodes all of them in one loop.
+    size_t decodeStreams(const unsigned char* const* streams, const uint64_t* bitLengths, char* output, size_t count) const;
+
+private:
+    static const int MAX_BASES_PER_BYTE = 8;
+
+    // The complete codes at the front of one byte of the stream
+    struct ByteEntry {
+        char bases[MAX_BASES_PER_BYTE];
+        unsigned char count;
+        unsigned char bits; // 0 if the byte starts with a bit pattern that is not a code
+    };
+
+    bool balanced;
+    std::array<unsigned char, 256> baseIndex;   // byte -> 0..3 for A, C, G, T in either case
+    std::array<uint32_t, 4> codes;
+    std::array<unsigned char, 4> lengths;
+    std::array<uint16_t, 256> quadCodes;        // four base indices, 2 bits each -> their codes
+    std::array<unsigned char, 256> quadLengths;
+    std::array<ByteEntry, 256> byteEntries;
+
+    template <bool Balanced>
+    void encodeShape(const unsigned char* bases, size_t count, BitWriter& writer) const;
+    size_t decodeBalanced(const unsigned char* data, uint64_t bitLength, char* output, size_t maxBases) const;
+    // Decodes the rest of `reader` into output[outPos, end), never writing past `end`
+    size_t decodeVariable(BitReader& reader, char* output, size_t outPos, size_t end) const;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "CompressionMetrics.h"
+#include "Compressor.h"
+
+// Compresses or decompresses many files in one process. Files are handed out
+// largest first to a pool of workers; each worker keeps its codecs for all of
+// its files, and per-file status output is silenced. Each file's codec runs
+// single-threaded, since the parallelism is across files.
+class BatchRunner {
+public:
+    enum class Mode {
+        Compress,
+        Decompress
+    };
+
+    // Outcome of one file
+    struct Job {
+        std::string input;
+        std::string output;
+        uint64_t bytes;        // input file size
+        bool succeeded;
+        double seconds;
+        CompressionMetrics metrics;
+    };
+
+    // Compressed files are named <input name>.<method> in `outputDirectory`; decompression
+    // drops that suffix again, or appends ".out" when the name does not have it.
+    BatchRunner(Mode mode, const std::string& method, const std::string& outputDirectory);
+
+    // Workers across files; 0 means one per hardware core
+    void setThreadCount(unsigned int threads);
+
+    // Applied to every codec before its first file, e.g. to set the block size
+    void setConfigure(const std::function<void(Compressor&)>& configure);
+
+    // Files named by `spec`: every regular file in a directory, the files matching a
+    // glob with * and ? in its last component, or the paths listed in a manifest file,
+    // one per line (blank lines and lines starting with '#' are skipped). With
+    // `directorySuffix`, a directory contributes only the files whose names end in it.
+    // Throws std::runtime_error if nothing matches.
+    static std::vector<std::string> expandInputs(const std::string& spec, const std::string& directorySuffix = "");
+
+    // Runs every file and returns the outcomes in the order of `inputs`. Archives of codecs
+    // with in-memory coding are decoded through it, so a corrupt one fails instead of
+    // leaving a partial output.
+    std::vector<Job> run(const std::vector<std::string>& inputs);
+
+    // Wall time of the last run, from the first file started to the last one finished
+    double getWallSeconds() const;
+
+    // Tab-separated table of the outcomes, one line per file and a totals line. Workers
+    // overlap, so the totals line shows `wallSeconds` rather than the sum of the files.
+    static void writeReport(const std::vector<Job>& jobs, double wallSeconds, std::ostream& out);
+
+private:
+    Mode mode;
+    std::string method;
+    std::string outputDirectory;
+    unsigned int threadCount;
+    std::function<void(Compressor&)> configure;
+    double wallSeconds;
+
+    std::string outputName(const std::string& input) const;
+};
+
+#endif
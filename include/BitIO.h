@@ -0,0 +1,257 @@
+#ifndef BITIO_H
+#define BITIO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <vector>
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
+
+namespace BitIO
+{
+    inline uint64_t toBigEndian(uint64_t word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_bswap64(word);
+#elif defined(_MSC_VER)
+        return _byteswap_uint64(word);
+#else
+        uint64_t result = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            result = (result << 8) | ((word >> (i * 8)) & 0xFF);
+        }
+        return result;
+#endif
+    }
+
+    // Fixed-width little-endian integers for archive headers and index tables
+    inline void writeUInt(std::ostream& out, uint64_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; ++i)
+        {
+            out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    inline uint64_t readUInt(std::istream& in, int bytes)
+    {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i)
+        {
+            char byte;
+            if (!in.get(byte))
+            {
+                throw std::runtime_error("Error: Unexpected end of archive header.");
+            }
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(byte)) << (8 * i);
+        }
+        return value;
+    }
+
+    // LEB128 varints for side streams dominated by small numbers
+    inline void writeVarint(std::vector<unsigned char>& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<unsigned char>(value));
+    }
+
+    inline uint64_t readVarint(const unsigned char* data, size_t size, size_t& pos)
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (pos >= size)
+            {
+                throw std::runtime_error("Error: Truncated varint in archive.");
+            }
+            unsigned char byte = data[pos++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+            {
+                return value;
+            }
+        }
+        throw std::runtime_error("Error: Varint overflows in archive.");
+    }
+
+    // Same encoding read from memory, e.g. a mapped archive; the caller checks bounds
+    inline uint64_t readUInt(const unsigned char* data, int bytes)
+    {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i)
+        {
+            value |= static_cast<uint64_t>(data[i]) << (8 * i);
+        }
+        return value;
+    }
+}
+
+// Read-only stream buffer over a memory range, so std::istream parsers can read
+// headers straight out of a mapped archive.
+class MemoryStreamBuf : public std::streambuf {
+public:
+    MemoryStreamBuf(const unsigned char* data, size_t size)
+    {
+        char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+        setg(begin, begin, begin + size);
+    }
+
+    // Bytes consumed so far
+    size_t position() const { return static_cast<size_t>(gptr() - eback()); }
+};
+
+// MSB-first bit writer. Codes go in as (bits, length) integers and collect in a
+// 64-bit register; each full register is stored as 8 bytes into a large
+// buffer that is handed to the stream only when it fills up.
+class BitWriter {
+public:
+    static const size_t DEFAULT_BUFFER_SIZE = 1 << 20;
+
+    // Streams whole buffers to `out`.
+    explicit BitWriter(std::ostream& out, size_t bufferSize = DEFAULT_BUFFER_SIZE)
+        : sink_(&out), buffer_(ownBuffer_), flushThreshold_(bufferSize), accumulator_(0), bitCount_(0), bitsWritten_(0)
+    {
+        buffer_.reserve(bufferSize + sizeof(uint64_t));
+    }
+
+    // Appends everything to `out`; nothing is written until the caller does so.
+    explicit BitWriter(std::vector<unsigned char>& out)
+        : sink_(nullptr), buffer_(out), flushThreshold_(0), accumulator_(0), bitCount_(0), bitsWritten_(0) {}
+
+    BitWriter(const BitWriter&) = delete;
+    BitWriter& operator=(const BitWriter&) = delete;
+
+    // Appends the low `length` bits of `bits` (1 <= length <= 32), most significant first.
+    inline void write(uint32_t bits, int length)
+    {
+        bitsWritten_ += static_cast<uint64_t>(length);
+        int freeBits = 64 - bitCount_;
+        if (length < freeBits)
+        {
+            accumulator_ |= static_cast<uint64_t>(bits) << (freeBits - length);
+            bitCount_ += length;
+            return;
+        }
+        // Fill the register, store it, and carry the remaining low bits over
+        int carry = length - freeBits;
+        accumulator_ |= static_cast<uint64_t>(bits) >> carry;
+        storeWord();
+        if (carry > 0)
+        {
+            accumulator_ = static_cast<uint64_t>(bits) << (64 - carry);
+            bitCount_ = carry;
+        }
+    }
+
+    // Pads the last byte with zero bits and flushes. Returns the number of padding bits (0-7).
+    int finish()
+    {
+        int paddingBits = (8 - (bitCount_ & 7)) & 7;
+        uint64_t word = BitIO::toBigEndian(accumulator_);
+        size_t tailBytes = static_cast<size_t>((bitCount_ + 7) >> 3);
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&word);
+        buffer_.insert(buffer_.end(), bytes, bytes + tailBytes);
+        accumulator_ = 0;
+        bitCount_ = 0;
+        flushBuffer();
+        return paddingBits;
+    }
+
+    uint64_t bitsWritten() const { return bitsWritten_; }
+
+private:
+    inline void storeWord()
+    {
+        uint64_t word = BitIO::toBigEndian(accumulator_);
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&word);
+        buffer_.insert(buffer_.end(), bytes, bytes + sizeof(word));
+        accumulator_ = 0;
+        bitCount_ = 0;
+        if (sink_ && buffer_.size() >= flushThreshold_)
+        {
+            flushBuffer();
+        }
+    }
+
+    void flushBuffer()
+    {
+        if (sink_ && !buffer_.empty())
+        {
+            sink_->write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+            buffer_.clear();
+        }
+    }
+
+    std::ostream* sink_;
+    std::vector<unsigned char> ownBuffer_;
+    std::vector<unsigned char>& buffer_;
+    size_t flushThreshold_;
+    uint64_t accumulator_;
+    int bitCount_;
+    uint64_t bitsWritten_;
+};
+
+// MSB-first bit reader over an in-memory buffer. Keeps up to 64 bits in a
+// register so callers can peek a whole lookup index and consume a variable
+// number of bits without touching memory on every bit.
+class BitReader {
+public:
+    BitReader(const unsigned char* data, size_t size, uint64_t bitCount)
+        : data_(data), size_(size), pos_(0), window_(0), windowBits_(0), bitsRemaining_(bitCount) {}
+
+    // Tops the window up to at least 56 bits (fewer only at the end of the buffer).
+    inline void refill()
+    {
+        if (pos_ + 8 <= size_)
+        {
+            uint64_t word;
+            std::memcpy(&word, data_ + pos_, sizeof(word));
+            word = BitIO::toBigEndian(word);
+            window_ |= word >> windowBits_;
+            pos_ += (63 - windowBits_) >> 3;
+            windowBits_ |= 56;
+            return;
+        }
+        while (windowBits_ <= 56 && pos_ < size_)
+        {
+            window_ |= static_cast<uint64_t>(data_[pos_++]) << (56 - windowBits_);
+            windowBits_ += 8;
+        }
+    }
+
+    // Returns the next n bits (1 <= n <= 32) without consuming them; bits past the end read as 0.
+    inline uint32_t peek(int n) const
+    {
+        return static_cast<uint32_t>(window_ >> (64 - n));
+    }
+
+    inline void consume(int n)
+    {
+        window_ <<= n;
+        windowBits_ -= n;
+        bitsRemaining_ -= static_cast<uint64_t>(n);
+    }
+
+    uint64_t bitsRemaining() const { return bitsRemaining_; }
+
+private:
+    const unsigned char* data_;
+    size_t size_;
+    size_t pos_;
+    uint64_t window_;
+    int windowBits_;
+    uint64_t bitsRemaining_;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef BYTEHISTOGRAM_H
+#define BYTEHISTOGRAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Byte frequencies with 64-bit counts, shared by every frequency pass. Reads 8 bytes
+// per load and spreads them over four sub-histograms, so a run of equal bytes does
+// not serialise on one counter's store. Large inputs are split across threads.
+class ByteHistogram {
+public:
+    using Counts = std::array<uint64_t, 256>;
+
+    // Inputs smaller than this are counted on the calling thread
+    static const size_t PARALLEL_THRESHOLD = 1 << 20;
+
+    // `threads` as for ThreadPool; 0 means one per hardware core
+    static Counts count(const unsigned char* data, size_t size, unsigned int threads = 1);
+
+    // Adds the bytes of data[0, size) to `counts` on the calling thread
+    static void add(const unsigned char* data, size_t size, Counts& counts);
+};
+
+#endif
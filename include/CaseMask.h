@@ -0,0 +1,37 @@
+#ifndef CASEMASK_H
+#define CASEMASK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Lower-case (soft-masked) stretches of a sequence, kept as the positions where the
+// case changes; the sequence starts in upper case. Codecs store bases in upper case
+// and apply the mask on decode. Serialized as varint gaps between toggles, rANS coded
+// when that comes out smaller, so a typical genome's mask costs a few bytes per interval.
+class CaseMask {
+public:
+    // Appends toggles found by BaseClassifier::countBases in a piece of the sequence that
+    // starts at `start`. Pieces must be added in order; each one assumed upper case before it.
+    void addToggles(const std::vector<uint64_t>& pieceToggles, uint64_t start);
+
+    // Appends one toggle; positions must increase
+    void addToggle(uint64_t position) { toggles.push_back(position); }
+
+    bool empty() const { return toggles.empty(); }
+    size_t toggleCount() const { return toggles.size(); }
+
+    // Empty output for an empty mask
+    void serialize(std::vector<unsigned char>& out) const;
+
+    // Throws std::runtime_error unless the bytes are a well-formed mask of at most `length` bases
+    static CaseMask parse(const unsigned char* data, size_t size, uint64_t length);
+
+    // Lower-cases the masked bases of output[0, count), which holds the sequence from `start`
+    void apply(uint64_t start, char* output, size_t count) const;
+
+private:
+    std::vector<uint64_t> toggles;
+};
+
+#endif
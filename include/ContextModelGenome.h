@@ -0,0 +1,51 @@
+#ifndef CONTEXTMODELGENOME_H
+#define CONTEXTMODELGENOME_H
+
+#include <string>
+#include <cstddef>
+#include "CompressionMetrics.h"
+#include "Compressor.h"
+
+// Context-mixing codec for the maximum-ratio tier. Each base is coded as two
+// binary decisions by an arithmetic coder. Every decision is predicted from
+// the preceding bases under several context orders, up to the configured order
+// k. A small neural mixer combines the predictions. This is much slower than the
+// Huffman codecs, but repetitive genomes come out well under 2 bits per base.
+class ContextModelGenome : public Compressor {
+public:
+    static const int DEFAULT_ORDER = 16;
+    static const int MIN_ORDER = 1;
+    static const int MAX_ORDER = 24;
+
+    // Orders above 11 share a hashed table of 2^TABLE_BITS contexts (16 bytes each),
+    // so memory stays bounded no matter how long the input is
+    static const int TABLE_BITS = 22;
+
+    ContextModelGenome();
+    virtual ~ContextModelGenome() = default;
+
+    void encodeFromFile(const std::string& inputFilename, const std::string& outputFilename) override;
+    void decodeFromFile(const std::string& inputFilename, const std::string& outputFilename) override;
+    CompressionMetrics getMetrics() const override;
+    bool validateDecodedFile(const std::string& originalFilename, const std::string& decodedFilename) override;
+    bool validateInputFile(const std::string& inputFilename) const override;
+
+    // Highest context order used when encoding; the decoder reads it from the archive
+    void setContextOrder(int order) override;
+    int getContextOrder() const;
+
+    // The model is sequential, so ranges fall back to decoding the whole sequence
+    bool supportsSequenceCoding() const override { return true; }
+    bool encodeSequence(const char* bases, size_t count, std::ostream& out, const std::string& sourceName) override;
+    void decodeSequence(const unsigned char* archive, size_t size, std::ostream& out) override;
+
+private:
+    CompressionMetrics metrics;
+    int contextOrder;
+
+    // Extension and existence checks; the content is checked during encoding
+    bool validateInputPath(const std::string& inputFilename) const;
+    void reportInvalidBase(const std::string& inputFilename, size_t offset, char ch) const;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef EXCEPTIONSTREAM_H
+#define EXCEPTIONSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// N and the other IUPAC ambiguity codes of a sequence, kept out of a codec's
+// 4-symbol core stream as runs of one symbol. Positions count bases of the full
+// sequence; the core stream holds every other base in order. Serialized as
+// varints (run count, then per run the gap since the previous run, its length
+// and its symbol), so a gap of millions of Ns costs a few bytes.
+class ExceptionStream {
+public:
+    struct Run {
+        uint64_t position;  // first base of the run in the full sequence
+        uint64_t length;
+        char symbol;
+    };
+
+    // N, R, Y, S, W, K, M, B, D, H and V in either case
+    static bool isExceptionSymbol(char ch);
+
+    // Moves the bases of data[0, size) into `core` and records the exception symbols as runs.
+    // `offset` is the position of data[0] in the full sequence, so a sequence can be split a
+    // chunk at a time. Returns size, or the offset of the first byte that is neither.
+    size_t split(const char* data, size_t size, uint64_t offset, std::string& core);
+
+    // Records `length` copies of `symbol` at `position`, extending the last run where it can
+    void addRun(uint64_t position, uint64_t length, char symbol);
+
+    bool empty() const { return runs.empty(); }
+    const std::vector<Run>& getRuns() const { return runs; }
+    uint64_t exceptionBases() const { return totalExceptionBases; }
+
+    void serialize(std::vector<unsigned char>& out) const;
+
+    // Throws std::runtime_error if the bytes are not a well-formed stream
+    static ExceptionStream parse(const unsigned char* data, size_t size);
+
+    // Length of the full sequence around `coreBases` core bases; throws if the runs do not fit in it
+    uint64_t sequenceLength(uint64_t coreBases) const;
+
+    // Number of core bases before `position` of the full sequence
+    uint64_t corePosition(uint64_t position) const;
+
+    // Fills output[0, length) with the full sequence from `start`; `core` holds the core
+    // bases from corePosition(start) on
+    void merge(const char* core, uint64_t start, uint64_t length, char* output) const;
+
+    // Interleaves the runs with core bases written in order, for decoders that stream
+    class Writer {
+    public:
+        Writer(const ExceptionStream& exceptions, std::ostream& out);
+
+        void write(const char* core, size_t count);
+
+        // Writes the runs after the last core base
+        void finish();
+
+    private:
+        const std::vector<Run>& runs;
+        std::ostream& out;
+        size_t nextRun;
+        uint64_t position;
+
+        void writeRun(const Run& run);
+    };
+
+private:
+    std::vector<Run> runs;
+    std::vector<uint64_t> basesBefore; // exception bases before each run
+    uint64_t totalExceptionBases = 0;
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef FASTACOMPRESSOR_H
+#define FASTACOMPRESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "CompressionMetrics.h"
+#include "Compressor.h"
+
+// Container for multi-record FASTA files. Headers and the line layout of every
+// record go into a small side stream; the bases of all records, concatenated, go
+// through a nucleotide codec (huffmangenome, pack2 or cm) in one sequence stream.
+// Decoding rebuilds the original file byte for byte, and a single record can be
+// extracted by name without decoding the others where the codec has a block index.
+class FastaCompressor : public Compressor {
+public:
+    // `method` names the codec for the sequence stream when encoding. Decoding uses
+    // the codec recorded in the archive.
+    explicit FastaCompressor(const std::string& method);
+    virtual ~FastaCompressor() = default;
+
+    void encodeFromFile(const std::string& inputFilename, const std::string& outputFilename) override;
+    void decodeFromFile(const std::string& inputFilename, const std::string& outputFilename) override;
+    CompressionMetrics getMetrics() const override;
+    bool validateDecodedFile(const std::string& originalFilename, const std::string& decodedFilename) override;
+    bool validateInputFile(const std::string& inputFilename) const override;
+
+    // Forwarded to the sequence codec
+    void setThreadCount(unsigned int threads) override;
+    void setBlockSize(size_t blockSize) override;
+    void setContextOrder(int order) override;
+    void setEntropyCoder(EntropyCoder coder) override;
+    void setModelScope(ModelScope scope) override;
+    void setStreamCount(unsigned int streams) override;
+    void setMemoryLimit(size_t bytes) override;
+
+    // Range over the bases of all records, concatenated in file order
+    std::string decodeRange(const std::string& archiveFilename, uint64_t start, uint64_t length) override;
+
+    // In memory the "sequence" is FASTA text: encodeSequence writes a complete container
+    // archive of it, and decodeSequence gives the text back. Stream frames use this.
+    bool supportsSequenceCoding() const override { return true; }
+    bool encodeSequence(const char* text, size_t size, std::ostream& out, const std::string& sourceName) override;
+    void decodeSequence(const unsigned char* archive, size_t size, std::ostream& out) override;
+
+    // One record as FASTA text, with its original header and line layout. `name` is the
+    // first word of the header line. Throws if no record has that name.
+    std::string extractRecord(const std::string& archiveFilename, const std::string& name);
+
+    // True if the file starts with the container's magic bytes
+    static bool isFastaArchive(const std::string& filename);
+
+private:
+    // Layout of one record; line lengths are run-length coded as (length, repeat) pairs
+    struct Record {
+        std::string header;    // header line without '>' and line terminator
+        uint64_t start;        // first base in the sequence stream
+        uint64_t length;       // bases in the record
+        std::vector<std::pair<uint64_t, uint64_t>> lineRuns;
+    };
+
+    // Everything but the sequence stream, parsed from a mapped archive
+    struct Layout {
+        bool crlf;             // lines end in "\r\n" instead of "\n"
+        bool finalTerminator;  // the last line of the file has a terminator
+        std::string method;
+        std::vector<Record> records;
+        const unsigned char* sequence;
+        size_t sequenceSize;
+    };
+
+    std::string method;
+    std::unique_ptr<Compressor> codec;
+    unsigned int threadCount;
+    size_t blockSize;
+    int contextOrder;
+    EntropyCoder entropyCoder;
+    bool entropyCoderSet;
+    ModelScope modelScope;
+    unsigned int streamCount;
+    size_t memoryLimit;
+    CompressionMetrics metrics;
+
+    bool validateInputPath(const std::string& inputFilename) const;
+    Layout readLayout(const unsigned char* bytes, size_t size, const std::string& archiveName) const;
+
+    // Codec for `name` with the forwarded settings applied
+    std::unique_ptr<Compressor> createCodec(const std::string& name) const;
+
+    // Stream buffer that takes the bases of a run of records, in order, and writes their
+    // headers and sequence lines as FASTA text, so decoding never holds the whole sequence
+    class RecordWriter;
+};
+
+#endif
@@ -5,16 +5,24 @@
 #include <string>
 #include <queue>
 #include <array>
+#include <cstdint>
 #include "CompressionMetrics.h"
 #include "Compressor.h"
+#include "BaseCode.h"
+#include "HuffmanTable.h"
+#include "RansTable.h"
+#include "ExceptionStream.h"
+#include "CaseMask.h"
+
+class MappedFile;
 
 struct HuffmanGenomeNode {
     char character;
-    int frequency;
+    uint64_t frequency;
     HuffmanGenomeNode* left;
     HuffmanGenomeNode* right;
 
-    HuffmanGenomeNode(char ch, int freq) 
+    HuffmanGenomeNode(char ch, uint64_t freq) 
         : character(ch), frequency(freq), left(nullptr), right(nullptr) {}
 };
 
@@ -42,22 +50,101 @@ public:
     CompressionMetrics getMetrics() const override;
     bool validateDecodedFile(const std::string& originalFilename, const std::string& decodedFilename) override;
 
+    // Looks up the covering blocks in the block index and decodes only those
+    std::string decodeRange(const std::string& archiveFilename, uint64_t start, uint64_t length) override;
+
+    bool supportsSequenceCoding() const override { return true; }
+    bool encodeSequence(const char* bases, size_t count, std::ostream& out, const std::string& sourceName) override;
+    void decodeSequence(const unsigned char* archive, size_t size, std::ostream& out) override;
+    std::string decodeSequenceRange(const unsigned char* archive, size_t size, uint64_t start, uint64_t length) override;
+
     void printCodes() const;
     void saveFrequencyMap(const std::string& filename) const;
     void loadFrequencyMap(const std::string& filename);
 
     bool validateInputFile(const std::string& inputFilename) const override;
+
+    // Input is split into blocks of this many bases that are encoded and decoded in parallel
+    static const size_t DEFAULT_BLOCK_SIZE = 4 * 1024 * 1024;
+    void setThreadCount(unsigned int threads) override;
+    void setBlockSize(size_t bases) override;
+    void setEntropyCoder(EntropyCoder coder) override;
+    void setModelScope(ModelScope scope) override;
+    // 1 or HuffmanTable::STREAM_COUNT; rANS blocks are always one stream of interleaved states
+    void setStreamCount(unsigned int streams) override;
+    // Caps the decoded blocks held at once, and so the batch decoded in parallel. Throws
+    // at decode time if one block of the archive does not fit.
+    void setMemoryLimit(size_t bytes) override;
+
     enum GenomeBase { A = 0, C, G, T, BASE_COUNT };
-    std::array<unsigned int, BASE_COUNT> frequencyMap;
+    std::array<uint64_t, BASE_COUNT> frequencyMap;
 
 private:
 
+    // Extension and existence checks; the content is checked while counting
+    bool validateInputPath(const std::string& inputFilename) const;
+    void reportInvalidBase(const std::string& inputFilename, size_t offset, char ch) const;
+
     void buildTree();
-    void generateCodes(HuffmanGenomeNode* node, const std::string& code);
+    void generateCodeLengths(HuffmanGenomeNode* node, int depth, std::array<unsigned char, 256>& lengths);
     void deleteTree(HuffmanGenomeNode* node);
 
     HuffmanGenomeNode* root;
-    std::array<std::string, 4> huffmanCodes; 
+    HuffmanTable codeTable; // Canonical codes keyed by 'A', 'C', 'G', 'T'
+    RansTable ransTable;    // Normalized frequencies keyed the same way
+    EntropyCoder entropyCoder;
+    ModelScope modelScope;
+    unsigned int streamCount;
+    unsigned int threadCount;
+    size_t blockSize;
+    size_t memoryLimit; // 0 means no limit
+
+    // One row of the block offset table at the end of the archive
+    struct BlockEntry {
+        uint64_t offset;    // byte offset of the block from the start of the archive
+        uint64_t bitLength; // payload bits, excluding the block's model and the padding of the last byte;
+                            // with split streams, the bytes of the stream table and the streams
+    };
+
+    // Header and footer fields of an archive, checked against its size
+    struct ArchiveLayout {
+        bool useRans;
+        bool blockModels;       // each block starts with its own code table
+        bool splitStreams;      // each Huffman block is HuffmanTable::STREAM_COUNT bitstreams
+        uint64_t blockSize;
+        uint64_t totalBases;    // core bases in the blocks
+        uint64_t sequenceBases; // core bases plus exception runs
+        uint64_t blockCount;
+        uint64_t indexOffset;
+        ExceptionStream exceptions;
+        CaseMask caseMask;      // over the core bases
+        BaseCode code;          // the header's Huffman code
+    };
+
+    // Validates the header and footer and rebuilds the code table from the header
+    ArchiveLayout readArchiveLayout(const unsigned char* bytes, uint64_t size, const std::string& inputFilename);
+    BlockEntry readBlockEntry(const unsigned char* bytes, const ArchiveLayout& layout, uint64_t block,
+                              const std::string& inputFilename) const;
+    uint64_t blockBases(const ArchiveLayout& layout, uint64_t block) const;
+
+    // With `mapping`, the pages of each batch of blocks are released once it is written
+    void decodeArchive(const unsigned char* bytes, uint64_t size, std::ostream& out, const std::string& archiveName,
+                       const MappedFile* mapping);
+    std::string decodeArchiveRange(const unsigned char* bytes, uint64_t size, uint64_t start, uint64_t length,
+                                   const std::string& archiveName);
+    std::string decodeCoreRange(const unsigned char* bytes, const ArchiveLayout& layout, uint64_t start, uint64_t length,
+                                const std::string& archiveName) const;
+
+    // Appends the Huffman payload of one block to `out` and returns its bit length
+    uint64_t encodePayload(const BaseCode& code, const char* bases, size_t count, std::vector<unsigned char>& out) const;
+
+    // Counts-derived code for one block, written to `out` ahead of the block's payload
+    void encodeBlockModel(const char* bases, size_t count, const std::array<uint64_t, BASE_COUNT>& counts,
+                          std::vector<unsigned char>& out, uint64_t& payloadBits) const;
+
+    // Decodes one whole block; `output` needs room for it plus HuffmanTable::DECODE_SLACK
+    void decodeBlock(const unsigned char* bytes, const ArchiveLayout& layout, const BlockEntry& entry,
+                     uint64_t block, char* output) const;
     std::string encodedSequence;
     
 
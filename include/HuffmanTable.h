@@ -0,0 +1,88 @@
+#ifndef HUFFMANTABLE_H
+#define HUFFMANTABLE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include "BitIO.h"
+
+// Canonical, length-limited Huffman code over a byte alphabet, stored in flat
+// 256-entry arrays, plus a multi-symbol decode table indexed by the next
+// LOOKUP_BITS bits of the stream.
+class HuffmanTable {
+public:
+    static const int MAX_CODE_LENGTH = 12;
+    static const int LOOKUP_BITS = MAX_CODE_LENGTH;
+    static const int MAX_SYMBOLS_PER_ENTRY = 4;
+    static const int ALPHABET_SIZE = 256;
+
+    // One probe of the decode table yields up to MAX_SYMBOLS_PER_ENTRY symbols.
+    // totalBits == 0 marks a bit pattern that no code starts with.
+    struct DecodeEntry {
+        unsigned char symbols[MAX_SYMBOLS_PER_ENTRY];
+        unsigned char symbolCount;
+        unsigned char totalBits;
+        unsigned char firstBits; // length of symbols[0] alone, used near the end of the stream
+        unsigned char reserved;
+    };
+
+    HuffmanTable();
+
+    // Clamps lengths to maxLength, then lengthens the longest codes still below maxLength until the Kraft
+    // inequality holds again, and shortens the longest codes while that leaves it holding.
+    static void limitCodeLengths(std::array<unsigned char, ALPHABET_SIZE>& lengths, int maxLength = MAX_CODE_LENGTH);
+
+    // Assigns canonical codes (shorter first, ties by symbol value) and builds the decode table.
+    void buildFromLengths(const std::array<unsigned char, ALPHABET_SIZE>& lengths);
+
+    // Builds a Huffman code from symbol counts, limited to MAX_CODE_LENGTH. A lone symbol gets a 1-bit code.
+    void buildFromCounts(const std::array<uint64_t, ALPHABET_SIZE>& counts);
+
+    void clear();
+    bool empty() const { return decodeTable.empty(); }
+
+    uint32_t getCode(unsigned char symbol) const { return codes[symbol]; }
+    int getLength(unsigned char symbol) const { return lengths[symbol]; }
+    const std::array<unsigned char, ALPHABET_SIZE>& getLengths() const { return lengths; }
+
+    inline const DecodeEntry& lookup(uint32_t bits) const { return decodeTable[bits]; }
+
+    // Decodes every remaining bit of `reader` into `out`. Returns the number of symbols written.
+    uint64_t decode(BitReader& reader, std::ostream& out) const;
+
+    // Decodes every remaining bit of `reader` into memory. `output` needs room for
+    // maxSymbols + DECODE_SLACK bytes; throws if the stream holds more than maxSymbols.
+    size_t decode(BitReader& reader, char* output, size_t maxSymbols) const;
+    static const size_t DECODE_SLACK = 4 * MAX_SYMBOLS_PER_ENTRY;
+
+    // A block can also be coded as STREAM_COUNT bitstreams, one per contiguous segment of
+    // its symbols, so the decoder has that many independent chains to overlap. Segment s
+    // of a count-symbol block starts at streamOffset(count, s) and ends at the next one.
+    static const int STREAM_COUNT = 4;
+    static size_t streamOffset(size_t count, int stream) {
+        return std::min(count, static_cast<size_t>(stream) * ((count + STREAM_COUNT - 1) / STREAM_COUNT));
+    }
+
+    // Decodes streams[s], bitLengths[s] bits long, into segment s of `output`, all in one
+    // loop. `output` needs room for count + DECODE_SLACK bytes. Returns the number of
+    // symbols written; throws if a stream holds more than its segment.
+    size_t decodeStreams(const unsigned char* const* streams, const uint64_t* bitLengths, char* output, size_t count) const;
+
+    // Code lengths as an in-band header: u16 symbol count, then either the used symbols
+    // followed by their nibble-packed lengths, or 128 bytes of nibble-packed lengths for all 256.
+    void writeLengths(std::ostream& out) const;
+    static std::array<unsigned char, ALPHABET_SIZE> readLengths(std::istream& in);
+
+private:
+    // Decodes the rest of `reader` into output[outPos, end), never writing past `end`
+    size_t decodeSegment(BitReader& reader, char* output, size_t outPos, size_t end) const;
+
+    std::array<uint32_t, ALPHABET_SIZE> codes;
+    std::array<unsigned char, ALPHABET_SIZE> lengths;
+    std::vector<DecodeEntry> decodeTable;
+};
+
+#endif
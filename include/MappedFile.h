@@ -0,0 +1,38 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. On POSIX systems the file is memory-mapped, so
+// repeated passes over the input read straight from the page cache without copies;
+// elsewhere the contents are read into memory once.
+class MappedFile {
+public:
+    enum class Access { Sequential, Random };
+
+    explicit MappedFile(const std::string& filename, Access access = Access::Sequential);
+    ~MappedFile();
+
+    const char* data() const { return data_; }
+    const unsigned char* bytes() const { return reinterpret_cast<const unsigned char*>(data_); }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Drops the pages of [offset, offset + length) from the process's resident set once
+    // they have been read; touching them again reads them back in. Does nothing for
+    // files that were read into memory.
+    void release(size_t offset, size_t length) const;
+
+private:
+    const char* data_;
+    size_t size_;
+    bool mapped_;
+    std::vector<char> fallback_;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef PACK2GENOME_H
+#define PACK2GENOME_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "CompressionMetrics.h"
+#include "Compressor.h"
+#include "ExceptionStream.h"
+#include "CaseMask.h"
+
+// Fixed-rate codec: every base takes exactly 2 bits (A=00, C=01, G=10, T=11),
+// four bases per byte with the first base in the low bits. N and other ambiguity
+// codes go to an exception stream instead, and lower-case stretches to a case mask.
+// The packing kernels use SSSE3/AVX2 when the CPU has them and a lookup table otherwise.
+class Pack2Genome : public Compressor {
+public:
+    Pack2Genome();
+    virtual ~Pack2Genome() = default;
+
+    void encodeFromFile(const std::string& inputFilename, const std::string& outputFilename) override;
+    void decodeFromFile(const std::string& inputFilename, const std::string& outputFilename) override;
+    CompressionMetrics getMetrics() const override;
+    bool validateDecodedFile(const std::string& originalFilename, const std::string& decodedFilename) override;
+    bool validateInputFile(const std::string& inputFilename) const override;
+
+    // Every base sits at a fixed bit offset, so a range is unpacked straight out of the archive
+    std::string decodeRange(const std::string& archiveFilename, uint64_t start, uint64_t length) override;
+
+    bool supportsSequenceCoding() const override { return true; }
+    bool encodeSequence(const char* bases, size_t count, std::ostream& out, const std::string& sourceName) override;
+    void decodeSequence(const unsigned char* archive, size_t size, std::ostream& out) override;
+    std::string decodeSequenceRange(const unsigned char* archive, size_t size, uint64_t start, uint64_t length) override;
+
+    // Packs `count` ASCII bases (either case) into (count + 3) / 4 bytes.
+    // Returns count on success, or the offset of the first byte that is not A/C/G/T.
+    static size_t packBases(const char* input, size_t count, unsigned char* output);
+
+    // Expands `count` bases from packed form back to upper-case ASCII.
+    static void unpackBases(const unsigned char* input, size_t count, char* output);
+
+private:
+    CompressionMetrics metrics;
+
+    // Header, padding byte, case mask and exception stream of an archive, checked against its size
+    struct ArchiveLayout {
+        uint64_t coreBases;     // bases in the packed stream
+        uint64_t sequenceBases; // core bases plus exception runs
+        ExceptionStream exceptions;
+        CaseMask caseMask; // over the core bases
+    };
+
+    static ArchiveLayout readLayout(const unsigned char* archive, size_t size, const std::string& inputFilename);
+    static std::string unpackRange(const unsigned char* archive, size_t size, uint64_t start, uint64_t length,
+                                   const std::string& archiveFilename);
+
+    // Extension and existence checks; the content is checked during encoding
+    bool validateInputPath(const std::string& inputFilename) const;
+    void reportInvalidBase(const std::string& inputFilename, size_t offset, char ch) const;
+};
+
+#endif
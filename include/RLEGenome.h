@@ -1,10 +1,18 @@
 #ifndef RLEGENOME_H
 #define RLEGENOME_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
 #include <string>
+#include <vector>
 #include "CompressionMetrics.h"
 #include "Compressor.h"
+#include "CaseMask.h"
 
+// Run-length codec: one byte per run of up to 63 bases (2-bit base, 6-bit length),
+// with a varint escape for longer runs.
 class RLEGenome : public Compressor {
 public:
     RLEGenome();
@@ -16,8 +24,29 @@ public:
     bool validateDecodedFile(const std::string& originalFilename, const std::string& decodedFilename) override;
     bool validateInputFile(const std::string& inputFilename) const override;
 
+    // Streaming halves of the codec, shared with CombinedCompressor. The token stream
+    // excludes the archive header, and every chunk holds whole tokens only.
+    typedef std::function<void(std::vector<unsigned char>&&)> TokenSink;
+
+    // Validates and run-length encodes the input, passing chunks of about 1 MB to `sink`.
+    // Runs fold case; with `caseMask` the lower-case stretches are recorded there.
+    // Returns false, after reporting the problem, if the input is rejected.
+    bool encodeTokens(const std::string& inputFilename, const TokenSink& sink, CaseMask* caseMask = nullptr);
+
+    // Expands whole run tokens into `out`, lower-casing the stretches in `caseMask` if given.
+    // The tokens hold the sequence from base `start`. Returns the number of bases written.
+    static uint64_t decodeTokens(const unsigned char* tokens, size_t size, std::ostream& out,
+                                 const CaseMask* caseMask = nullptr, uint64_t start = 0);
+
+    // Number of bases whole run tokens expand to, without expanding them.
+    static uint64_t countTokenBases(const unsigned char* tokens, size_t size);
+
 private:
     CompressionMetrics metrics;
+
+    // Extension and existence checks; the content is checked during encoding
+    bool validateInputPath(const std::string& inputFilename) const;
+    void reportInvalidBase(const std::string& inputFilename, size_t offset, char ch) const;
     std::string encode(const std::string& sequence);
     std::string decode(const std::string& encodedSequence);
 };
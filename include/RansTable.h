@@ -0,0 +1,72 @@
+#ifndef RANSTABLE_H
+#define RANSTABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+// Static order-0 rANS over a byte alphabet. Frequencies are normalized to
+// PROB_SCALE. Symbols are spread round-robin over LANES independent 32-bit
+// states that share one byte stream, so the decoder has LANES independent
+// dependency chains to overlap. A coded stream is the LANES initial states
+// (u32 little-endian, lane 0 first) followed by 16-bit little-endian
+// renormalization words.
+class RansTable {
+public:
+    static const int PROB_BITS = 12;
+    static const uint32_t PROB_SCALE = 1u << PROB_BITS;
+    static const int LANES = 4;
+    static const size_t STATE_BYTES = LANES * sizeof(uint32_t);
+    static const int ALPHABET_SIZE = 256;
+
+    RansTable();
+
+    // Scales counts to frequencies summing to PROB_SCALE; every symbol that occurs keeps at least 1.
+    void buildFromCounts(const std::array<uint64_t, ALPHABET_SIZE>& counts);
+
+    // Uses stored frequencies as they are; throws unless they sum to PROB_SCALE.
+    void buildFromFrequencies(const std::array<uint16_t, ALPHABET_SIZE>& frequencies);
+
+    // Encodes `alias` exactly like `symbol`, e.g. lower-case bases as upper case. Decoding yields `symbol`.
+    void addAlias(unsigned char alias, unsigned char symbol);
+
+    void clear();
+    bool empty() const { return decodeTable.empty(); }
+
+    uint32_t getFrequency(unsigned char symbol) const { return frequencies[symbol]; }
+    const std::array<uint16_t, ALPHABET_SIZE>& getFrequencies() const { return frequencies; }
+
+    // Appends the coded form of data[0, count) to `out`. Every symbol needs a non-zero frequency.
+    void encode(const unsigned char* data, size_t count, std::vector<unsigned char>& out) const;
+
+    // Decodes exactly `count` symbols from data[0, size) into `output`. Throws if the
+    // stream is too short, has bytes left over, or does not end in the initial states.
+    void decode(const unsigned char* data, size_t size, unsigned char* output, size_t count) const;
+
+    // Frequencies as an in-band header: u16 symbol count, then symbol byte and u16 frequency per used symbol.
+    void writeFrequencies(std::ostream& out) const;
+    static std::array<uint16_t, ALPHABET_SIZE> readFrequencies(std::istream& in);
+
+private:
+    struct EncodeSymbol {
+        uint64_t maxState;   // states at or above this are renormalized first
+        uint32_t frequency;
+        uint32_t start;      // cumulative frequency of the symbols before this one
+    };
+
+    // One decoder entry per slot of [0, PROB_SCALE)
+    struct DecodeEntry {
+        uint16_t frequency;
+        uint16_t offset;     // slot - cumulative frequency of the symbol
+        unsigned char symbol;
+    };
+
+    std::array<uint16_t, ALPHABET_SIZE> frequencies;
+    std::array<EncodeSymbol, ALPHABET_SIZE> encodeSymbols;
+    std::vector<DecodeEntry> decodeTable;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef STREAMCODER_H
+#define STREAMCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include "CompressionMetrics.h"
+#include "Compressor.h"
+
+// Push-based front end for pipes. Input is fed in pieces of any size with
+// begin/feed/finish and cut into frames of about `chunkSize` bytes; every frame is a
+// complete archive of the codec (its own tables, padding and trailers), so neither
+// side ever seeks. FASTA text is cut at line ends, or inside a sequence line longer
+// than the chunk, so a long record spans several frames and at most about two chunks
+// are buffered. Works with any codec that supports sequence coding.
+class StreamCoder {
+public:
+    static const size_t DEFAULT_CHUNK_SIZE = 16 * 1024 * 1024;
+
+    // Method name recorded for FASTA frames, which name their own sequence codec
+    static const char* const FASTA_METHOD;
+
+    // `method` is recorded in the stream header so the decoder can pick the codec
+    StreamCoder(Compressor& codec, const std::string& method, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+    // Writes the stream header. `sourceName` is used in error reports.
+    void begin(std::ostream& out, const std::string& sourceName);
+
+    // Buffers `size` bytes and writes every frame that is complete. Returns false,
+    // after the codec has reported the problem, if a frame was rejected. Throws
+    // std::runtime_error for a FASTA header line longer than two chunks.
+    bool feed(const char* data, size_t size);
+
+    // Writes what is left as the last frame, then the end marker
+    bool finish();
+
+    CompressionMetrics getMetrics() const;
+
+    // Reads the stream header and returns the method recorded in it. Throws
+    // std::runtime_error if `in` does not start with one.
+    static std::string readHeader(std::istream& in);
+
+    // Decodes the frames after the header into `out`, one frame in memory at a time.
+    // Returns the decoding phases of all frames.
+    static CompressionMetrics decodeFrames(Compressor& codec, std::istream& in, std::ostream& out);
+
+    // True if the file starts with a stream header
+    static bool isStreamArchive(const std::string& filename);
+
+private:
+    Compressor& codec;
+    std::string method;
+    size_t chunkSize;
+    std::ostream* out;
+    std::string sourceName;
+    std::string buffer;
+    bool fasta;
+    std::string lineEnd; // "\n" or "\r\n", from the first line of FASTA text
+    size_t searched;     // buffer offset already searched for a line end
+    uint64_t inputBytes;
+    uint64_t outputBytes;
+    CompressionMetrics metrics;
+
+    // Codes buffer[0, size) as one frame and drops it from the buffer. FASTA text that
+    // starts inside a record is coded behind a stand-in header line the decoder drops.
+    bool writeFrame(size_t size);
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads fed from a single FIFO queue.
+// A pool of size 1 (or 0) runs every task inline on the calling thread.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int threadCount);
+    ~ThreadPool();
+
+    // Number of tasks that can run at once.
+    unsigned int size() const { return threadCount; }
+
+    // Hardware concurrency, or 1 when the platform does not report it.
+    static unsigned int defaultThreadCount();
+
+    template <typename Task>
+    std::future<void> submit(Task&& task)
+    {
+        auto packaged = std::make_shared<std::packaged_task<void()>>(std::forward<Task>(task));
+        std::future<void> result = packaged->get_future();
+        if (workers.empty())
+        {
+            (*packaged)();
+            return result;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            tasks.emplace([packaged]() { (*packaged)(); });
+        }
+        queueReady.notify_one();
+        return result;
+    }
+
+    // Runs body(0) .. body(count - 1) across the pool and waits for all of them.
+    // The first exception thrown by any call is rethrown here.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+private:
+    void workerLoop();
+
+    unsigned int threadCount;
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    bool stopping;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+};
+
+#endif
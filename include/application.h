@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <string>
+#include <cstdint>
 #include "Compressor.h"
 #include "CompressionMetrics.h"
 #include "ArgumentParser.h"
@@ -22,11 +23,25 @@ private:
     bool useMenu_;
     bool compressMode_;
     bool decompressMode_;
+    bool extractMode_;
     bool validateMode_;
 
     std::string inputFile_;
     std::string outputFile_;
     std::string method_;
+    unsigned int threadCount_;
+    size_t blockSize_;
+    int contextOrder_;
+    std::string entropyCoder_;
+    std::string modelScope_;
+    unsigned int streamCount_;
+    size_t memoryLimit_;
+    uint64_t rangeStart_;
+    uint64_t rangeLength_;
+    std::string recordName_;
+    std::string batchSpec_;
+    std::string reportFile_;
+    std::string statsFormat_;
 
     ArgumentParser argParser_;
     CLIMenu menu_;
@@ -36,6 +51,26 @@ private:
 
     void handleCompress();
     void handleDecompress();
+
+    // "-" for --input or --output selects the stream format, read and written without seeking
+    bool isStreaming() const;
+    bool handleStreamCompress();
+    bool handleStreamDecompress();
+
+    bool handleExtract();
+
+    // Every file named by --batch, with -o as the output directory
+    bool handleBatch();
+
+    // Sink and level from --log and --log-level
+    void configureLogger() const;
+
+    // printMetrics, or one line of JSON with --stats json
+    void printStats(const CompressionMetrics& metrics) const;
+
+    void createCompressorForArchive();
+    void configureCompressor();
+    void applySettings(Compressor& codec) const;
 };
 
 #endif
@@ -2,6 +2,8 @@
 #define ARGUMENTPARSER_H
 
 #include <string>
+#include <cstddef>
+#include <cstdint>
 #include <CLI11.hpp>
 
 class ArgumentParser {
@@ -13,11 +15,27 @@ public:
     // Getters for parsed values
     bool isCompressMode() const;
     bool isDecompressMode() const;
+    bool isExtractMode() const;
     bool isValidateMode() const;
     bool isUseMenu() const;
     std::string getInputFile() const;
     std::string getOutputFile() const;
     std::string getMethod() const;
+    unsigned int getThreadCount() const;
+    size_t getBlockSize() const;
+    int getContextOrder() const;
+    std::string getEntropyCoder() const;
+    std::string getModelScope() const;
+    unsigned int getStreamCount() const;
+    size_t getMemoryLimit() const;
+    uint64_t getRangeStart() const;
+    uint64_t getRangeLength() const;
+    std::string getRecordName() const;
+    std::string getBatchSpec() const;
+    std::string getReportFile() const;
+    std::string getStatsFormat() const;
+    std::string getLogSink() const;
+    std::string getLogLevel() const;
 
 private:
     int argc_;
@@ -25,12 +43,32 @@ private:
 
     bool compressMode_;
     bool decompressMode_;
+    bool extractMode_;
     bool validateMode_;
     bool useMenu_;
 
     std::string inputFile_;
     std::string outputFile_;
     std::string method_;
+    unsigned int threadCount_; // 0 means one thread per hardware core
+    size_t blockSize_;         // 0 means the compressor's default
+    int contextOrder_;         // 0 means the compressor's default
+    std::string entropyCoder_; // empty means the compressor's default
+    std::string modelScope_;   // "global" (default) or "block"
+    unsigned int streamCount_; // bitstreams per Huffman block, 1 (default) or 4
+    size_t memoryLimit_;       // bytes; 0 means no limit
+    std::string range_;        // START:LEN for extract mode
+    uint64_t rangeStart_;
+    uint64_t rangeLength_;
+    std::string recordName_;   // FASTA record to extract, by the first word of its header
+    std::string batchSpec_;    // directory, glob or manifest of files for batch mode
+    std::string reportFile_;   // batch report; empty means batch_report.tsv in the output directory
+    std::string statsFormat_;  // "text" or "json"
+    std::string logSink_;      // "stderr", "none" or a file path
+    std::string logLevel_;     // debug, info, warning or error
+
+    // Splits START:LEN into rangeStart_ and rangeLength_; false if malformed
+    bool parseRange(const std::string& range);
 
     ArgumentParser(const ArgumentParser&) = delete;
     ArgumentParser& operator=(const ArgumentParser&) = delete;
@@ -4,8 +4,10 @@
 #include <string>
 #include "Compressor.h"
 #include "RLEGenome.h"
-#include "HuffmanCompressor.h" 
 
+// RLE followed by entropy coding (Huffman or rANS) of the run tokens. The two stages
+// run on separate threads connected by a bounded in-memory queue; each chunk of
+// tokens is coded with its own table, so nothing is staged on disk.
 class CombinedCompressor : public Compressor {
 public:
     CombinedCompressor();
@@ -16,10 +18,14 @@ public:
     CompressionMetrics getMetrics() const override;
     bool validateDecodedFile(const std::string& originalFilename, const std::string& decodedFilename) override;
     bool validateInputFile(const std::string& inputFilename) const override;
+    void setEntropyCoder(EntropyCoder coder) override;
+
+    // Finds the covering blocks through the index at the end of the archive
+    std::string decodeRange(const std::string& archiveFilename, uint64_t start, uint64_t length) override;
 
 private:
     RLEGenome rleCompressor;
-    HuffmanCompressor huffmanCompressor;
+    EntropyCoder entropyCoder;
     CompressionMetrics metrics;
 };
 
@@ -2,15 +2,55 @@
 #define COMPRESSIONMETRICS_H
 
 #include <string>
-#include <unordered_map>
 #include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
 
 class CompressionMetrics {
 public:
+    // Stages of a run that are timed separately. Where a codec fuses two stages in one
+    // sweep, e.g. validating bases while counting them, the time goes to the later one.
+    enum class Phase {
+        Validation,  // input path and header checks
+        Counting,    // base frequency sweep
+        ModelBuild,  // Huffman tree, code table or rANS table
+        Encoding,
+        Decoding,
+        Io,          // writing and flushing output
+        Count
+    };
+
+    // Wall time of one stretch of a phase
+    class PhaseTimer {
+    public:
+        PhaseTimer() : start(std::chrono::steady_clock::now()) {}
+        double seconds() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        void restart() { start = std::chrono::steady_clock::now(); }
+    private:
+        std::chrono::steady_clock::time_point start;
+    };
+
     CompressionMetrics();
 
-    void calculateOriginalSize(const std::unordered_map<unsigned char, int>& frequencyMap);
-    void calculateOriginalSize(const std::array<unsigned int, 4>& frequencyMap);
+    // Adds time and bytes to a phase; a phase may be entered many times. Bytes are those of
+    // the uncompressed sequence, except for Io, which counts archive bytes written.
+    void addPhase(Phase phase, double seconds, uint64_t bytes);
+    // Adds every phase of `other`, e.g. of a codec this one wraps
+    void addPhases(const CompressionMetrics& other);
+    void clearPhase(Phase phase);
+    bool hasPhase(Phase phase) const;
+    double getPhaseSeconds(Phase phase) const;
+    uint64_t getPhaseBytes(Phase phase) const;
+    // MB/s (2^20 bytes); 0 when no time was recorded
+    double getPhaseThroughput(Phase phase) const;
+    static const char* phaseName(Phase phase);
+
+    // Eight bits for every counted symbol
+    void calculateOriginalSize(const std::array<uint64_t, 256>& frequencyMap);
+    void calculateOriginalSize(const std::array<uint64_t, 4>& frequencyMap);
     void calculateOriginalSize(long long bits);
 
     void calculateCompressedSize(long long bits);
@@ -21,6 +61,8 @@ public:
     long long getCompressedSize() const;
     double getCompressionRatio() const;
     void printMetrics() const;
+    // Sizes, ratio and every phase that ran, as one line of JSON
+    void printJson(std::ostream& out) const;
     void setEntropyReduction(double originalEntropy, double compressedEntropy) {
         if (originalEntropy > 0) {
             entropyReduction = ((originalEntropy - compressedEntropy) / originalEntropy) * 100.0;
@@ -36,6 +78,13 @@ private:
     long long originalSize;    // in bits
     long long compressedSize;  // in bits
     double entropyReduction = 0.0;
+
+    struct PhaseStats {
+        double seconds = 0.0;
+        uint64_t bytes = 0;
+        bool recorded = false;
+    };
+    std::array<PhaseStats, static_cast<size_t>(Phase::Count)> phases;
     
     long getFileSizeInBytes(const std::string& filename) const;
 };
@@ -2,17 +2,90 @@
 #define COMPRESSOR_H
 
 #include <string>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
 #include "CompressionMetrics.h"
 
+// Entropy stage used by the Huffman-based compressors. The choice is recorded in
+// each archive, so decoding does not depend on it.
+enum class EntropyCoder {
+    Huffman = 0,
+    Rans = 1
+};
+
+// Where the Huffman-based compressors take symbol statistics from. Global counts the
+// whole input before encoding it; Block builds each block's code from that block alone,
+// in the same pass that encodes it. The choice is recorded in each archive.
+enum class ModelScope {
+    Global = 0,
+    Block = 1
+};
+
 class Compressor {
 public:
     virtual ~Compressor() = default;
 
+    // Input that fails validation is reported and leaves no archive. Any other failure
+    // removes the partial output and throws CompressionException.
     virtual void encodeFromFile(const std::string& inputFilename, const std::string& outputFilename) = 0;
     virtual void decodeFromFile(const std::string& inputFilename, const std::string& outputFilename) = 0;
     virtual CompressionMetrics getMetrics() const = 0;
     virtual bool validateDecodedFile(const std::string& originalFilename, const std::string& decodedFilename) = 0;
     virtual bool validateInputFile(const std::string& inputFilename) const = 0;
+
+    // Parallelism knobs. Compressors that do not split their input ignore them.
+    virtual void setThreadCount(unsigned int /*threads*/) {}
+    virtual void setBlockSize(size_t /*blockSize*/) {}
+
+    // Longest context a modelling compressor predicts from. Others ignore it.
+    virtual void setContextOrder(int /*order*/) {}
+
+    // Huffman or rANS for compressors that have an entropy stage. Others ignore it.
+    virtual void setEntropyCoder(EntropyCoder /*coder*/) {}
+
+    // Global or per-block statistics for compressors that build a model. Others ignore it.
+    virtual void setModelScope(ModelScope /*scope*/) {}
+
+    // Bitstreams per block for compressors with a Huffman stage: 1, or 4 to let the
+    // decoder overlap them. Others ignore it.
+    virtual void setStreamCount(unsigned int /*streams*/) {}
+
+    // Upper bound in bytes on the buffers a decoder holds at once; 0 means no limit.
+    // Decoders whose buffers are already a fixed size ignore it.
+    virtual void setMemoryLimit(size_t /*bytes*/) {}
+
+    // Bases [start, start + length) of the original input, decoded from only the archive
+    // blocks that cover them. The range is cut short at the end of the input. Throws if
+    // start lies past the end, the archive is corrupt, or the format has no block index.
+    virtual std::string decodeRange(const std::string& /*archiveFilename*/, uint64_t /*start*/, uint64_t /*length*/) {
+        throw std::runtime_error("Error: This method does not support random access.");
+    }
+
+    // In-memory coding of a bare base sequence, used by container formats such as FASTA.
+    // encodeSequence writes a complete archive to `out`; it returns false, after reporting
+    // the problem against `sourceName`, if the bases are rejected.
+    virtual bool supportsSequenceCoding() const { return false; }
+    virtual bool encodeSequence(const char* /*bases*/, size_t /*count*/, std::ostream& /*out*/,
+                                const std::string& /*sourceName*/) {
+        throw std::runtime_error("Error: This method cannot code sequences in memory.");
+    }
+    virtual void decodeSequence(const unsigned char* /*archive*/, size_t /*size*/, std::ostream& /*out*/) {
+        throw std::runtime_error("Error: This method cannot code sequences in memory.");
+    }
+
+    // Same contract as decodeRange. Codecs without a block index decode everything and cut.
+    virtual std::string decodeSequenceRange(const unsigned char* archive, size_t size, uint64_t start, uint64_t length) {
+        std::ostringstream out;
+        decodeSequence(archive, size, out);
+        std::string bases = out.str();
+        if (start > bases.size()) {
+            throw std::out_of_range("Error: Range starts past the end of the sequence.");
+        }
+        return bases.substr(static_cast<size_t>(start), static_cast<size_t>(length));
+    }
 };
 
 #endif 
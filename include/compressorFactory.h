@@ -8,6 +8,9 @@
 class CompressorFactory {
 public:
     static std::unique_ptr<Compressor> createCompressor(const std::string& method);
+
+    // True for the names createCompressor accepts
+    static bool hasMethod(const std::string& method);
 };
 
 #endif
@@ -5,6 +5,10 @@
 #include <algorithm>
 #include <fstream>
 #include <cctype>
+#include <stdexcept>
+#include "BaseClassifier.h"
+#include "ExceptionStream.h"
+#include "MappedFile.h"
 
 class FileValidator {
 public:
@@ -15,30 +19,66 @@ public:
         return ext == ".txt";
     }
 
+    // .fa, .fasta, .fna, .ffn, .frn or .fas in any case
+    static bool hasFastaExtension(const std::string& filename) {
+        size_t dot = filename.find_last_of('.');
+        if (dot == std::string::npos) return false;
+        std::string ext = filename.substr(dot);
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        return ext == ".fa" || ext == ".fasta" || ext == ".fna" || ext == ".ffn" || ext == ".frn" || ext == ".fas";
+    }
+
     static bool fileExists(const std::string& filename) {
         std::ifstream infile(filename);
         return infile.good();
     }
 
+    // Standalone content check. Compressors validate while they count instead, so this
+    // is only for callers that want an answer before compressing.
     static bool hasValidGenomeData(const std::string& filename) {
-        std::ifstream infile(filename, std::ios::binary);
-        if (!infile.is_open()) {
+        try {
+            MappedFile input(filename);
+            size_t offset = 0;
+            while (offset < input.size()) {
+                offset += BaseClassifier::findInvalid(input.data() + offset, input.size() - offset);
+                if (offset == input.size()) {
+                    break;
+                }
+                char ch = input.data()[offset];
+                if (ch != '\n' && ch != '\r') {
+                    return false;
+                }
+                ++offset;
+            }
+            return true;
+        }
+        catch (const std::runtime_error&) {
             return false;
         }
+    }
 
-        char ch;
-        while (infile.get(ch)) {
-            if (ch == '\n' || ch == '\r') {
-                continue; 
-            }
-            char upperCh = std::toupper(static_cast<unsigned char>(ch));
-            if (upperCh != 'A' && upperCh != 'C' && upperCh != 'G' && upperCh != 'T') {
-                return false;
+    // Like hasValidGenomeData, but also accepts N and the other IUPAC ambiguity codes
+    // that the nucleotide codecs keep in their exception stream.
+    static bool hasValidSequenceData(const std::string& filename) {
+        try {
+            MappedFile input(filename);
+            size_t offset = 0;
+            while (offset < input.size()) {
+                offset += BaseClassifier::findInvalid(input.data() + offset, input.size() - offset);
+                if (offset == input.size()) {
+                    break;
+                }
+                char ch = input.data()[offset];
+                if (ch != '\n' && ch != '\r' && !ExceptionStream::isExceptionSymbol(ch)) {
+                    return false;
+                }
+                ++offset;
             }
+            return true;
+        }
+        catch (const std::runtime_error&) {
+            return false;
         }
-
-        infile.close();
-        return true;
     }
 };
 
@@ -2,17 +2,20 @@
 #define HUFFMANCOMPRESSOR_H
 
 #include <string>
-#include <unordered_map>
+#include <array>
+#include <cstdint>
+#include "ByteHistogram.h"
 #include "CompressionMetrics.h"
 #include "Compressor.h"
+#include "HuffmanTable.h"
 
 struct HuffmanNode {
     unsigned char byte;
-    int frequency;
+    uint64_t frequency;
     HuffmanNode* left;
     HuffmanNode* right;
 
-    HuffmanNode(unsigned char b, int freq) 
+    HuffmanNode(unsigned char b, uint64_t freq) 
         : byte(b), frequency(freq), left(nullptr), right(nullptr) {}
 };
 
@@ -37,18 +40,32 @@ public:
     bool validateInputFile(const std::string& inputFilename) const override;
     void saveFrequencyMap(const std::string& freqFilename);
     void loadFrequencyMap(const std::string& freqFilename);
-    std::unordered_map<unsigned char, int> frequencyMap;  
+    void setEntropyCoder(EntropyCoder coder) override;
+    // Splits the frequency count of large inputs; 0 means one thread per core
+    void setThreadCount(unsigned int threads) override;
+    void setModelScope(ModelScope scope) override;
+    // 1 or HuffmanTable::STREAM_COUNT; only the Huffman coder splits its blocks
+    void setStreamCount(unsigned int streams) override;
+    ByteHistogram::Counts frequencyMap;
     
 
 private:
 
     void buildTree();
-    void generateCodes(HuffmanNode* node, const std::string& code);
+    void generateCodeLengths(HuffmanNode* node, int depth, std::array<unsigned char, 256>& lengths);
     void deleteTree(HuffmanNode* node);
 
+    // Block models: each block is counted, given its own code and encoded before the next is read
+    void encodeBlocks(const unsigned char* data, size_t size, std::ostream& out);
+    uint64_t decodeBlocks(const unsigned char* bytes, size_t size, size_t pos, bool useRans, bool splitStreams,
+                          std::ostream& out) const;
+
     HuffmanNode* root;
-    std::unordered_map<unsigned char, std::string> huffmanCodes; // Map bytes to codes
-   // std::unordered_map<unsigned char, int> frequencyMap;         // Map bytes to frequencies
+    HuffmanTable codeTable; // Canonical length-limited codes + decode table
+    EntropyCoder entropyCoder;
+    ModelScope modelScope;
+    unsigned int streamCount;
+    unsigned int threadCount;
 
     CompressionMetrics metrics;
 };
@@ -1,22 +1,119 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
 #include <mutex>
+#include <string>
+#include <thread>
 
+// Severity of a message, lowest first
+enum class LogLevel {
+    Debug = 0,
+    Info = 1,
+    Warning = 2,
+    Error = 3
+};
+
+// Messages below this level are compiled out by the LOG_* macros, arguments and all.
+// Set it with -DLOGGER_MIN_LEVEL=0 to keep debug messages.
+#ifndef LOGGER_MIN_LEVEL
+#define LOGGER_MIN_LEVEL 1
+#endif
+
+#define LOG_AT(level, message)                                                  \
+    do {                                                                        \
+        if (static_cast<int>(level) >= LOGGER_MIN_LEVEL) {                      \
+            Logger::getInstance().log(level, message);                          \
+        }                                                                       \
+    } while (0)
+#define LOG_DEBUG(message) LOG_AT(LogLevel::Debug, message)
+#define LOG_INFO(message) LOG_AT(LogLevel::Info, message)
+#define LOG_WARNING(message) LOG_AT(LogLevel::Warning, message)
+#define LOG_ERROR(message) LOG_AT(LogLevel::Error, message)
+
+// Callers hand messages to a fixed ring of slots without taking a lock; a background
+// thread formats and writes them. When the ring is full a message is dropped and
+// counted rather than making the caller wait.
 class Logger {
 public:
+    enum class Sink {
+        Stderr,
+        File,
+        None
+    };
+
+    static const size_t RING_SIZE = 4096; // a power of two
+
     static Logger& getInstance();
 
-    void log(const std::string& message);
+    void log(const std::string& message) { log(LogLevel::Info, message); }
+    void log(LogLevel level, const std::string& message) {
+        if (loggingEnabled.load(std::memory_order_relaxed) &&
+            static_cast<int>(level) >= minimumLevel.load(std::memory_order_relaxed)) {
+            push(level, message);
+        }
+    }
+
     void enableLogging(bool enable) {
-        loggingEnabled = enable;
+        loggingEnabled.store(enable, std::memory_order_relaxed);
     }
-    bool loggingEnabled = true;
+    // Runtime floor on top of LOGGER_MIN_LEVEL
+    void setLevel(LogLevel level) {
+        minimumLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+    // Stderr by default. Queued messages are written to the old sink first. Throws
+    // std::runtime_error if the file cannot be opened.
+    void setSink(Sink sink, const std::string& path = "");
+    // Returns once every message logged so far has been written
+    void flush();
+    // Messages lost to a full ring since startup
+    uint64_t droppedMessages() const { return dropped.load(std::memory_order_relaxed); }
+
+    std::atomic<bool> loggingEnabled{true};
+
 private:
-    
-    Logger() = default;
-    std::mutex logMutex;
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        LogLevel level;
+        uint64_t timestamp; // nanoseconds on the coarse monotonic clock
+        std::string message;
+    };
+
+    Logger();
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    void push(LogLevel level, const std::string& message);
+    bool drain(); // writes every ready slot; false if there was none
+    void run();
+    void write(const Slot& slot);
+
+    std::array<Slot, RING_SIZE> ring;
+    std::atomic<uint64_t> enqueuePosition{0};
+    uint64_t dequeuePosition = 0; // drain thread only
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<int> minimumLevel{LOGGER_MIN_LEVEL};
+    uint64_t startTime;
+
+    // The drain thread polls, so logging never pays for a wake-up; flush() wakes it early
+    std::mutex drainMutex;
+    std::condition_variable wake;
+    std::condition_variable drained;
+    bool stopping = false;
+    uint64_t flushRequests = 0;
+    uint64_t flushesServed = 0;
+    uint64_t reportedDrops = 0;
+
+    std::mutex sinkMutex; // held by the drain thread while writing
+    Sink sink = Sink::Stderr;
+    std::ofstream file;
+    std::thread worker;
 };
 
 #endif
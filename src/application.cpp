@@ -3,16 +3,48 @@
 #include "CompressionException.h"
 #include "Logger.h"
 #include "FileValidator.h"
+#include "BatchRunner.h"
+#include "FastaCompressor.h"
+#include "MappedFile.h"
+#include "StreamCoder.h"
 #include <iostream>
+#include <fstream>
 #include <filesystem>
+#include <vector>
 
 namespace fs = std::filesystem;
 
+namespace
+{
+    // Sends std::cout to stderr while a codec runs, so --stats json leaves only the JSON on stdout
+    class StatusToStderr
+    {
+    public:
+        explicit StatusToStderr(bool active) : previousBuffer(active ? std::cout.rdbuf(std::cerr.rdbuf()) : nullptr)
+        {
+        }
+        ~StatusToStderr()
+        {
+            if (previousBuffer)
+            {
+                std::cout.rdbuf(previousBuffer);
+            }
+        }
+        StatusToStderr(const StatusToStderr &) = delete;
+        StatusToStderr &operator=(const StatusToStderr &) = delete;
+
+    private:
+        std::streambuf *previousBuffer;
+    };
+}
+
 Application::Application(int argc, char **argv)
     : argc_(argc), argv_(argv), argParser_(argc, argv),
-      useMenu_(false), compressMode_(false), decompressMode_(false),
+      useMenu_(false), compressMode_(false), decompressMode_(false), extractMode_(false),
       validateMode_(false), inputFile_(""), outputFile_(""), method_(""),
-      compressor(nullptr)
+      threadCount_(0), blockSize_(0), contextOrder_(0), entropyCoder_(""), modelScope_("global"),
+      streamCount_(1), memoryLimit_(0), rangeStart_(0), rangeLength_(0), recordName_(""), batchSpec_(""), reportFile_(""),
+      statsFormat_("text"), compressor(nullptr)
 {
 }
 
@@ -24,10 +56,24 @@ int Application::run()
     useMenu_ = argParser_.isUseMenu();
     compressMode_ = argParser_.isCompressMode();
     decompressMode_ = argParser_.isDecompressMode();
+    extractMode_ = argParser_.isExtractMode();
     validateMode_ = argParser_.isValidateMode();
     inputFile_ = argParser_.getInputFile();
     outputFile_ = argParser_.getOutputFile();
     method_ = argParser_.getMethod();
+    threadCount_ = argParser_.getThreadCount();
+    blockSize_ = argParser_.getBlockSize();
+    contextOrder_ = argParser_.getContextOrder();
+    entropyCoder_ = argParser_.getEntropyCoder();
+    modelScope_ = argParser_.getModelScope();
+    streamCount_ = argParser_.getStreamCount();
+    memoryLimit_ = argParser_.getMemoryLimit();
+    rangeStart_ = argParser_.getRangeStart();
+    rangeLength_ = argParser_.getRangeLength();
+    recordName_ = argParser_.getRecordName();
+    batchSpec_ = argParser_.getBatchSpec();
+    reportFile_ = argParser_.getReportFile();
+    statsFormat_ = argParser_.getStatsFormat();
 
     if (useMenu_)
     {
@@ -37,14 +83,31 @@ int Application::run()
 
     try
     {
+        configureLogger();
+        if (!batchSpec_.empty() && (compressMode_ || decompressMode_))
+        {
+            return handleBatch() ? 0 : 1;
+        }
         if (compressMode_)
         {
+            if (isStreaming())
+            {
+                return handleStreamCompress() ? 0 : 1;
+            }
             handleCompress();
         }
         else if (decompressMode_)
         {
+            if (isStreaming() || StreamCoder::isStreamArchive(inputFile_))
+            {
+                return handleStreamDecompress() ? 0 : 1;
+            }
             handleDecompress();
         }
+        else if (extractMode_)
+        {
+            return handleExtract() ? 0 : 1;
+        }
         else
         {
             std::cerr << "Error: Invalid mode.\n";
@@ -53,13 +116,13 @@ int Application::run()
     }
     catch (const CompressionException &ce)
     {
-        Logger::getInstance().log(std::string("CompressionException: ") + ce.what());
+        LOG_ERROR(std::string("CompressionException: ") + ce.what());
         std::cerr << ce.what() << "\n";
         return 1;
     }
     catch (const std::exception &e)
     {
-        Logger::getInstance().log(std::string("Exception: ") + e.what());
+        LOG_ERROR(std::string("Exception: ") + e.what());
         std::cerr << "Error: " << e.what() << "\n";
         return 1;
     }
@@ -69,12 +132,27 @@ int Application::run()
 
 void Application::handleCompress()
 {
-    // Initialize the appropriate compressor using the factory
-    compressor = CompressorFactory::createCompressor(method_);
+    // FASTA input keeps its headers and line layout in a container around the chosen codec
+    if (FileValidator::hasFastaExtension(inputFile_))
+    {
+        compressor = std::make_unique<FastaCompressor>(method_);
+    }
+    else
+    {
+        compressor = CompressorFactory::createCompressor(method_);
+    }
+    configureCompressor();
 
-    compressor->encodeFromFile(inputFile_, outputFile_);
+    {
+        StatusToStderr status(statsFormat_ == "json");
+        compressor->encodeFromFile(inputFile_, outputFile_);
+    }
 
-    compressor->getMetrics().printMetrics();
+    // JSON is printed once, after the validation decode has added its phase
+    if (!validateMode_ || statsFormat_ != "json")
+    {
+        printStats(compressor->getMetrics());
+    }
 
     if (validateMode_)
     {
@@ -88,17 +166,21 @@ void Application::handleCompress()
 
         std::string tempDecodedFile = tempDecodedFilePath.string();
 
-        compressor->decodeFromFile(outputFile_, tempDecodedFile);
-        Logger::getInstance().log("Decoding completed. Decoded file: " + tempDecodedFile);
+        bool isValid = false;
+        {
+            StatusToStderr status(statsFormat_ == "json");
+            compressor->decodeFromFile(outputFile_, tempDecodedFile);
+            LOG_INFO("Decoding completed. Decoded file: " + tempDecodedFile);
 
-        bool isValid = compressor->validateDecodedFile(inputFile_, tempDecodedFile);
+            isValid = compressor->validateDecodedFile(inputFile_, tempDecodedFile);
+        }
         if (isValid)
         {
-            Logger::getInstance().log("Validation successful: Decoded file matches the original.");
+            LOG_INFO("Validation successful: Decoded file matches the original.");
         }
         else
         {
-            Logger::getInstance().log("Validation failed: Decoded file does not match the original.");
+            LOG_WARNING("Validation failed: Decoded file does not match the original.");
         }
 
         // try {
@@ -110,7 +192,7 @@ void Application::handleCompress()
         //     Logger::getInstance().log(std::string("Filesystem error while removing temp file: ") + e.what());
         // }
 
-        compressor->getMetrics().printMetrics();
+        printStats(compressor->getMetrics());
     }
 }
 
@@ -122,9 +204,318 @@ void Application::handleDecompress()
         return;
     }
 
-    compressor = CompressorFactory::createCompressor(method_);
+    createCompressorForArchive();
+    configureCompressor();
+
+    {
+        StatusToStderr status(statsFormat_ == "json");
+        compressor->decodeFromFile(inputFile_, outputFile_);
+    }
+
+    // Decoding has only its timing to report, so it is printed only on request
+    if (statsFormat_ == "json")
+    {
+        printStats(compressor->getMetrics());
+    }
+}
+
+bool Application::isStreaming() const
+{
+    return inputFile_ == "-" || outputFile_ == "-";
+}
+
+bool Application::handleStreamCompress()
+{
+    std::ifstream infile;
+    std::istream *in = &std::cin;
+    if (inputFile_ != "-")
+    {
+        infile.open(inputFile_, std::ios::binary);
+        if (!infile)
+        {
+            throw std::runtime_error("Error: Unable to open input file '" + inputFile_ + "'.");
+        }
+        in = &infile;
+    }
+    std::ofstream outfile;
+    std::ostream *out = &std::cout;
+    if (outputFile_ != "-")
+    {
+        outfile.open(outputFile_, std::ios::binary);
+        if (!outfile)
+        {
+            throw std::runtime_error("Error: Unable to open output file '" + outputFile_ + "'.");
+        }
+        out = &outfile;
+    }
+
+    // A pipe has no extension to go by, so FASTA is recognised by its first byte
+    const bool fasta = in->peek() == '>';
+    if (fasta)
+    {
+        compressor = std::make_unique<FastaCompressor>(method_);
+    }
+    else
+    {
+        compressor = CompressorFactory::createCompressor(method_);
+    }
+    configureCompressor();
+
+    StreamCoder coder(*compressor, fasta ? StreamCoder::FASTA_METHOD : method_);
+    coder.begin(*out, inputFile_ == "-" ? "standard input" : inputFile_);
+    std::vector<char> buffer(1024 * 1024);
+    while (in->read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || in->gcount() > 0)
+    {
+        if (!coder.feed(buffer.data(), static_cast<size_t>(in->gcount())))
+        {
+            LOG_WARNING("Stream encoding aborted due to input validation failure.");
+            return false;
+        }
+    }
+    if (!coder.finish())
+    {
+        std::cerr << "Error: Failed to write the compressed stream.\n";
+        return false;
+    }
+
+    // Text metrics would mix into the archive on stdout; printStats moves the JSON line to stderr
+    if (outputFile_ != "-" || statsFormat_ == "json")
+    {
+        printStats(coder.getMetrics());
+    }
+    LOG_INFO("Stream encoding completed.");
+    return true;
+}
+
+bool Application::handleStreamDecompress()
+{
+    std::ofstream outfile;
+    std::ostream *out = &std::cout;
+    if (outputFile_ != "-")
+    {
+        outfile.open(outputFile_, std::ios::binary);
+        if (!outfile)
+        {
+            throw std::runtime_error("Error: Unable to open output file '" + outputFile_ + "'.");
+        }
+        out = &outfile;
+    }
 
-    compressor->decodeFromFile(inputFile_, outputFile_);
+    std::ifstream infile;
+    std::istream *in = &std::cin;
+    if (inputFile_ != "-")
+    {
+        // A single archive written to a file decodes to stdout through the codec's in-memory decoder
+        if (!StreamCoder::isStreamArchive(inputFile_))
+        {
+            createCompressorForArchive();
+            configureCompressor();
+            MappedFile archive(inputFile_);
+            compressor->decodeSequence(archive.bytes(), archive.size(), *out);
+            out->flush();
+            if (statsFormat_ == "json")
+            {
+                printStats(compressor->getMetrics());
+            }
+            return static_cast<bool>(*out);
+        }
+        infile.open(inputFile_, std::ios::binary);
+        if (!infile)
+        {
+            throw std::runtime_error("Error: Unable to open input file '" + inputFile_ + "'.");
+        }
+        in = &infile;
+    }
 
-    // compressor->getMetrics().printMetrics();
-}
\ No newline at end of file
+    // The stream header names the codec, so -m does not have to match it
+    const std::string method = StreamCoder::readHeader(*in);
+    if (method == StreamCoder::FASTA_METHOD)
+    {
+        compressor = std::make_unique<FastaCompressor>(method_);
+    }
+    else if (CompressorFactory::hasMethod(method))
+    {
+        compressor = CompressorFactory::createCompressor(method);
+    }
+    else
+    {
+        throw std::runtime_error("Error: Unknown method '" + method + "' in stream archive.");
+    }
+    configureCompressor();
+
+    const CompressionMetrics metrics = StreamCoder::decodeFrames(*compressor, *in, *out);
+    if (!*out)
+    {
+        std::cerr << "Error: Failed to write the decoded stream.\n";
+        return false;
+    }
+    if (statsFormat_ == "json")
+    {
+        printStats(metrics);
+    }
+    LOG_INFO("Stream decoding completed.");
+    return true;
+}
+
+bool Application::handleExtract()
+{
+    createCompressorForArchive();
+    configureCompressor();
+
+    std::string bases;
+    try
+    {
+        if (!recordName_.empty())
+        {
+            FastaCompressor *fasta = dynamic_cast<FastaCompressor *>(compressor.get());
+            if (!fasta)
+            {
+                throw std::runtime_error("Error: --record needs an archive of a FASTA file.");
+            }
+            bases = fasta->extractRecord(inputFile_, recordName_);
+        }
+        else
+        {
+            bases = compressor->decodeRange(inputFile_, rangeStart_, rangeLength_);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR(std::string("Exception during range extraction: ") + e.what());
+        std::cerr << e.what() << "\n";
+        return false;
+    }
+
+    // Without --output the bases go to stdout, so callers can read them from a pipe
+    if (outputFile_.empty())
+    {
+        std::cout.write(bases.data(), static_cast<std::streamsize>(bases.size()));
+        std::cout.flush();
+        return static_cast<bool>(std::cout);
+    }
+    std::ofstream outfile(outputFile_, std::ios::binary);
+    outfile.write(bases.data(), static_cast<std::streamsize>(bases.size()));
+    outfile.close();
+    if (!outfile)
+    {
+        std::cerr << "Error: Unable to write output file '" << outputFile_ << "'.\n";
+        return false;
+    }
+    LOG_INFO("Extracted " + std::to_string(bases.size()) + " bytes to " + outputFile_);
+    return true;
+}
+
+bool Application::handleBatch()
+{
+    // Decompressing a directory picks up only the archives, not the report next to them
+    const std::vector<std::string> inputs =
+        BatchRunner::expandInputs(batchSpec_, decompressMode_ ? "." + method_ : std::string());
+    BatchRunner runner(compressMode_ ? BatchRunner::Mode::Compress : BatchRunner::Mode::Decompress, method_, outputFile_);
+    runner.setThreadCount(threadCount_);
+    runner.setConfigure([this](Compressor &codec) { applySettings(codec); });
+    const std::vector<BatchRunner::Job> jobs = runner.run(inputs);
+
+    const std::string reportFile = reportFile_.empty() ? (fs::path(outputFile_) / "batch_report.tsv").string() : reportFile_;
+    std::ofstream report(reportFile);
+    BatchRunner::writeReport(jobs, runner.getWallSeconds(), report);
+    report.close();
+    if (!report)
+    {
+        std::cerr << "Error: Unable to write batch report '" << reportFile << "'.\n";
+        return false;
+    }
+
+    CompressionMetrics total;
+    size_t succeeded = 0;
+    for (const BatchRunner::Job &job : jobs)
+    {
+        total.addOriginalSize(job.metrics.getOriginalSize());
+        total.addCompressedSize(job.metrics.getCompressedSize());
+        total.addPhases(job.metrics);
+        succeeded += job.succeeded ? 1 : 0;
+    }
+    std::ostream &status = statsFormat_ == "json" ? std::cerr : std::cout;
+    status << "Batch finished: " << succeeded << " of " << jobs.size() << " files succeeded. Report: " << reportFile
+           << "\n";
+    printStats(total);
+    return succeeded == jobs.size();
+}
+
+void Application::configureLogger() const
+{
+    Logger &logger = Logger::getInstance();
+    const std::string level = argParser_.getLogLevel();
+    logger.setLevel(level == "debug"     ? LogLevel::Debug
+                    : level == "warning" ? LogLevel::Warning
+                    : level == "error"   ? LogLevel::Error
+                                         : LogLevel::Info);
+    const std::string sink = argParser_.getLogSink();
+    if (sink == "none")
+    {
+        logger.setSink(Logger::Sink::None);
+    }
+    else if (sink != "stderr")
+    {
+        logger.setSink(Logger::Sink::File, sink);
+    }
+}
+
+void Application::printStats(const CompressionMetrics &metrics) const
+{
+    if (statsFormat_ == "json")
+    {
+        // With -o - the data owns stdout, so the JSON line goes to stderr
+        metrics.printJson(outputFile_ == "-" ? std::cerr : std::cout);
+    }
+    else
+    {
+        metrics.printMetrics();
+    }
+}
+
+void Application::createCompressorForArchive()
+{
+    // FASTA archives record their own sequence codec, so -m only matters for plain archives
+    if (FastaCompressor::isFastaArchive(inputFile_))
+    {
+        compressor = std::make_unique<FastaCompressor>(method_);
+    }
+    else
+    {
+        compressor = CompressorFactory::createCompressor(method_);
+    }
+}
+
+void Application::configureCompressor()
+{
+    applySettings(*compressor);
+}
+
+void Application::applySettings(Compressor &codec) const
+{
+    codec.setThreadCount(threadCount_);
+    if (blockSize_ > 0)
+    {
+        codec.setBlockSize(blockSize_);
+    }
+    if (contextOrder_ > 0)
+    {
+        codec.setContextOrder(contextOrder_);
+    }
+    if (entropyCoder_ == "rans")
+    {
+        codec.setEntropyCoder(EntropyCoder::Rans);
+    }
+    if (modelScope_ == "block")
+    {
+        codec.setModelScope(ModelScope::Block);
+    }
+    if (streamCount_ > 1)
+    {
+        codec.setStreamCount(streamCount_);
+    }
+    if (memoryLimit_ > 0)
+    {
+        codec.setMemoryLimit(memoryLimit_);
+    }
+}
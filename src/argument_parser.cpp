@@ -4,8 +4,11 @@
 using namespace rang;
 
 ArgumentParser::ArgumentParser(int argc, char **argv)
-    : argc_(argc), argv_(argv), compressMode_(false), decompressMode_(false),
-      validateMode_(false), useMenu_(false), inputFile_(""), outputFile_(""), method_("") {}
+    : argc_(argc), argv_(argv), compressMode_(false), decompressMode_(false), extractMode_(false),
+      validateMode_(false), useMenu_(false), inputFile_(""), outputFile_(""), method_(""),
+      threadCount_(0), blockSize_(0), contextOrder_(0), entropyCoder_(""), modelScope_("global"), streamCount_(1), memoryLimit_(0), range_(""),
+      rangeStart_(0), rangeLength_(0), recordName_(""), batchSpec_(""), reportFile_(""),
+      statsFormat_("text"), logSink_("stderr"), logLevel_("info") {}
 
 void ArgumentParser::parse()
 {
@@ -15,31 +18,98 @@ void ArgumentParser::parse()
 
     auto compress = app.add_flag("-c,--compress", compressMode_, "Compression mode: Compress the input file.");
     auto decompress = app.add_flag("-d,--decompress", decompressMode_, "Decompression mode: Decompress the input file.");
+    auto extract = app.add_flag("-x,--extract", extractMode_, "Extract mode: Decode only the bases given by --range from an archive.");
     auto validate = app.add_flag("--validate", validateMode_, "Validation mode, used with Compression mode: Automatically validate compression integrity.");
     auto menu = app.add_flag("--menu", useMenu_, "Display a welcome menu with usage instructions");
 
     // Define mutual exclusivity: --menu cannot be used with -c or -d
     menu->excludes(compress);
     menu->excludes(decompress);
+    menu->excludes(extract);
+    extract->excludes(compress);
+    extract->excludes(decompress);
 
     // Define CLI options without required constraints
-    app.add_option("-i,--input", inputFile_, "Input file for compression or decompression")
-        ->check(CLI::ExistingFile);
+    // "-" reads standard input, which is never an existing file
+    const CLI::Validator existingFileOrStdin(
+        [](std::string &path) { return path == "-" ? std::string() : CLI::ExistingFile(path); }, "FILE or -");
+    auto input = app.add_option("-i,--input", inputFile_, "Input file for compression or decompression, - for stdin")
+        ->check(existingFileOrStdin);
 
-    app.add_option("-o,--output", outputFile_, "Output file for the compressed or decompressed data");
+    app.add_option("-o,--output", outputFile_, "Output file for the compressed or decompressed data, - for stdout (extract mode: default stdout)");
 
-    app.add_option("-m,--method", method_, "Compression method: huffmangenome, rle, combined, huffman")
-        ->check(CLI::IsMember({"huffmangenome", "rle", "combined", "huffman"}));
+    app.add_option("-m,--method", method_, "Compression method: huffmangenome, rle, combined, huffman, pack2, cm")
+        ->check(CLI::IsMember({"huffmangenome", "rle", "combined", "huffman", "pack2", "cm"}));
+
+    app.add_option("-t,--threads", threadCount_, "Worker threads for block-parallel methods (default: one per core)");
+
+    app.add_option("--block-size", blockSize_, "Bases per independently coded block, e.g. 4M (huffmangenome)")
+        ->transform(CLI::AsSizeValue(false))
+        ->check(CLI::PositiveNumber);
+
+    app.add_option("--order", contextOrder_, "Longest context in bases for the cm method (default: 16)")
+        ->check(CLI::Range(1, 24));
+
+    app.add_option("--entropy", entropyCoder_, "Entropy coder for huffmangenome, huffman and combined: huffman (default) or rans")
+        ->check(CLI::IsMember({"huffman", "rans"}));
+
+    app.add_option("--model", modelScope_, "Statistics for huffmangenome and huffman: global (default, counts the whole input first) or block (one pass, a code per block)")
+        ->check(CLI::IsMember({"global", "block"}));
+
+    app.add_option("--streams", streamCount_, "Bitstreams per block for huffmangenome and huffman with the Huffman coder: 1 (default) or 4, decoded side by side")
+        ->check(CLI::IsMember({1, 4}));
+
+    app.add_option("--max-memory", memoryLimit_, "Most memory for decoded blocks at once, e.g. 64M (huffmangenome; default: one block per thread)")
+        ->transform(CLI::AsSizeValue(false))
+        ->check(CLI::PositiveNumber);
+
+    auto range = app.add_option("--range", range_, "Bases to extract as START:LEN, 0-based (huffmangenome, combined, pack2)");
+
+    auto record = app.add_option("--record", recordName_, "FASTA record to extract, named by the first word of its header");
+    record->excludes(range);
+
+    auto batch = app.add_option("--batch", batchSpec_, "Compress or decompress every file in a directory, glob or manifest; -o names the output directory");
+    batch->excludes(input);
+    batch->excludes(extract);
+    app.add_option("--report", reportFile_, "Batch report file (default: batch_report.tsv in the output directory)")
+        ->needs(batch);
+
+    app.add_option("--stats", statsFormat_, "Metrics with per-phase timing as text (default) or json, one line on stdout (stderr with -o -)")
+        ->check(CLI::IsMember({"text", "json"}));
+
+    app.add_option("--log", logSink_, "Where log messages go: stderr (default), none, or a file to append to");
+    app.add_option("--log-level", logLevel_, "Lowest level logged: debug (builds with LOGGER_MIN_LEVEL=0), info (default), warning or error")
+        ->check(CLI::IsMember({"debug", "info", "warning", "error"}));
 
     app.footer("Examples:\n"
                "  Compress using Huffman Genome Compressor:\n"
                "    compressor -c -i genome_data.txt -o genomeDataTest.bin -m huffmangenome\n\n"
                "  Decompress using Huffman Genome Compressor:\n"
                "    compressor -d -i genomeDataTest.bin -o decoded_genomeDataTest.txt -m huffmangenome\n\n"
+               "  Compress on 8 threads with 1M-base blocks:\n"
+               "    compressor -c -i genome_data.txt -o genomeDataTest.bin -m huffmangenome -t 8 --block-size 1M\n\n"
+               "  Compress with interleaved rANS instead of Huffman codes:\n"
+               "    compressor -c -i genome_data.txt -o genomeDataTest.bin -m huffmangenome --entropy rans\n\n"
+               "  Extract 1000 bases starting at base 1000000:\n"
+               "    compressor -x -i genomeDataTest.bin -m huffmangenome --range 1000000:1000\n\n"
+               "  Compress a multi-record FASTA file; headers and line widths are kept:\n"
+               "    compressor -c -i genome.fa -o genome.fa.huffg -m huffmangenome\n\n"
+               "  Extract one FASTA record by name:\n"
+               "    compressor -x -i genome.fa.huffg -m huffmangenome --record chr2\n\n"
+               "  Compress from a pipe to stdout; - works for --input and --output:\n"
+               "    samtools fasta reads.bam | compressor -c -i - -o - -m huffmangenome > reads.fa.stream\n\n"
+               "  Compress every file matching a glob on 8 workers, largest first:\n"
+               "    compressor -c --batch 'samples/*.txt' -o archives -m pack2 -t 8\n\n"
+               "  Compress and print sizes and per-phase timings as JSON:\n"
+               "    compressor -c -i genome_data.txt -o genomeDataTest.bin -m huffmangenome --stats json\n\n"
                "  Compress using Run-Length Encoding (RLE):\n"
                "    compressor -c -i genome_data.txt -o genomeDataTest.rle -m rle\n\n"
                "  Compress using Combined RLE + Huffman:\n"
                "    compressor -c -i genome_data.txt -o genomeDataTest.combined -m combined\n\n"
+               "  Compress using fixed-rate 2-bit packing:\n"
+               "    compressor -c -i genome_data.txt -o genomeDataTest.pack2 -m pack2\n\n"
+               "  Compress for maximum ratio with an order-12 context model:\n"
+               "    compressor -c -i genome_data.txt -o genomeDataTest.cm -m cm --order 12\n\n"
                "  Display the menu:\n"
                "    compressor --menu\n\n"
                "  View the help menu:\n"
@@ -60,11 +130,36 @@ void ArgumentParser::parse()
         return;
     }
 
+    if (extractMode_)
+    {
+        if (inputFile_.empty() || method_.empty() || (range_.empty() && recordName_.empty()))
+        {
+            std::cerr << fg::red << "Error: --input, --method and --range or --record are required when using -x.\n"
+                      << style::reset;
+            std::cerr << "Run `compressor --help` for more information.\n"
+                      << style::reset;
+            exit(1);
+        }
+        if (inputFile_ == "-")
+        {
+            std::cerr << fg::red << "Error: -x needs a seekable archive file, not standard input.\n"
+                      << style::reset;
+            exit(1);
+        }
+        if (!range_.empty() && !parseRange(range_))
+        {
+            std::cerr << fg::red << "Error: --range must be START:LEN with non-negative integers, e.g. 1000000:1000.\n"
+                      << style::reset;
+            exit(1);
+        }
+        return;
+    }
+
     if (compressMode_ || decompressMode_)
     {
-        if (inputFile_.empty())
+        if (inputFile_.empty() && batchSpec_.empty())
         {
-            std::cerr << fg::red << "Error: --input is required when using -c or -d.\n"
+            std::cerr << fg::red << "Error: --input or --batch is required when using -c or -d.\n"
                       << style::reset;
             std::cerr << "Run `compressor --help` for more information.\n"
                       << style::reset;
@@ -88,20 +183,70 @@ void ArgumentParser::parse()
                       << style::reset;
             exit(1);
         }
+
+        if (!batchSpec_.empty() && outputFile_ == "-")
+        {
+            std::cerr << fg::red << "Error: --batch needs an output directory, not -.\n"
+                      << style::reset;
+            exit(1);
+        }
+
+        if (validateMode_ && (inputFile_ == "-" || outputFile_ == "-" || !batchSpec_.empty()))
+        {
+            std::cerr << fg::red << "Error: --validate needs a single input and output file.\n"
+                      << style::reset;
+            exit(1);
+        }
     }
     else
     {
-        std::cerr << fg::red << "Error: Must specify either compression (-c) or decompression (-d) mode.\n"
+        std::cerr << fg::red << "Error: Must specify compression (-c), decompression (-d) or extract (-x) mode.\n"
                   << style::reset;
         std::cerr << "Run `compressor --menu` for usage instructions.\n";
         exit(1);
     }
 }
 
+bool ArgumentParser::parseRange(const std::string &range)
+{
+    size_t colon = range.find(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == range.size() ||
+        range.find_first_not_of("0123456789:") != std::string::npos || range.find(':', colon + 1) != std::string::npos)
+    {
+        return false;
+    }
+    try
+    {
+        rangeStart_ = std::stoull(range.substr(0, colon));
+        rangeLength_ = std::stoull(range.substr(colon + 1));
+    }
+    catch (const std::exception &)
+    {
+        return false; // out of range for 64 bits
+    }
+    return true;
+}
+
 bool ArgumentParser::isCompressMode() const { return compressMode_; }
 bool ArgumentParser::isDecompressMode() const { return decompressMode_; }
+bool ArgumentParser::isExtractMode() const { return extractMode_; }
 bool ArgumentParser::isValidateMode() const { return validateMode_; }
 bool ArgumentParser::isUseMenu() const { return useMenu_; }
+std::string ArgumentParser::getBatchSpec() const { return batchSpec_; }
+std::string ArgumentParser::getReportFile() const { return reportFile_; }
+std::string ArgumentParser::getStatsFormat() const { return statsFormat_; }
+std::string ArgumentParser::getLogSink() const { return logSink_; }
+std::string ArgumentParser::getLogLevel() const { return logLevel_; }
 std::string ArgumentParser::getInputFile() const { return inputFile_; }
 std::string ArgumentParser::getOutputFile() const { return outputFile_; }
 std::string ArgumentParser::getMethod() const { return method_; }
+unsigned int ArgumentParser::getThreadCount() const { return threadCount_; }
+size_t ArgumentParser::getBlockSize() const { return blockSize_; }
+int ArgumentParser::getContextOrder() const { return contextOrder_; }
+std::string ArgumentParser::getEntropyCoder() const { return entropyCoder_; }
+std::string ArgumentParser::getModelScope() const { return modelScope_; }
+unsigned int ArgumentParser::getStreamCount() const { return streamCount_; }
+size_t ArgumentParser::getMemoryLimit() const { return memoryLimit_; }
+uint64_t ArgumentParser::getRangeStart() const { return rangeStart_; }
+uint64_t ArgumentParser::getRangeLength() const { return rangeLength_; }
+std::string ArgumentParser::getRecordName() const { return recordName_; }
@@ -0,0 +1,195 @@
+#include "BaseClassifier.h"
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BASECLASSIFIER_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+const unsigned char NOT_A_BASE = 4;
+
+struct BaseCodes
+{
+    unsigned char code[256]; // A/C/G/T in either case -> 0..3, anything else -> NOT_A_BASE
+
+    BaseCodes()
+    {
+        std::memset(code, NOT_A_BASE, sizeof(code));
+        const char bases[] = {'A', 'C', 'G', 'T'};
+        for (unsigned char i = 0; i < 4; ++i)
+        {
+            code[static_cast<unsigned char>(bases[i])] = i;
+            code[static_cast<unsigned char>(bases[i] | 0x20)] = i;
+        }
+    }
+};
+
+static const BaseCodes &baseCodes()
+{
+    static const BaseCodes instance;
+    return instance;
+}
+
+// With TrackCase, every offset where a base differs in case from the one before it is
+// appended to `toggles`; `lower` carries the case of the last base between calls and
+// starts out as upper case.
+template <bool TrackCase>
+static size_t countScalar(const char *data, size_t size, uint64_t counts[4], std::vector<uint64_t> *toggles,
+                          size_t offset, unsigned int &lower)
+{
+    const unsigned char *code = baseCodes().code;
+    for (size_t i = 0; i < size; ++i)
+    {
+        unsigned char c = code[static_cast<unsigned char>(data[i])];
+        if (c == NOT_A_BASE)
+        {
+            return i;
+        }
+        counts[c]++;
+        if (TrackCase)
+        {
+            unsigned int isLower = (static_cast<unsigned char>(data[i]) >> 5) & 1u;
+            if (isLower != lower)
+            {
+                toggles->push_back(offset + i);
+                lower = isLower;
+            }
+        }
+    }
+    return size;
+}
+
+#ifdef BASECLASSIFIER_X86_KERNELS
+
+// OR-ing 0x20 folds upper to lower case; only 'A' and 'a' land on 'a', and so on.
+// A block is valid when the four equality masks cover every byte; the same masks
+// give the counts by popcount. The first block with a stray byte goes to the scalar
+// loop, which finds its exact offset.
+// For valid bytes bit 5 is the case bit; shifting each 16-bit lane left by 2 moves it to
+// the sign bit of its own byte, so movemask gives a lower-case mask. Case changes are the
+// bits that differ from their neighbour, and soft-masked stretches are long, so a block
+// usually has none.
+
+template <bool TrackCase>
+__attribute__((target("sse2"))) static size_t countSse2(const char *data, size_t size, uint64_t counts[4],
+                                                        std::vector<uint64_t> *toggles)
+{
+    const __m128i fold = _mm_set1_epi8(0x20);
+    const __m128i a = _mm_set1_epi8('a');
+    const __m128i c = _mm_set1_epi8('c');
+    const __m128i g = _mm_set1_epi8('g');
+    const __m128i t = _mm_set1_epi8('t');
+    unsigned int lower = 0;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i v = _mm_or_si128(raw, fold);
+        unsigned int ma = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, a)));
+        unsigned int mc = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, c)));
+        unsigned int mg = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, g)));
+        unsigned int mt = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, t)));
+        if ((ma | mc | mg | mt) != 0xFFFFu)
+        {
+            break;
+        }
+        counts[0] += static_cast<unsigned int>(__builtin_popcount(ma));
+        counts[1] += static_cast<unsigned int>(__builtin_popcount(mc));
+        counts[2] += static_cast<unsigned int>(__builtin_popcount(mg));
+        counts[3] += static_cast<unsigned int>(__builtin_popcount(mt));
+        if (TrackCase)
+        {
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_slli_epi16(raw, 2)));
+            unsigned int changes = (mask ^ ((mask << 1) | lower)) & 0xFFFFu;
+            lower = mask >> 15;
+            for (; changes != 0; changes &= changes - 1)
+            {
+                toggles->push_back(i + static_cast<size_t>(__builtin_ctz(changes)));
+            }
+        }
+    }
+    return i + countScalar<TrackCase>(data + i, size - i, counts, toggles, i, lower);
+}
+
+template <bool TrackCase>
+__attribute__((target("avx2,popcnt"))) static size_t countAvx2(const char *data, size_t size, uint64_t counts[4],
+                                                               std::vector<uint64_t> *toggles)
+{
+    const __m256i fold = _mm256_set1_epi8(0x20);
+    const __m256i a = _mm256_set1_epi8('a');
+    const __m256i c = _mm256_set1_epi8('c');
+    const __m256i g = _mm256_set1_epi8('g');
+    const __m256i t = _mm256_set1_epi8('t');
+    unsigned int lower = 0;
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        __m256i v = _mm256_or_si256(raw, fold);
+        unsigned int ma = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, a)));
+        unsigned int mc = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, c)));
+        unsigned int mg = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, g)));
+        unsigned int mt = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, t)));
+        if ((ma | mc | mg | mt) != 0xFFFFFFFFu)
+        {
+            break;
+        }
+        counts[0] += static_cast<unsigned int>(__builtin_popcount(ma));
+        counts[1] += static_cast<unsigned int>(__builtin_popcount(mc));
+        counts[2] += static_cast<unsigned int>(__builtin_popcount(mg));
+        counts[3] += static_cast<unsigned int>(__builtin_popcount(mt));
+        if (TrackCase)
+        {
+            unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_slli_epi16(raw, 2)));
+            unsigned int changes = mask ^ ((mask << 1) | lower);
+            lower = mask >> 31;
+            for (; changes != 0; changes &= changes - 1)
+            {
+                toggles->push_back(i + static_cast<size_t>(__builtin_ctz(changes)));
+            }
+        }
+    }
+    return i + countScalar<TrackCase>(data + i, size - i, counts, toggles, i, lower);
+}
+
+#endif
+
+template <bool TrackCase>
+static size_t countPortable(const char *data, size_t size, uint64_t counts[4], std::vector<uint64_t> *toggles)
+{
+    unsigned int lower = 0;
+    return countScalar<TrackCase>(data, size, counts, toggles, 0, lower);
+}
+
+typedef size_t (*CountKernel)(const char *, size_t, uint64_t *, std::vector<uint64_t> *);
+
+template <bool TrackCase>
+static CountKernel selectCountKernel()
+{
+#ifdef BASECLASSIFIER_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return countAvx2<TrackCase>;
+    if (__builtin_cpu_supports("sse2"))
+        return countSse2<TrackCase>;
+#endif
+    return countPortable<TrackCase>;
+}
+
+size_t BaseClassifier::countBases(const char *data, size_t size, uint64_t counts[4])
+{
+    static const CountKernel kernel = selectCountKernel<false>();
+    return kernel(data, size, counts, nullptr);
+}
+
+size_t BaseClassifier::countBases(const char *data, size_t size, uint64_t counts[4], std::vector<uint64_t> &caseToggles)
+{
+    static const CountKernel kernel = selectCountKernel<true>();
+    return kernel(data, size, counts, &caseToggles);
+}
+
+size_t BaseClassifier::findInvalid(const char *data, size_t size)
+{
+    uint64_t counts[4] = {0, 0, 0, 0};
+    return countBases(data, size, counts);
+}
@@ -0,0 +1,260 @@
+#include "BaseCode.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    const char CODE_BASES[] = {'A', 'C', 'G', 'T'};
+}
+
+BaseCode::BaseCode()
+    : balanced(false), baseIndex{}, codes{}, lengths{}, quadCodes{}, quadLengths{}, byteEntries{}
+{
+}
+
+BaseCode::BaseCode(const HuffmanTable &table) : BaseCode()
+{
+    balanced = true;
+    for (int i = 0; i < 4; ++i)
+    {
+        baseIndex[static_cast<unsigned char>(CODE_BASES[i])] = static_cast<unsigned char>(i);
+        baseIndex[static_cast<unsigned char>(CODE_BASES[i] | 0x20)] = static_cast<unsigned char>(i);
+        codes[i] = table.getCode(CODE_BASES[i]);
+        lengths[i] = static_cast<unsigned char>(table.getLength(CODE_BASES[i]));
+        balanced = balanced && lengths[i] == 2;
+    }
+
+    // Four bases per encode lookup, the first in the top bits of the key
+    for (int quad = 0; quad < 256; ++quad)
+    {
+        uint32_t code = 0;
+        int length = 0;
+        for (int shift = 6; shift >= 0; shift -= 2)
+        {
+            int base = (quad >> shift) & 3;
+            code = (code << lengths[base]) | codes[base];
+            length += lengths[base];
+        }
+        quadCodes[quad] = static_cast<uint16_t>(code);
+        quadLengths[quad] = static_cast<unsigned char>(length);
+    }
+
+    // Every code is at most 3 bits, so one byte of the stream holds at least two of them
+    for (int byte = 0; byte < 256; ++byte)
+    {
+        ByteEntry &entry = byteEntries[byte];
+        int used = 0;
+        while (entry.count < MAX_BASES_PER_BYTE)
+        {
+            int match = -1;
+            for (int i = 0; i < 4 && match < 0; ++i)
+            {
+                int length = lengths[i];
+                if (length > 0 && used + length <= 8 &&
+                    ((static_cast<unsigned>(byte) >> (8 - used - length)) & ((1u << length) - 1)) == codes[i])
+                {
+                    match = i;
+                }
+            }
+            if (match < 0)
+            {
+                break;
+            }
+            entry.bases[entry.count++] = CODE_BASES[match];
+            used += lengths[match];
+        }
+        entry.bits = static_cast<unsigned char>(entry.count > 0 ? used : 0);
+    }
+}
+
+void BaseCode::encode(const char *bases, size_t count, BitWriter &writer) const
+{
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(bases);
+    if (balanced)
+    {
+        encodeShape<true>(data, count, writer);
+    }
+    else
+    {
+        encodeShape<false>(data, count, writer);
+    }
+}
+
+template <bool Balanced>
+void BaseCode::encodeShape(const unsigned char *bases, size_t count, BitWriter &writer) const
+{
+    size_t i = 0;
+    if (Balanced)
+    {
+        // Sixteen 2-bit codes fill one write; no lengths to look up
+        for (; i + 16 <= count; i += 16)
+        {
+            uint32_t word = 0;
+            for (int k = 0; k < 16; ++k)
+            {
+                word = (word << 2) | codes[baseIndex[bases[i + k]]];
+            }
+            writer.write(word, 32);
+        }
+    }
+    else
+    {
+        // Two lookups of four bases, at most 24 bits together, per write
+        for (; i + 8 <= count; i += 8)
+        {
+            const unsigned char *p = bases + i;
+            unsigned first = (baseIndex[p[0]] << 6) | (baseIndex[p[1]] << 4) | (baseIndex[p[2]] << 2) | baseIndex[p[3]];
+            unsigned second = (baseIndex[p[4]] << 6) | (baseIndex[p[5]] << 4) | (baseIndex[p[6]] << 2) | baseIndex[p[7]];
+            writer.write((static_cast<uint32_t>(quadCodes[first]) << quadLengths[second]) | quadCodes[second],
+                         quadLengths[first] + quadLengths[second]);
+        }
+    }
+    for (; i < count; ++i)
+    {
+        int base = baseIndex[bases[i]];
+        writer.write(codes[base], lengths[base]);
+    }
+}
+
+size_t BaseCode::decode(const unsigned char *data, uint64_t bitLength, char *output, size_t maxBases) const
+{
+    if (balanced)
+    {
+        return decodeBalanced(data, bitLength, output, maxBases);
+    }
+    BitReader reader(data, static_cast<size_t>((bitLength + 7) / 8), bitLength);
+    return decodeVariable(reader, output, 0, maxBases);
+}
+
+size_t BaseCode::decodeStreams(const unsigned char *const *streams, const uint64_t *bitLengths, char *output,
+                               size_t count) const
+{
+    const int STREAMS = HuffmanTable::STREAM_COUNT;
+    if (balanced)
+    {
+        // No chain to break: segments go one after another, each overwriting the padding
+        // bases the one before it wrote past its end
+        size_t decoded = 0;
+        for (int s = 0; s < STREAMS; ++s)
+        {
+            size_t begin = HuffmanTable::streamOffset(count, s);
+            decoded += decodeBalanced(streams[s], bitLengths[s], output + begin,
+                                      HuffmanTable::streamOffset(count, s + 1) - begin);
+        }
+        return decoded;
+    }
+
+    static_assert(HuffmanTable::STREAM_COUNT == 4, "one reader per stream below");
+    BitReader readers[STREAMS] = {
+        BitReader(streams[0], static_cast<size_t>((bitLengths[0] + 7) / 8), bitLengths[0]),
+        BitReader(streams[1], static_cast<size_t>((bitLengths[1] + 7) / 8), bitLengths[1]),
+        BitReader(streams[2], static_cast<size_t>((bitLengths[2] + 7) / 8), bitLengths[2]),
+        BitReader(streams[3], static_cast<size_t>((bitLengths[3] + 7) / 8), bitLengths[3])};
+    size_t outPos[STREAMS];
+    size_t end[STREAMS];
+    for (int s = 0; s < STREAMS; ++s)
+    {
+        outPos[s] = HuffmanTable::streamOffset(count, s);
+        end[s] = HuffmanTable::streamOffset(count, s + 1);
+    }
+
+    const int PROBES = 7;
+    for (;;)
+    {
+        bool ready = true;
+        for (int s = 0; s < STREAMS; ++s)
+        {
+            ready = ready && readers[s].bitsRemaining() >= 8 * PROBES && outPos[s] + PROBES * MAX_BASES_PER_BYTE <= end[s];
+        }
+        if (!ready)
+        {
+            break;
+        }
+        for (int s = 0; s < STREAMS; ++s)
+        {
+            readers[s].refill();
+        }
+        for (int probe = 0; probe < PROBES; ++probe)
+        {
+            for (int s = 0; s < STREAMS; ++s)
+            {
+                const ByteEntry &entry = byteEntries[readers[s].peek(8)];
+                if (entry.bits == 0)
+                {
+                    throw std::runtime_error("Error: Decoding failed. Invalid Huffman code in bit stream.");
+                }
+                std::memcpy(output + outPos[s], entry.bases, MAX_BASES_PER_BYTE);
+                outPos[s] += entry.count;
+                readers[s].consume(entry.bits);
+            }
+        }
+    }
+
+    // Streams of uneven bit density run out at different times; each finishes on its own
+    size_t decoded = 0;
+    for (int s = 0; s < STREAMS; ++s)
+    {
+        decoded += decodeVariable(readers[s], output, outPos[s], end[s]) - HuffmanTable::streamOffset(count, s);
+    }
+    return decoded;
+}
+
+size_t BaseCode::decodeBalanced(const unsigned char *data, uint64_t bitLength, char *output, size_t maxBases) const
+{
+    if (bitLength % 2 != 0)
+    {
+        throw std::runtime_error("Error: Decoding failed. Invalid Huffman code in bit stream.");
+    }
+    if (bitLength / 2 > maxBases)
+    {
+        throw std::runtime_error("Error: Decoding failed. Block holds more symbols than expected.");
+    }
+    // Each byte is exactly four bases; the last one may be partly padding, which the slack absorbs
+    const size_t count = static_cast<size_t>(bitLength / 2);
+    const size_t bytes = (count + 3) / 4;
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        std::memcpy(output + 4 * i, byteEntries[data[i]].bases, 4);
+    }
+    return count;
+}
+
+size_t BaseCode::decodeVariable(BitReader &reader, char *output, size_t outPos, size_t end) const
+{
+    // A refill leaves at least 56 bits, enough for seven byte probes
+    const int PROBES = 7;
+    while (reader.bitsRemaining() >= 8 * PROBES && outPos + PROBES * MAX_BASES_PER_BYTE <= end)
+    {
+        reader.refill();
+        for (int probe = 0; probe < PROBES; ++probe)
+        {
+            const ByteEntry &entry = byteEntries[reader.peek(8)];
+            if (entry.bits == 0)
+            {
+                throw std::runtime_error("Error: Decoding failed. Invalid Huffman code in bit stream.");
+            }
+            std::memcpy(output + outPos, entry.bases, MAX_BASES_PER_BYTE);
+            outPos += entry.count;
+            reader.consume(entry.bits);
+        }
+    }
+
+    // Tail: one base per probe so nothing is decoded from the padding bits
+    while (reader.bitsRemaining() > 0)
+    {
+        reader.refill();
+        const ByteEntry &entry = byteEntries[reader.peek(8)];
+        int bits = entry.count > 0 ? lengths[baseIndex[static_cast<unsigned char>(entry.bases[0])]] : 0;
+        if (bits == 0 || static_cast<uint64_t>(bits) > reader.bitsRemaining())
+        {
+            throw std::runtime_error("Error: Decoding failed. Invalid Huffman code in bit stream.");
+        }
+        if (outPos >= end)
+        {
+            throw std::runtime_error("Error: Decoding failed. Block holds more symbols than expected.");
+        }
+        output[outPos++] = entry.bases[0];
+        reader.consume(bits);
+    }
+    return outPos;
+}
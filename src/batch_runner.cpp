@@ -0,0 +1,333 @@
+#include "BatchRunner.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include "CompressorFactory.h"
+#include "FastaCompressor.h"
+#include "FileValidator.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Swallows the per-file status lines the codecs print. It keeps no buffer,
+    // so workers writing at the same time share no state.
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int ch) override { return ch == EOF ? 0 : ch; }
+        std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+    };
+
+    // Silences std::cout and the logger for the lifetime of a batch
+    class QuietScope
+    {
+    public:
+        QuietScope()
+            : previousBuffer(std::cout.rdbuf(&nullBuffer)), previousLogging(Logger::getInstance().loggingEnabled)
+        {
+            Logger::getInstance().enableLogging(false);
+        }
+        ~QuietScope()
+        {
+            std::cout.rdbuf(previousBuffer);
+            Logger::getInstance().enableLogging(previousLogging);
+        }
+
+    private:
+        NullBuffer nullBuffer;
+        std::streambuf *previousBuffer;
+        bool previousLogging;
+    };
+
+    // Shell-style match of `name` against `pattern`, where * matches any run and ? any one character
+    bool wildcardMatch(const std::string &pattern, const std::string &name)
+    {
+        size_t p = 0;
+        size_t n = 0;
+        size_t star = std::string::npos;
+        size_t resume = 0;
+        while (n < name.size())
+        {
+            if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n]))
+            {
+                ++p;
+                ++n;
+            }
+            else if (p < pattern.size() && pattern[p] == '*')
+            {
+                star = p++;
+                resume = n;
+            }
+            else if (star != std::string::npos)
+            {
+                p = star + 1;
+                n = ++resume;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        while (p < pattern.size() && pattern[p] == '*')
+        {
+            ++p;
+        }
+        return p == pattern.size();
+    }
+}
+
+BatchRunner::BatchRunner(Mode mode, const std::string &method, const std::string &outputDirectory)
+    : mode(mode), method(method), outputDirectory(outputDirectory), threadCount(0), configure(), wallSeconds(0.0)
+{
+}
+
+void BatchRunner::setThreadCount(unsigned int threads)
+{
+    threadCount = threads;
+}
+
+void BatchRunner::setConfigure(const std::function<void(Compressor &)> &configureCodec)
+{
+    configure = configureCodec;
+}
+
+std::vector<std::string> BatchRunner::expandInputs(const std::string &spec, const std::string &directorySuffix)
+{
+    std::vector<std::string> inputs;
+    std::error_code error;
+    const fs::path path(spec);
+
+    if (fs::is_directory(path, error))
+    {
+        for (const fs::directory_entry &entry : fs::directory_iterator(path))
+        {
+            const std::string name = entry.path().filename().string();
+            if (entry.is_regular_file() && name.size() >= directorySuffix.size() &&
+                name.compare(name.size() - directorySuffix.size(), directorySuffix.size(), directorySuffix) == 0)
+            {
+                inputs.push_back(entry.path().string());
+            }
+        }
+        std::sort(inputs.begin(), inputs.end());
+    }
+    else if (spec.find_first_of("*?") != std::string::npos)
+    {
+        const fs::path parent = path.parent_path();
+        const std::string pattern = path.filename().string();
+        if (parent.string().find_first_of("*?") != std::string::npos)
+        {
+            throw std::runtime_error("Error: Wildcards are only supported in the file name of '" + spec + "'.");
+        }
+        const fs::path directory = parent.empty() ? fs::path(".") : parent;
+        if (!fs::is_directory(directory, error))
+        {
+            throw std::runtime_error("Error: Directory '" + directory.string() + "' does not exist.");
+        }
+        for (const fs::directory_entry &entry : fs::directory_iterator(directory))
+        {
+            if (entry.is_regular_file() && wildcardMatch(pattern, entry.path().filename().string()))
+            {
+                inputs.push_back((parent / entry.path().filename()).string());
+            }
+        }
+        std::sort(inputs.begin(), inputs.end());
+    }
+    else if (fs::is_regular_file(path, error))
+    {
+        std::ifstream manifest(spec);
+        std::string line;
+        while (std::getline(manifest, line))
+        {
+            size_t begin = line.find_first_not_of(" \t\r");
+            if (begin == std::string::npos || line[begin] == '#')
+            {
+                continue;
+            }
+            size_t end = line.find_last_not_of(" \t\r");
+            inputs.push_back(line.substr(begin, end - begin + 1));
+        }
+    }
+    else
+    {
+        throw std::runtime_error("Error: '" + spec + "' is not a directory, glob or manifest file.");
+    }
+
+    if (inputs.empty())
+    {
+        throw std::runtime_error("Error: No input files match '" + spec + "'.");
+    }
+    return inputs;
+}
+
+std::string BatchRunner::outputName(const std::string &input) const
+{
+    const std::string name = fs::path(input).filename().string();
+    if (mode == Mode::Compress)
+    {
+        return name + "." + method;
+    }
+    const std::string suffix = "." + method;
+    if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+    {
+        return name.substr(0, name.size() - suffix.size());
+    }
+    return name + ".out";
+}
+
+std::vector<BatchRunner::Job> BatchRunner::run(const std::vector<std::string> &inputs)
+{
+    fs::create_directories(outputDirectory);
+
+    // Two inputs with the same file name would overwrite each other's output
+    std::vector<Job> jobs(inputs.size());
+    std::vector<size_t> order;
+    std::set<std::string> outputs;
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        Job &job = jobs[i];
+        job.input = inputs[i];
+        job.output = (fs::path(outputDirectory) / outputName(inputs[i])).string();
+        job.succeeded = false;
+        job.seconds = 0.0;
+        std::error_code error;
+        uint64_t size = fs::file_size(inputs[i], error);
+        job.bytes = error ? 0 : size;
+        if (error)
+        {
+            std::cerr << "Error: Cannot read '" << job.input << "'.\n";
+        }
+        else if (!outputs.insert(job.output).second)
+        {
+            std::cerr << "Error: '" << job.input << "' has the same output name as an earlier file.\n";
+        }
+        else
+        {
+            order.push_back(i);
+        }
+    }
+
+    // Largest first, so a big file picked up last does not leave the other workers idle
+    std::stable_sort(order.begin(), order.end(), [&jobs](size_t a, size_t b) { return jobs[a].bytes > jobs[b].bytes; });
+
+    unsigned int workers = threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount;
+    workers = static_cast<unsigned int>(std::min<size_t>(workers, std::max<size_t>(order.size(), 1)));
+
+    QuietScope quiet;
+    const auto batchStart = std::chrono::steady_clock::now();
+    ThreadPool pool(workers);
+    std::atomic<size_t> next(0);
+    pool.parallelFor(workers, [&](size_t)
+    {
+        std::unique_ptr<Compressor> plainCodec;
+        std::unique_ptr<Compressor> fastaCodec;
+        for (size_t k = next++; k < order.size(); k = next++)
+        {
+            Job &job = jobs[order[k]];
+            bool fasta = mode == Mode::Compress ? FileValidator::hasFastaExtension(job.input)
+                                                : FastaCompressor::isFastaArchive(job.input);
+            std::unique_ptr<Compressor> &codec = fasta ? fastaCodec : plainCodec;
+            if (!codec)
+            {
+                if (fasta)
+                {
+                    codec = std::make_unique<FastaCompressor>(method);
+                }
+                else
+                {
+                    codec = CompressorFactory::createCompressor(method);
+                }
+                if (configure)
+                {
+                    configure(*codec);
+                }
+                codec->setThreadCount(1);
+            }
+
+            // A stale output from an earlier run must not pass for success
+            std::remove(job.output.c_str());
+            auto start = std::chrono::steady_clock::now();
+            try
+            {
+                if (mode == Mode::Compress)
+                {
+                    codec->encodeFromFile(job.input, job.output);
+                }
+                else if (codec->supportsSequenceCoding())
+                {
+                    MappedFile archive(job.input);
+                    std::ofstream outfile(job.output, std::ios::binary);
+                    codec->decodeSequence(archive.bytes(), archive.size(), outfile);
+                    outfile.close();
+                    if (!outfile)
+                    {
+                        throw std::runtime_error("Error: Failed to write output file '" + job.output + "'.");
+                    }
+                }
+                else
+                {
+                    codec->decodeFromFile(job.input, job.output);
+                }
+                // Codecs throw on failure; the one quiet outcome is rejected input, which writes no archive
+                job.succeeded = FileValidator::fileExists(job.output);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << job.input << ": " << e.what() << "\n";
+                std::remove(job.output.c_str());
+            }
+            job.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if (!job.succeeded)
+            {
+                continue;
+            }
+            job.metrics = codec->getMetrics();
+            if (mode == Mode::Decompress)
+            {
+                // Decoders record only their phases; the sizes read the same way as for compression
+                std::error_code error;
+                job.metrics.calculateOriginalSize(static_cast<long long>(fs::file_size(job.output, error)) * 8);
+                job.metrics.calculateCompressedSize(static_cast<long long>(job.bytes) * 8);
+            }
+        }
+    });
+    wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStart).count();
+    return jobs;
+}
+
+double BatchRunner::getWallSeconds() const
+{
+    return wallSeconds;
+}
+
+void BatchRunner::writeReport(const std::vector<Job> &jobs, double wallSeconds, std::ostream &out)
+{
+    out << "input\toutput\tstatus\toriginal_bits\tcompressed_bits\tratio\tseconds\n";
+    out << std::fixed;
+    CompressionMetrics total;
+    size_t succeeded = 0;
+    for (const Job &job : jobs)
+    {
+        out << job.input << "\t" << job.output << "\t" << (job.succeeded ? "ok" : "failed") << "\t"
+            << job.metrics.getOriginalSize() << "\t" << job.metrics.getCompressedSize() << "\t" << std::setprecision(3)
+            << job.metrics.getCompressionRatio() << "\t" << job.seconds << "\n";
+        total.addOriginalSize(job.metrics.getOriginalSize());
+        total.addCompressedSize(job.metrics.getCompressedSize());
+        succeeded += job.succeeded ? 1 : 0;
+    }
+    out << "total\t" << succeeded << "/" << jobs.size() << " files\t" << (succeeded == jobs.size() ? "ok" : "failed")
+        << "\t" << total.getOriginalSize() << "\t" << total.getCompressedSize() << "\t" << std::setprecision(3)
+        << total.getCompressionRatio() << "\t" << wallSeconds << "\n";
+}
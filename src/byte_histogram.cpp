@@ -0,0 +1,74 @@
+#include "ByteHistogram.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "ThreadPool.h"
+
+// 32-bit sub-counters keep the four tables in 4 KB of L1; a chunk cannot overflow them
+const size_t SUB_HISTOGRAM_CHUNK = size_t(1) << 30;
+
+void ByteHistogram::add(const unsigned char *data, size_t size, Counts &counts)
+{
+    uint32_t sub[4][256];
+    for (size_t begin = 0; begin < size; begin += SUB_HISTOGRAM_CHUNK)
+    {
+        const size_t end = std::min(size, begin + SUB_HISTOGRAM_CHUNK);
+        std::memset(sub, 0, sizeof(sub));
+        size_t i = begin;
+        for (; i + 8 <= end; i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            sub[0][word & 0xFF]++;
+            sub[1][(word >> 8) & 0xFF]++;
+            sub[2][(word >> 16) & 0xFF]++;
+            sub[3][(word >> 24) & 0xFF]++;
+            sub[0][(word >> 32) & 0xFF]++;
+            sub[1][(word >> 40) & 0xFF]++;
+            sub[2][(word >> 48) & 0xFF]++;
+            sub[3][word >> 56]++;
+        }
+        for (; i < end; ++i)
+        {
+            sub[0][data[i]]++;
+        }
+        for (int b = 0; b < 256; ++b)
+        {
+            counts[b] += static_cast<uint64_t>(sub[0][b]) + sub[1][b] + sub[2][b] + sub[3][b];
+        }
+    }
+}
+
+ByteHistogram::Counts ByteHistogram::count(const unsigned char *data, size_t size, unsigned int threads)
+{
+    Counts counts{};
+    if (threads == 0)
+    {
+        threads = ThreadPool::defaultThreadCount();
+    }
+    if (threads <= 1 || size < PARALLEL_THRESHOLD)
+    {
+        add(data, size, counts);
+        return counts;
+    }
+
+    // One slice per thread, no smaller than the threshold, merged once at the end
+    const size_t slices = std::min<size_t>(threads, size / PARALLEL_THRESHOLD);
+    const size_t sliceSize = (size + slices - 1) / slices;
+    std::vector<Counts> partial(slices, Counts{});
+    ThreadPool pool(static_cast<unsigned int>(slices));
+    pool.parallelFor(slices, [&](size_t s)
+    {
+        size_t begin = s * sliceSize;
+        size_t end = std::min(size, begin + sliceSize);
+        add(data + begin, end - begin, partial[s]);
+    });
+    for (const Counts &slice : partial)
+    {
+        for (int b = 0; b < 256; ++b)
+        {
+            counts[b] += slice[b];
+        }
+    }
+    return counts;
+}
@@ -0,0 +1,168 @@
+#include "CaseMask.h"
+#include "BitIO.h"
+#include "RansTable.h"
+#include <algorithm>
+#include <array>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+
+// Serialized form: a coding byte, then
+//   VARINT_GAPS  varint toggle count, varint gap to each toggle from the one before
+//   RANS_GAPS    varint size of the gap bytes above, RansTable frequencies, rANS stream
+const unsigned char VARINT_GAPS = 0;
+const unsigned char RANS_GAPS = 1;
+
+// Below this the frequency table costs more than entropy coding saves
+const size_t RANS_MIN_BYTES = 256;
+
+void CaseMask::addToggles(const std::vector<uint64_t> &pieceToggles, uint64_t start)
+{
+    // A piece was scanned as if it started in upper case. If the sequence is in lower case
+    // at its start, a toggle there cancels out, and a piece that starts in upper case needs one.
+    size_t first = 0;
+    if (toggles.size() % 2 == 1)
+    {
+        if (!pieceToggles.empty() && pieceToggles[0] == 0)
+        {
+            first = 1;
+        }
+        else
+        {
+            toggles.push_back(start);
+        }
+    }
+    for (size_t i = first; i < pieceToggles.size(); ++i)
+    {
+        toggles.push_back(start + pieceToggles[i]);
+    }
+}
+
+void CaseMask::serialize(std::vector<unsigned char> &out) const
+{
+    if (toggles.empty())
+    {
+        return;
+    }
+
+    std::vector<unsigned char> gaps;
+    BitIO::writeVarint(gaps, toggles.size());
+    uint64_t previous = 0;
+    for (uint64_t toggle : toggles)
+    {
+        BitIO::writeVarint(gaps, toggle - previous);
+        previous = toggle;
+    }
+
+    if (gaps.size() >= RANS_MIN_BYTES)
+    {
+        std::array<uint64_t, RansTable::ALPHABET_SIZE> counts{};
+        for (unsigned char byte : gaps)
+        {
+            counts[byte]++;
+        }
+        RansTable table;
+        table.buildFromCounts(counts);
+
+        std::ostringstream frequencies;
+        table.writeFrequencies(frequencies);
+        const std::string header = frequencies.str();
+        std::vector<unsigned char> coded;
+        BitIO::writeVarint(coded, gaps.size());
+        coded.insert(coded.end(), header.begin(), header.end());
+        table.encode(gaps.data(), gaps.size(), coded);
+        if (coded.size() < gaps.size())
+        {
+            out.push_back(RANS_GAPS);
+            out.insert(out.end(), coded.begin(), coded.end());
+            return;
+        }
+    }
+    out.push_back(VARINT_GAPS);
+    out.insert(out.end(), gaps.begin(), gaps.end());
+}
+
+CaseMask CaseMask::parse(const unsigned char *data, size_t size, uint64_t length)
+{
+    CaseMask mask;
+    if (size == 0)
+    {
+        return mask;
+    }
+
+    std::vector<unsigned char> decoded;
+    const unsigned char *gaps = data + 1;
+    size_t gapsSize = size - 1;
+    if (data[0] == RANS_GAPS)
+    {
+        size_t pos = 1;
+        uint64_t decodedSize = BitIO::readVarint(data, size, pos);
+        if (decodedSize > length * 10 + 10)
+        {
+            throw std::runtime_error("Error: Corrupt case mask in archive.");
+        }
+        MemoryStreamBuf buffer(data + pos, size - pos);
+        std::istream in(&buffer);
+        RansTable table;
+        table.buildFromFrequencies(RansTable::readFrequencies(in));
+        pos += buffer.position();
+        decoded.resize(static_cast<size_t>(decodedSize));
+        table.decode(data + pos, size - pos, decoded.data(), decoded.size());
+        gaps = decoded.data();
+        gapsSize = decoded.size();
+    }
+    else if (data[0] != VARINT_GAPS)
+    {
+        throw std::runtime_error("Error: Unknown case mask coding in archive.");
+    }
+
+    size_t pos = 0;
+    uint64_t count = BitIO::readVarint(gaps, gapsSize, pos);
+    if (count > gapsSize)
+    {
+        throw std::runtime_error("Error: Corrupt case mask in archive.");
+    }
+    mask.toggles.reserve(static_cast<size_t>(count));
+    uint64_t position = 0;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        uint64_t gap = BitIO::readVarint(gaps, gapsSize, pos);
+        if ((i > 0 && gap == 0) || gap > length - position)
+        {
+            throw std::runtime_error("Error: Corrupt case mask in archive.");
+        }
+        position += gap;
+        mask.toggles.push_back(position);
+    }
+    if (pos != gapsSize)
+    {
+        throw std::runtime_error("Error: Corrupt case mask in archive.");
+    }
+    return mask;
+}
+
+void CaseMask::apply(uint64_t start, char *output, size_t count) const
+{
+    // Toggles before `start` decide the case at output[0]; each later one flips it
+    const uint64_t end = start + count;
+    size_t next = static_cast<size_t>(std::upper_bound(toggles.begin(), toggles.end(), start) - toggles.begin());
+    bool lower = next % 2 == 1;
+    uint64_t position = start;
+    while (position < end)
+    {
+        uint64_t stop = next < toggles.size() ? std::min(toggles[next], end) : end;
+        if (lower)
+        {
+            for (uint64_t i = position; i < stop; ++i)
+            {
+                output[i - start] = static_cast<char>(output[i - start] | 0x20);
+            }
+        }
+        position = stop;
+        if (next < toggles.size() && toggles[next] == stop)
+        {
+            lower = !lower;
+            ++next;
+        }
+    }
+}
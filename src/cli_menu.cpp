@@ -22,14 +22,27 @@ void CLIMenu::displayMenu() const
     std::cout << "   compressor -c -i path/to/input/file.txt -o outputfilename.rle -m rle\n\n";
     std::cout << "4. Compress a file using the combined RLE + Huffman method:\n";
     std::cout << "   compressor -c -i path/to/input/file.txt -o outputfilename.combined -m combined\n\n";
-    std::cout << "5. View this menu again:\n";
+    std::cout << "5. Compress a file using fixed-rate 2-bit packing:\n";
+    std::cout << "   compressor -c -i path/to/input/file.txt -o outputfilename.pack2 -m pack2\n\n";
+    std::cout << "6. Compress for maximum ratio with a context-mixing model (slower):\n";
+    std::cout << "   compressor -c -i path/to/input/file.txt -o outputfilename.cm -m cm --order 16\n\n";
+    std::cout << "7. Extract bases 1000000-1000999 without decoding the whole archive:\n";
+    std::cout << "   compressor -x -i genomeDataTest.bin -m huffmangenome --range 1000000:1000\n\n";
+    std::cout << "8. Compress a multi-record FASTA file, then extract one record by name:\n";
+    std::cout << "   compressor -c -i genome.fa -o genome.fa.huffg -m huffmangenome\n";
+    std::cout << "   compressor -x -i genome.fa.huffg -m huffmangenome --record chr2\n\n";
+    std::cout << "9. View this menu again:\n";
     std::cout << "   compressor --menu\n\n";
-    std::cout << "6. View the help menu:\n";
+    std::cout << "10. View the help menu:\n";
     std::cout << "   compressor --help\n\n";
     std::cout << "Note:\n";
-    std::cout << "- The input file (-i) must exist and have a .txt extension for compression.\n";
+    std::cout << "- The input file (-i) must exist and have a .txt or FASTA (.fa, .fasta, .fna, ...) extension for compression.\n";
+    std::cout << "- FASTA files are restored byte for byte; their sequence is coded with huffmangenome, pack2 or cm.\n";
+    std::cout << "- huffmangenome, pack2 and cm keep N and other IUPAC ambiguity codes as runs beside the 4-base stream.\n";
     std::cout << "- The output file (-o) will be created if it doesn't exist.\n";
-    std::cout << "- The method (-m) must be one of: huffmangenome, rle, combined, huffman.\n";
-    std::cout << "- For decompression, ensure that the frequency map file (inputFile.freq) exists.\n";
+    std::cout << "- The method (-m) must be one of: huffmangenome, rle, combined, huffman, pack2, cm.\n";
+    std::cout << "- Huffman archives carry their code table in the file header; no side files are needed.\n";
+    std::cout << "- Extract (-x) works on huffmangenome, combined and pack2 archives; small --block-size values make reads cheaper.\n";
+    std::cout << "- Add --entropy rans to huffmangenome, huffman or combined for interleaved rANS coding.\n";
     std::cout << "=============================================\n";
 }
@@ -1,57 +1,315 @@
 #include "CombinedCompressor.h"
 #include "Logger.h"
 #include <cstdio>
+#include <exception>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 #include <RLEGenome.h>
 #include <CompressionException.h>
+#include "BitIO.h"
+#include "BoundedQueue.h"
+#include "ByteHistogram.h"
+#include "CaseMask.h"
+#include "HuffmanTable.h"
+#include "MappedFile.h"
+#include "RansTable.h"
 
-CombinedCompressor::CombinedCompressor() : rleCompressor(), huffmanCompressor(), metrics() {}
+// Archive layout (version 5): magic, version, entropy coder, then one block per chunk of RLE tokens:
+//   u32 token count, code table, u32 payload bits, payload
+// The code table is HuffmanTable::writeLengths or RansTable::writeFrequencies output.
+// A block with a token count of 0 ends the blocks. Then follow
+//   case mask  CaseMask::serialize output over all bases, empty for upper-case input
+//   index      per block: u64 first base, u64 byte offset
+//   footer     u64 case mask offset, u64 index offset, u64 total bases, u32 block count
+// Chunks hold whole runs, so every block starts at a known base and decodes on its own.
+const char FORMAT_MAGIC = 'C';
+const char FORMAT_VERSION = 5;
+const size_t HEADER_SIZE = 3;
+const size_t FOOTER_SIZE = 28;
+const size_t INDEX_ENTRY_SIZE = 16;
+
+// Chunks in flight between the stages; each is about 1 MB of tokens
+const size_t PIPELINE_DEPTH = 4;
+
+typedef BoundedQueue<std::vector<unsigned char>> TokenQueue;
+
+namespace
+{
+    struct CombinedLayout
+    {
+        bool useRans;
+        uint64_t caseMaskOffset;
+        uint64_t indexOffset;
+        uint64_t totalBases;
+        uint64_t blockCount;
+        CaseMask caseMask;
+    };
+
+    CombinedLayout readLayout(const MappedFile &archive, const std::string &inputFilename)
+    {
+        const unsigned char *bytes = archive.bytes();
+        const size_t size = archive.size();
+        if (size < HEADER_SIZE || bytes[0] != FORMAT_MAGIC || bytes[1] != FORMAT_VERSION)
+        {
+            throw std::runtime_error("Error: '" + inputFilename + "' is not a Combined archive.");
+        }
+        CombinedLayout layout;
+        layout.useRans = bytes[2] == static_cast<unsigned char>(EntropyCoder::Rans);
+        if (!layout.useRans && bytes[2] != static_cast<unsigned char>(EntropyCoder::Huffman))
+        {
+            throw std::runtime_error("Error: Unknown entropy coder in '" + inputFilename + "'.");
+        }
+        if (size < HEADER_SIZE + 4 + FOOTER_SIZE)
+        {
+            throw std::runtime_error("Error: Truncated Combined archive.");
+        }
+
+        const unsigned char *footer = bytes + size - FOOTER_SIZE;
+        layout.caseMaskOffset = BitIO::readUInt(footer, 8);
+        layout.indexOffset = BitIO::readUInt(footer + 8, 8);
+        layout.totalBases = BitIO::readUInt(footer + 16, 8);
+        layout.blockCount = BitIO::readUInt(footer + 24, 4);
+        if (layout.caseMaskOffset < HEADER_SIZE + 4 || layout.caseMaskOffset > layout.indexOffset ||
+            layout.indexOffset + layout.blockCount * INDEX_ENTRY_SIZE + FOOTER_SIZE != size)
+        {
+            throw std::runtime_error("Error: Corrupt block index in '" + inputFilename + "'.");
+        }
+        layout.caseMask = CaseMask::parse(bytes + layout.caseMaskOffset,
+                                          static_cast<size_t>(layout.indexOffset - layout.caseMaskOffset), layout.totalBases);
+        return layout;
+    }
+
+    // Entropy decodes the block at bytes[pos] into `tokens` and moves pos past it.
+    // Returns false at the empty block that ends the list.
+    bool decodeBlock(const unsigned char *bytes, size_t end, size_t &pos, bool useRans, HuffmanTable &table,
+                     RansTable &ransTable, std::vector<unsigned char> &tokens)
+    {
+        if (end < pos || end - pos < 4)
+        {
+            throw std::runtime_error("Error: Truncated Combined archive.");
+        }
+        size_t tokenCount = static_cast<size_t>(BitIO::readUInt(bytes + pos, 4));
+        pos += 4;
+        if (tokenCount == 0)
+        {
+            return false;
+        }
+
+        MemoryStreamBuf headerBuffer(bytes + pos, end - pos);
+        std::istream header(&headerBuffer);
+        if (useRans)
+        {
+            ransTable.buildFromFrequencies(RansTable::readFrequencies(header));
+        }
+        else
+        {
+            table.buildFromLengths(HuffmanTable::readLengths(header));
+        }
+        pos += headerBuffer.position();
+
+        if (end - pos < 4)
+        {
+            throw std::runtime_error("Error: Truncated Combined archive.");
+        }
+        uint64_t payloadBits = BitIO::readUInt(bytes + pos, 4);
+        pos += 4;
+        size_t payloadBytes = static_cast<size_t>((payloadBits + 7) / 8);
+        if (end - pos < payloadBytes)
+        {
+            throw std::runtime_error("Error: Truncated Combined archive.");
+        }
+
+        tokens.resize(tokenCount + HuffmanTable::DECODE_SLACK);
+        if (useRans)
+        {
+            ransTable.decode(bytes + pos, payloadBytes, tokens.data(), tokenCount);
+        }
+        else
+        {
+            BitReader reader(bytes + pos, payloadBytes, payloadBits);
+            size_t decoded = table.decode(reader, reinterpret_cast<char *>(tokens.data()), tokenCount);
+            if (decoded != tokenCount)
+            {
+                throw std::runtime_error("Error: Decoding failed. Block holds fewer tokens than recorded.");
+            }
+        }
+        tokens.resize(tokenCount);
+        pos += payloadBytes;
+        return true;
+    }
+}
+
+CombinedCompressor::CombinedCompressor() : rleCompressor(), entropyCoder(EntropyCoder::Huffman), metrics() {}
+
+void CombinedCompressor::setEntropyCoder(EntropyCoder coder)
+{
+    entropyCoder = coder;
+}
 
 bool CombinedCompressor::validateInputFile(const std::string &inputFilename) const
 {
     return rleCompressor.validateInputFile(inputFilename);
 }
+
 void CombinedCompressor::encodeFromFile(const std::string &inputFilename, const std::string &outputFilename)
 {
     try
     {
-        Logger::getInstance().log("Starting Combined (RLE + Huffman) encoding...");
+        LOG_INFO("Starting Combined (RLE + Huffman) encoding...");
+        metrics = CompressionMetrics();
 
-        if (!validateInputFile(inputFilename))
+        std::ofstream outfile(outputFilename, std::ios::binary);
+        if (!outfile)
         {
-            Logger::getInstance().log("Combined Compression aborted due to input file validation failure.");
-            return;
+            throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
         }
+        outfile.put(FORMAT_MAGIC);
+        outfile.put(FORMAT_VERSION);
+        outfile.put(static_cast<char>(entropyCoder));
 
-        // Step 1: RLE Encoding
-        std::string rleOutputFilename = "temp_rle_output.bin";
-        rleCompressor.encodeFromFile(inputFilename, rleOutputFilename);
+        // Stage 1 on its own thread: RLE validates and scans the input, queueing token chunks.
+        // Runs fold case, so the lower-case stretches go to a mask in the same pass.
+        TokenQueue queue(PIPELINE_DEPTH);
+        CaseMask caseMask;
+        bool accepted = false;
+        std::exception_ptr producerError;
+        std::thread producer([&]()
+        {
+            try
+            {
+                accepted = rleCompressor.encodeTokens(inputFilename, [&](std::vector<unsigned char> &&tokens)
+                {
+                    if (!queue.push(std::move(tokens)))
+                    {
+                        throw std::runtime_error("Error: Entropy coding stage stopped early.");
+                    }
+                }, &caseMask);
+            }
+            catch (...)
+            {
+                producerError = std::current_exception();
+            }
+            queue.close();
+        });
 
-        // Step 2: Huffman Encoding on RLE Output
-        huffmanCompressor.encodeFromFile(rleOutputFilename, outputFilename);
+        // Stage 2 on this thread: entropy code each chunk with a table built from its own counts
+        std::vector<std::pair<uint64_t, uint64_t>> blockIndex; // first base, byte offset
+        uint64_t totalBases = 0;
+        try
+        {
+            std::vector<unsigned char> tokens;
+            std::vector<unsigned char> payload;
+            HuffmanTable table;
+            RansTable ransTable;
+            while (queue.pop(tokens))
+            {
+                CompressionMetrics::PhaseTimer timer;
+                blockIndex.push_back({totalBases, static_cast<uint64_t>(outfile.tellp())});
+                uint64_t blockBases = RLEGenome::countTokenBases(tokens.data(), tokens.size());
+                totalBases += blockBases;
 
-        // Combine metrics
-        CompressionMetrics rleMetrics = rleCompressor.getMetrics();
-        CompressionMetrics huffmanMetrics = huffmanCompressor.getMetrics();
+                ByteHistogram::Counts counts{};
+                ByteHistogram::add(tokens.data(), tokens.size(), counts);
+                metrics.addPhase(CompressionMetrics::Phase::Counting, timer.seconds(), blockBases);
 
-        // Update combined metrics
-        metrics.addOriginalSize(rleMetrics.getOriginalSize());
-        metrics.addCompressedSize(huffmanMetrics.getCompressedSize());
+                payload.clear();
+                uint64_t payloadBits;
+                BitIO::writeUInt(outfile, tokens.size(), 4);
+                if (entropyCoder == EntropyCoder::Rans)
+                {
+                    timer.restart();
+                    ransTable.buildFromCounts(counts);
+                    metrics.addPhase(CompressionMetrics::Phase::ModelBuild, timer.seconds(), 0);
+                    timer.restart();
+                    ransTable.encode(tokens.data(), tokens.size(), payload);
+                    payloadBits = static_cast<uint64_t>(payload.size()) * 8;
+                    ransTable.writeFrequencies(outfile);
+                }
+                else
+                {
+                    timer.restart();
+                    table.buildFromCounts(counts);
+                    metrics.addPhase(CompressionMetrics::Phase::ModelBuild, timer.seconds(), 0);
+                    timer.restart();
+                    BitWriter writer(payload);
+                    for (unsigned char token : tokens)
+                    {
+                        writer.write(table.getCode(token), table.getLength(token));
+                    }
+                    payloadBits = writer.bitsWritten();
+                    writer.finish();
+                    table.writeLengths(outfile);
+                }
+                metrics.addPhase(CompressionMetrics::Phase::Encoding, timer.seconds(), blockBases);
+                BitIO::writeUInt(outfile, payloadBits, 4);
+                outfile.write(reinterpret_cast<const char *>(payload.data()), static_cast<std::streamsize>(payload.size()));
+            }
+        }
+        catch (...)
+        {
+            queue.close();
+            producer.join();
+            throw;
+        }
+        producer.join();
+        if (producerError)
+        {
+            std::rethrow_exception(producerError);
+        }
 
-        // Clean up temporary file
-        std::remove(rleOutputFilename.c_str());
+        BitIO::writeUInt(outfile, 0, 4);
+        uint64_t caseMaskOffset = static_cast<uint64_t>(outfile.tellp());
+        std::vector<unsigned char> caseMaskBytes;
+        caseMask.serialize(caseMaskBytes);
+        outfile.write(reinterpret_cast<const char *>(caseMaskBytes.data()), static_cast<std::streamsize>(caseMaskBytes.size()));
+        uint64_t indexOffset = static_cast<uint64_t>(outfile.tellp());
+        for (const auto &entry : blockIndex)
+        {
+            BitIO::writeUInt(outfile, entry.first, 8);
+            BitIO::writeUInt(outfile, entry.second, 8);
+        }
+        BitIO::writeUInt(outfile, caseMaskOffset, 8);
+        BitIO::writeUInt(outfile, indexOffset, 8);
+        BitIO::writeUInt(outfile, totalBases, 8);
+        BitIO::writeUInt(outfile, blockIndex.size(), 4);
+        std::streamoff archiveBytes = outfile.tellp();
+        CompressionMetrics::PhaseTimer flushTimer;
+        outfile.close();
+        metrics.addPhase(CompressionMetrics::Phase::Io, flushTimer.seconds(), static_cast<uint64_t>(archiveBytes));
 
-        Logger::getInstance().log("Combined encoding completed.");
-    }
-    catch (const CompressionException &ce)
-    {
-        Logger::getInstance().log(std::string("CompressionException during Combined Compression: ") + ce.what());
-        std::cerr << ce.what() << "\n";
+        if (!accepted)
+        {
+            // Leave no partial archive behind
+            std::remove(outputFilename.c_str());
+            LOG_WARNING("Combined Compression aborted due to input file validation failure.");
+            return;
+        }
+        if (!outfile)
+        {
+            throw std::runtime_error("Error: Failed to write output file '" + outputFilename + "'.");
+        }
+
+        // The run scan overlaps the entropy stage, so the phases can add up to more than the wall time
+        metrics.addPhases(rleCompressor.getMetrics());
+        metrics.addOriginalSize(rleCompressor.getMetrics().getOriginalSize());
+        metrics.addCompressedSize(static_cast<long long>(archiveBytes) * 8);
+
+        LOG_INFO("Combined encoding completed.");
+        std::cout << "Compression successful. Output file: " << outputFilename << "\n";
     }
     catch (const std::exception &e)
     {
-        Logger::getInstance().log(std::string("Exception during Combined Compression: ") + e.what());
-        std::cerr << "An unexpected error occurred: " << e.what() << "\n";
+        LOG_ERROR(std::string("Exception during Combined Compression: ") + e.what());
+        // Leave no partial output behind, and let the caller see the failure
+        if (inputFilename != outputFilename)
+        {
+            std::remove(outputFilename.c_str());
+        }
+        throw CompressionException(e.what());
     }
 }
 
@@ -59,30 +317,157 @@ void CombinedCompressor::decodeFromFile(const std::string &inputFilename, const
 {
     try
     {
-        Logger::getInstance().log("Starting Combined (Huffman + RLE) decoding...");
+        LOG_INFO("Starting Combined (Huffman + RLE) decoding...");
+        if (inputFilename == outputFilename)
+        {
+            throw std::runtime_error("Error: Output file must be different from input file to prevent overwriting.");
+        }
 
-        // Step 1: Huffman Decoding
-        std::string rleOutputFilename = "temp_rle_decoded.bin";
-        huffmanCompressor.decodeFromFile(inputFilename, rleOutputFilename);
+        CompressionMetrics::PhaseTimer timer;
+        MappedFile archive(inputFilename);
+        const unsigned char *bytes = archive.bytes();
+        const CombinedLayout layout = readLayout(archive, inputFilename);
+        const size_t end = static_cast<size_t>(layout.caseMaskOffset);
 
-        // Step 2: RLE Decoding
-        rleCompressor.decodeFromFile(rleOutputFilename, outputFilename);
+        std::ofstream outfile(outputFilename, std::ios::binary);
+        if (!outfile)
+        {
+            throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
+        }
+
+        // Stage 1 on its own thread: entropy decode each block back into RLE tokens
+        TokenQueue queue(PIPELINE_DEPTH);
+        std::exception_ptr producerError;
+        std::thread producer([&]()
+        {
+            try
+            {
+                HuffmanTable table;
+                RansTable ransTable;
+                size_t pos = HEADER_SIZE;
+                std::vector<unsigned char> tokens;
+                while (decodeBlock(bytes, end, pos, layout.useRans, table, ransTable, tokens))
+                {
+                    if (!queue.push(std::move(tokens)))
+                    {
+                        break; // the RLE stage failed and reports its own error
+                    }
+                }
+                if (pos != end)
+                {
+                    throw std::runtime_error("Error: Unexpected data after the end of the Combined archive.");
+                }
+            }
+            catch (...)
+            {
+                producerError = std::current_exception();
+            }
+            queue.close();
+        });
 
-        // Clean up temporary file
-        std::remove(rleOutputFilename.c_str());
+        // Stage 2 on this thread: expand the runs straight into the output file
+        try
+        {
+            std::vector<unsigned char> tokens;
+            uint64_t decodedBases = 0;
+            while (queue.pop(tokens))
+            {
+                decodedBases += RLEGenome::decodeTokens(tokens.data(), tokens.size(), outfile, &layout.caseMask, decodedBases);
+            }
+        }
+        catch (...)
+        {
+            queue.close();
+            producer.join();
+            throw;
+        }
+        producer.join();
+        if (producerError)
+        {
+            std::rethrow_exception(producerError);
+        }
 
-        Logger::getInstance().log("Combined decoding completed.");
+        outfile.close();
+        if (!outfile)
+        {
+            throw std::runtime_error("Error: Failed to write output file '" + outputFilename + "'.");
+        }
+        metrics.clearPhase(CompressionMetrics::Phase::Decoding);
+        metrics.addPhase(CompressionMetrics::Phase::Decoding, timer.seconds(), layout.totalBases);
+
+        LOG_INFO("Combined decoding completed.");
+        std::cout << "Decoding successful. Output file: " << outputFilename << "\n";
     }
-    catch (const CompressionException &ce)
+    catch (const std::exception &e)
     {
-        Logger::getInstance().log(std::string("CompressionException during Combined Decompression: ") + ce.what());
-        std::cerr << ce.what() << "\n";
+        LOG_ERROR(std::string("Exception during Combined Decompression: ") + e.what());
+        // Leave no partial output behind, and let the caller see the failure
+        if (inputFilename != outputFilename)
+        {
+            std::remove(outputFilename.c_str());
+        }
+        throw CompressionException(e.what());
     }
-    catch (const std::exception &e)
+}
+
+std::string CombinedCompressor::decodeRange(const std::string &archiveFilename, uint64_t start, uint64_t length)
+{
+    MappedFile archive(archiveFilename, MappedFile::Access::Random);
+    const unsigned char *bytes = archive.bytes();
+    const CombinedLayout layout = readLayout(archive, archiveFilename);
+    if (start > layout.totalBases)
+    {
+        throw std::out_of_range("Error: Range starts at base " + std::to_string(start) + " but '" + archiveFilename +
+                                "' holds only " + std::to_string(layout.totalBases) + " bases.");
+    }
+    length = std::min(length, layout.totalBases - start);
+    std::string range;
+    if (length == 0)
+    {
+        return range;
+    }
+    range.reserve(static_cast<size_t>(length));
+
+    // Blocks hold varying numbers of bases, so binary search the index for the last one starting at or before `start`
+    const unsigned char *index = bytes + layout.indexOffset;
+    auto firstBase = [&](uint64_t block) { return BitIO::readUInt(index + block * INDEX_ENTRY_SIZE, 8); };
+    uint64_t low = 0;
+    uint64_t high = layout.blockCount;
+    while (high - low > 1)
+    {
+        uint64_t middle = low + (high - low) / 2;
+        (firstBase(middle) <= start ? low : high) = middle;
+    }
+
+    HuffmanTable table;
+    RansTable ransTable;
+    std::vector<unsigned char> tokens;
+    for (uint64_t block = low; block < layout.blockCount && range.size() < length; ++block)
+    {
+        uint64_t blockStart = firstBase(block);
+        size_t pos = static_cast<size_t>(BitIO::readUInt(index + block * INDEX_ENTRY_SIZE + 8, 8));
+        if (blockStart > start + range.size() || pos < HEADER_SIZE ||
+            !decodeBlock(bytes, static_cast<size_t>(layout.caseMaskOffset), pos, layout.useRans, table, ransTable, tokens))
+        {
+            throw std::runtime_error("Error: Corrupt block index in '" + archiveFilename + "'.");
+        }
+
+        std::ostringstream expanded;
+        uint64_t blockBases = RLEGenome::decodeTokens(tokens.data(), tokens.size(), expanded);
+        uint64_t from = start + range.size() - blockStart;
+        if (from >= blockBases)
+        {
+            throw std::runtime_error("Error: Corrupt block index in '" + archiveFilename + "'.");
+        }
+        uint64_t take = std::min(blockBases - from, length - range.size());
+        range.append(expanded.str(), static_cast<size_t>(from), static_cast<size_t>(take));
+    }
+    if (range.size() != length)
     {
-        Logger::getInstance().log(std::string("Exception during Combined Decompression: ") + e.what());
-        std::cerr << "An unexpected error occurred: " << e.what() << "\n";
+        throw std::runtime_error("Error: Corrupt block index in '" + archiveFilename + "'.");
     }
+    layout.caseMask.apply(start, &range[0], range.size());
+    return range;
 }
 
 CompressionMetrics CombinedCompressor::getMetrics() const
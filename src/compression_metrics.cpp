@@ -3,28 +3,97 @@
 #include <fstream>
 #include <stdexcept>
 #include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
 
-CompressionMetrics::CompressionMetrics() : originalSize(0), compressedSize(0) {}
+CompressionMetrics::CompressionMetrics() : originalSize(0), compressedSize(0), phases() {}
 
-void CompressionMetrics::calculateOriginalSize(const std::unordered_map<unsigned char, int> &frequencyMap)
+void CompressionMetrics::addPhase(Phase phase, double seconds, uint64_t bytes)
 {
-    originalSize = 0;
-    for (const auto &entry : frequencyMap)
+    PhaseStats &stats = phases[static_cast<size_t>(phase)];
+    stats.seconds += seconds;
+    stats.bytes += bytes;
+    stats.recorded = true;
+}
+
+void CompressionMetrics::addPhases(const CompressionMetrics &other)
+{
+    for (size_t i = 0; i < phases.size(); ++i)
     {
-        if (entry.second < 0)
+        if (other.phases[i].recorded)
         {
-            throw std::invalid_argument("Frequency cannot be negative.");
+            addPhase(static_cast<Phase>(i), other.phases[i].seconds, other.phases[i].bytes);
         }
-        originalSize += entry.second * 8; // Each character is 8 bits (ASCII encoding)
     }
 }
 
-void CompressionMetrics::calculateOriginalSize(const std::array<unsigned int, 4> &frequencyMap)
+void CompressionMetrics::clearPhase(Phase phase)
+{
+    phases[static_cast<size_t>(phase)] = PhaseStats();
+}
+
+bool CompressionMetrics::hasPhase(Phase phase) const
+{
+    return phases[static_cast<size_t>(phase)].recorded;
+}
+
+double CompressionMetrics::getPhaseSeconds(Phase phase) const
+{
+    return phases[static_cast<size_t>(phase)].seconds;
+}
+
+uint64_t CompressionMetrics::getPhaseBytes(Phase phase) const
+{
+    return phases[static_cast<size_t>(phase)].bytes;
+}
+
+double CompressionMetrics::getPhaseThroughput(Phase phase) const
+{
+    const PhaseStats &stats = phases[static_cast<size_t>(phase)];
+    if (stats.seconds <= 0.0)
+    {
+        return 0.0;
+    }
+    return static_cast<double>(stats.bytes) / (1024.0 * 1024.0) / stats.seconds;
+}
+
+const char *CompressionMetrics::phaseName(Phase phase)
+{
+    switch (phase)
+    {
+    case Phase::Validation:
+        return "validation";
+    case Phase::Counting:
+        return "counting";
+    case Phase::ModelBuild:
+        return "model_build";
+    case Phase::Encoding:
+        return "encoding";
+    case Phase::Decoding:
+        return "decoding";
+    case Phase::Io:
+        return "io";
+    default:
+        return "unknown";
+    }
+}
+
+void CompressionMetrics::calculateOriginalSize(const std::array<uint64_t, 256> &frequencyMap)
+{
+    originalSize = 0;
+    for (uint64_t frequency : frequencyMap)
+    {
+        originalSize += static_cast<long long>(frequency) * 8; // Each character is 8 bits (ASCII encoding)
+    }
+}
+
+void CompressionMetrics::calculateOriginalSize(const std::array<uint64_t, 4> &frequencyMap)
 {
     originalSize = 0;
-    for (size_t i = 0; i < frequencyMap.size(); ++i)
+    for (uint64_t frequency : frequencyMap)
     {
-        originalSize += frequencyMap[i] * 8; // Each character is 8 bits (ASCII encoding)
+        originalSize += static_cast<long long>(frequency) * 8; // Each character is 8 bits (ASCII encoding)
     }
 }
 
@@ -54,12 +123,8 @@ void CompressionMetrics::calculateCompressedSizeFromFile(const std::string &comp
         throw std::runtime_error("Error: Calculated encoded bits are negative. Check padding bits.");
     }
 
-    std::string freqFilename = compressedFilename + ".freq";
-    long freqFileSizeBytes = getFileSizeInBytes(freqFilename);
-    long freqFileSizeBits = freqFileSizeBytes * 8;
-
-    // Total compressed size is encoded data bits plus frequency map bits
-    this->compressedSize = encodedDataBits + freqFileSizeBits;
+    // The code table lives in the archive header, so the file size already accounts for it
+    this->compressedSize = encodedDataBits;
 
     getCompressionRatio();
 }
@@ -73,6 +138,15 @@ void CompressionMetrics::calculateOriginalSize(long long bits)
     originalSize = bits;
 }
 
+void CompressionMetrics::calculateCompressedSize(long long bits)
+{
+    if (bits < 0)
+    {
+        throw std::invalid_argument("Size in bits cannot be negative.");
+    }
+    compressedSize = bits;
+}
+
 void CompressionMetrics::addOriginalSize(long long bits)
 {
     originalSize += bits;
@@ -118,4 +192,37 @@ void CompressionMetrics::printMetrics() const
     std::cout << "Original Size (bits): " << originalSize << "\n";
     std::cout << "Compressed Size (bits): " << compressedSize << "\n";
     std::cout << "Compression Ratio: " << getCompressionRatio() << "\n";
+    for (size_t i = 0; i < phases.size(); ++i)
+    {
+        if (!phases[i].recorded)
+        {
+            continue;
+        }
+        Phase phase = static_cast<Phase>(i);
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(6) << "Phase " << phaseName(phase) << ": " << phases[i].seconds
+             << " s, " << phases[i].bytes << " bytes, " << std::setprecision(1) << getPhaseThroughput(phase) << " MB/s";
+        std::cout << line.str() << "\n";
+    }
+}
+
+void CompressionMetrics::printJson(std::ostream &out) const
+{
+    std::ostringstream json;
+    json << std::setprecision(6) << "{\"original_bits\": " << originalSize << ", \"compressed_bits\": " << compressedSize
+         << ", \"ratio\": " << getCompressionRatio() << ", \"phases\": {";
+    bool first = true;
+    for (size_t i = 0; i < phases.size(); ++i)
+    {
+        if (!phases[i].recorded)
+        {
+            continue;
+        }
+        Phase phase = static_cast<Phase>(i);
+        json << (first ? "" : ", ") << "\"" << phaseName(phase) << "\": {\"seconds\": " << phases[i].seconds
+             << ", \"bytes\": " << phases[i].bytes << ", \"mb_per_s\": " << getPhaseThroughput(phase) << "}";
+        first = false;
+    }
+    json << "}}";
+    out << json.str() << "\n";
 }
@@ -3,6 +3,8 @@
 #include "HuffmanCompressor.h"
 #include "RLEGenome.h"
 #include "CombinedCompressor.h"
+#include "Pack2Genome.h"
+#include "ContextModelGenome.h"
 #include <iostream>
 
 std::unique_ptr<Compressor> CompressorFactory::createCompressor(const std::string &method)
@@ -23,9 +25,23 @@ std::unique_ptr<Compressor> CompressorFactory::createCompressor(const std::strin
     {
         return std::make_unique<CombinedCompressor>();
     }
+    else if (method == "pack2")
+    {
+        return std::make_unique<Pack2Genome>();
+    }
+    else if (method == "cm")
+    {
+        return std::make_unique<ContextModelGenome>();
+    }
     else
     {
-        std::cerr << "Unknown method: " << method << ". Please choose huffmangenome, rle, combined, or huffman.\n";
+        std::cerr << "Unknown method: " << method << ". Please choose huffmangenome, rle, combined, huffman, pack2, or cm.\n";
         exit(1);
     }
 }
+
+bool CompressorFactory::hasMethod(const std::string &method)
+{
+    return method == "huffmangenome" || method == "huffman" || method == "rle" || method == "combined" ||
+           method == "pack2" || method == "cm";
+}
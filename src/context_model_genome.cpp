@@ -0,0 +1,691 @@
+#include "ContextModelGenome.h"
+#include "Logger.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include "FileValidator.h"
+#include "CompressionException.h"
+#include "MappedFile.h"
+#include "BitIO.h"
+#include "ExceptionStream.h"
+#include "CaseMask.h"
+
+// Archive layout (version 3): magic, version, context order, u64 sequence length,
+// arithmetic-coded core bases, case mask over the core bases, u64 case mask size,
+// exception stream, u64 exception stream size.
+// The model is rebuilt identically on both sides, so nothing else is stored.
+const char FORMAT_MAGIC = 'M';
+const char FORMAT_VERSION = 3;
+const size_t HEADER_SIZE = 11;
+const size_t SECTION_SIZE_FIELD = 8;
+
+const size_t BUFFER_SIZE = 1024 * 1024;
+const unsigned char INVALID_CODE = 0xFF;
+const char BASE_SYMBOLS[] = {'A', 'C', 'G', 'T'};
+
+// Lower orders mixed in below the configured one
+const int MIXED_ORDERS[] = {2, 4, 8, 12};
+const int MAX_MODELS = 5;
+
+// Context counters adapt at 1/(n + 1.5) until n reaches the limit. Low orders see
+// plenty of data and settle down; high orders keep tracking the latest repeat.
+const int LOW_ORDER_LIMIT = 1023;
+const int HIGH_ORDER_LIMIT = 127;
+const int DIRECT_ORDER_MAX = ContextModelGenome::TABLE_BITS / 2;
+
+// Mixer weights are 16.16 fixed point; one weight set per decision node and previous base
+const int WEIGHT_SETS = 3 * 4;
+const int MIXER_SHIFT = 10;
+
+// Logistic functions on integers only, so an archive decodes identically on any platform.
+// squash maps the stretch domain (ln(p / (1 - p)) * 256, clamped to +-2047) to a 12-bit probability.
+static int squash(int d)
+{
+    static const int knots[33] = {1, 2, 3, 6, 10, 16, 27, 45, 73, 120, 194, 310, 488, 747, 1101, 1546, 2047,
+                                  2549, 2994, 3348, 3607, 3785, 3901, 3975, 4024, 4050, 4068, 4079, 4085, 4089,
+                                  4092, 4093, 4094};
+    if (d > 2047)
+        return 4095;
+    if (d < -2047)
+        return 1;
+    int weight = d & 127;
+    int knot = (d >> 7) + 16;
+    return (knots[knot] * (128 - weight) + knots[knot + 1] * weight + 64) >> 7;
+}
+
+namespace
+{
+struct ContextModelTables
+{
+    short stretch[4096];         // inverse of squash
+    int reciprocal[1024];        // 65536 / (n + 1.5)
+    unsigned char encode[256];   // ASCII -> 2-bit code, INVALID_CODE for anything but A/C/G/T
+
+    ContextModelTables()
+    {
+        int next = 0;
+        for (int x = -2047; x <= 2047; ++x)
+        {
+            int p = squash(x);
+            for (int i = next; i <= p; ++i)
+            {
+                stretch[i] = static_cast<short>(x);
+            }
+            next = p + 1;
+        }
+        for (int i = next; i < 4096; ++i)
+        {
+            stretch[i] = 2047;
+        }
+
+        for (int n = 0; n < 1024; ++n)
+        {
+            reciprocal[n] = static_cast<int>(131072 / (2 * n + 3));
+        }
+
+        std::memset(encode, INVALID_CODE, sizeof(encode));
+        for (int code = 0; code < 4; ++code)
+        {
+            encode[static_cast<unsigned char>(BASE_SYMBOLS[code])] = static_cast<unsigned char>(code);
+            encode[static_cast<unsigned char>(BASE_SYMBOLS[code] | 0x20)] = static_cast<unsigned char>(code);
+        }
+    }
+};
+
+static const ContextModelTables &tables()
+{
+    static const ContextModelTables instance;
+    return instance;
+}
+
+// Predicts the two bits of each base: node 0 is the high bit, nodes 1 and 2 the
+// low bit after a high bit of 0 or 1. Every context owns four 32-bit counters
+// (one per node plus padding) holding a 22-bit probability and a 10-bit count.
+class BasePredictor
+{
+public:
+    explicit BasePredictor(int maxOrder)
+        : t(tables()), modelCount(0), history(0), activeWeights(nullptr), probability(2048)
+    {
+        for (int order : MIXED_ORDERS)
+        {
+            if (order < maxOrder)
+            {
+                addModel(order);
+            }
+        }
+        addModel(maxOrder);
+        weights.assign(static_cast<size_t>(WEIGHT_SETS * (modelCount + 1)), (1 << 16) / 4);
+        selectContexts();
+    }
+
+    // P(bit == 1) for `node` of the current base, 12-bit
+    inline int predict(int node)
+    {
+        activeWeights = &weights[static_cast<size_t>((node * 4 + static_cast<int>(history & 3)) * (modelCount + 1))];
+        int64_t dot = 0;
+        for (int i = 0; i < modelCount; ++i)
+        {
+            inputs[i] = t.stretch[models[i].current[node] >> 20];
+            dot += static_cast<int64_t>(inputs[i]) * activeWeights[i];
+        }
+        inputs[modelCount] = 256;
+        dot += static_cast<int64_t>(256) * activeWeights[modelCount];
+        probability = std::min(std::max(squash(static_cast<int>(dot >> 16)), 1), 4095);
+        return probability;
+    }
+
+    inline void update(int node, int bit)
+    {
+        int error = (bit << 12) - probability;
+        for (int i = 0; i <= modelCount; ++i)
+        {
+            activeWeights[i] += (inputs[i] * error) >> MIXER_SHIFT;
+        }
+        for (int i = 0; i < modelCount; ++i)
+        {
+            uint32_t &slot = models[i].current[node];
+            int count = static_cast<int>(slot & 1023);
+            int p = static_cast<int>(slot >> 10);
+            p += static_cast<int>((static_cast<int64_t>((bit << 22) - p) * t.reciprocal[count]) >> 16);
+            if (count < models[i].limit)
+            {
+                ++count;
+            }
+            slot = (static_cast<uint32_t>(p) << 10) | static_cast<uint32_t>(count);
+        }
+    }
+
+    // Appends a coded base to the history and moves every model to its new context
+    inline void push(int base)
+    {
+        history = (history << 2) | static_cast<uint64_t>(base);
+        selectContexts();
+    }
+
+private:
+    struct Model
+    {
+        uint64_t mask;
+        bool hashed;
+        int limit;
+        int indexShift;
+        std::vector<uint32_t> slots;
+        uint32_t *current;
+    };
+
+    void addModel(int order)
+    {
+        Model &model = models[modelCount++];
+        model.mask = order >= 32 ? ~0ULL : (1ULL << (2 * order)) - 1;
+        model.hashed = order > DIRECT_ORDER_MAX;
+        model.limit = order <= 8 ? LOW_ORDER_LIMIT : HIGH_ORDER_LIMIT;
+        int contextBits = model.hashed ? ContextModelGenome::TABLE_BITS : 2 * order;
+        model.indexShift = 64 - contextBits;
+        model.slots.assign(static_cast<size_t>(4) << contextBits, 1u << 31); // p = 0.5, n = 0
+        model.current = model.slots.data();
+    }
+
+    inline void selectContexts()
+    {
+        for (int i = 0; i < modelCount; ++i)
+        {
+            Model &model = models[i];
+            uint64_t context = history & model.mask;
+            uint64_t index = model.hashed ? ((context + 1) * 0x9E3779B97F4A7C15ULL) >> model.indexShift : context;
+            model.current = model.slots.data() + 4 * index;
+        }
+    }
+
+    const ContextModelTables &t;
+    Model models[MAX_MODELS];
+    int modelCount;
+    uint64_t history;
+    std::vector<int> weights;
+    int *activeWeights;
+    int inputs[MAX_MODELS + 1];
+    int probability;
+};
+
+// Carry-less binary arithmetic coder over a 32-bit range; P(1) comes in as 12 bits
+class ArithmeticEncoder
+{
+public:
+    explicit ArithmeticEncoder(std::vector<unsigned char> &out) : out(out), low(0), high(0xFFFFFFFF) {}
+
+    inline void encode(int bit, int p)
+    {
+        uint32_t mid = low + ((high - low) >> 12) * static_cast<uint32_t>(p);
+        if (bit)
+            high = mid;
+        else
+            low = mid + 1;
+        while (((low ^ high) & 0xFF000000) == 0)
+        {
+            out.push_back(static_cast<unsigned char>(high >> 24));
+            low <<= 8;
+            high = (high << 8) | 0xFF;
+        }
+    }
+
+    void flush()
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            out.push_back(static_cast<unsigned char>(low >> shift));
+        }
+    }
+
+private:
+    std::vector<unsigned char> &out;
+    uint32_t low;
+    uint32_t high;
+};
+
+class ArithmeticDecoder
+{
+public:
+    ArithmeticDecoder(const unsigned char *data, size_t size)
+        : data(data), end(data + size), low(0), high(0xFFFFFFFF), x(0)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            x = (x << 8) | nextByte();
+        }
+    }
+
+    inline int decode(int p)
+    {
+        uint32_t mid = low + ((high - low) >> 12) * static_cast<uint32_t>(p);
+        int bit = x <= mid;
+        if (bit)
+            high = mid;
+        else
+            low = mid + 1;
+        while (((low ^ high) & 0xFF000000) == 0)
+        {
+            low <<= 8;
+            high = (high << 8) | 0xFF;
+            x = (x << 8) | nextByte();
+        }
+        return bit;
+    }
+
+    // True once the decoder has needed bytes past the end of the payload
+    bool overrun() const { return data > end; }
+
+private:
+    inline uint32_t nextByte()
+    {
+        return data < end ? *data++ : (++data, 0u);
+    }
+
+    const unsigned char *data;
+    const unsigned char *end;
+    uint32_t low;
+    uint32_t high;
+    uint32_t x;
+};
+
+} // namespace
+
+const int ContextModelGenome::DEFAULT_ORDER;
+const int ContextModelGenome::MIN_ORDER;
+const int ContextModelGenome::MAX_ORDER;
+const int ContextModelGenome::TABLE_BITS;
+
+ContextModelGenome::ContextModelGenome() : metrics(), contextOrder(DEFAULT_ORDER) {}
+
+void ContextModelGenome::setContextOrder(int order)
+{
+    if (order < MIN_ORDER || order > MAX_ORDER)
+    {
+        throw std::invalid_argument("Context order must be between " + std::to_string(MIN_ORDER) + " and " +
+                                    std::to_string(MAX_ORDER) + ".");
+    }
+    contextOrder = order;
+}
+
+int ContextModelGenome::getContextOrder() const
+{
+    return contextOrder;
+}
+
+bool ContextModelGenome::validateInputPath(const std::string &inputFilename) const
+{
+    if (!FileValidator::hasTxtExtension(inputFilename))
+    {
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' does not have a .txt extension.");
+        std::cerr << "Error: Unsupported file format. Only .txt files are allowed.\n";
+        return false;
+    }
+
+    if (!FileValidator::fileExists(inputFilename))
+    {
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' does not exist.");
+        std::cerr << "Error: File does not exist.\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool ContextModelGenome::validateInputFile(const std::string &inputFilename) const
+{
+    if (!validateInputPath(inputFilename))
+    {
+        return false;
+    }
+
+    if (!FileValidator::hasValidSequenceData(inputFilename))
+    {
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' contains invalid characters.");
+        std::cerr << "Error: File contains invalid characters. Only A, C, G, T, N and IUPAC ambiguity codes are allowed.\n";
+        return false;
+    }
+
+    return true;
+}
+
+void ContextModelGenome::reportInvalidBase(const std::string &inputFilename, size_t offset, char ch) const
+{
+    LOG_WARNING("Validation Error: File '" + inputFilename + "' has an invalid character at offset " +
+                              std::to_string(offset) + ".");
+    std::cerr << "Error: Invalid character '" << ch << "' at offset " << offset
+              << " in input file. Only A, C, G, T, N and IUPAC ambiguity codes are allowed.\n";
+}
+
+void ContextModelGenome::encodeFromFile(const std::string &inputFilename, const std::string &outputFilename)
+{
+    try
+    {
+        metrics = CompressionMetrics();
+
+        CompressionMetrics::PhaseTimer timer;
+        if (!validateInputPath(inputFilename))
+        {
+            LOG_WARNING("Encoding aborted due to input file validation failure.");
+            return;
+        }
+        const double validationSeconds = timer.seconds();
+
+        LOG_INFO("Compressing using order-" + std::to_string(contextOrder) + " context mixing...");
+
+        MappedFile input(inputFilename);
+
+        std::ofstream outfile(outputFilename, std::ios::binary);
+        if (!outfile)
+        {
+            throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
+        }
+        if (!encodeSequence(input.data(), input.size(), outfile, inputFilename))
+        {
+            outfile.close();
+            std::remove(outputFilename.c_str());
+            LOG_WARNING("Encoding aborted due to input file validation failure.");
+            return;
+        }
+
+        metrics.addPhase(CompressionMetrics::Phase::Validation, validationSeconds, 0);
+        timer.restart();
+        const uint64_t archiveBytes = static_cast<uint64_t>(outfile.tellp());
+        outfile.close();
+        metrics.addPhase(CompressionMetrics::Phase::Io, timer.seconds(), archiveBytes);
+
+        LOG_INFO("Context-mixing compression completed.");
+        std::cout << "Compression successful. Output file: " << outputFilename << "\n";
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR(std::string("Exception during context-mixing compression: ") + e.what());
+        // Leave no partial output behind, and let the caller see the failure
+        if (inputFilename != outputFilename)
+        {
+            std::remove(outputFilename.c_str());
+        }
+        throw CompressionException(e.what());
+    }
+}
+
+bool ContextModelGenome::encodeSequence(const char *bases, size_t count, std::ostream &out, const std::string &sourceName)
+{
+    metrics = CompressionMetrics();
+    CompressionMetrics::PhaseTimer timer;
+
+    out.put(FORMAT_MAGIC);
+    out.put(FORMAT_VERSION);
+    out.put(static_cast<char>(contextOrder));
+    BitIO::writeUInt(out, count, 8);
+
+    const unsigned char *encode = tables().encode;
+    BasePredictor predictor(contextOrder);
+    std::vector<unsigned char> payload;
+    payload.reserve(BUFFER_SIZE + 64);
+    ArithmeticEncoder coder(payload);
+    uint64_t payloadBytes = 0;
+    ExceptionStream exceptions;
+    CaseMask caseMask;
+    uint64_t coreBases = 0;
+    bool lower = false;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        unsigned char code = encode[static_cast<unsigned char>(bases[i])];
+        if (code == INVALID_CODE)
+        {
+            // N and other ambiguity codes bypass the model
+            if (!ExceptionStream::isExceptionSymbol(bases[i]))
+            {
+                reportInvalidBase(sourceName, i, bases[i]);
+                return false;
+            }
+            exceptions.addRun(i, 1, bases[i]);
+            continue;
+        }
+
+        // The model sees upper case only; the case goes to the mask
+        bool isLower = (bases[i] & 0x20) != 0;
+        if (isLower != lower)
+        {
+            caseMask.addToggle(coreBases);
+            lower = isLower;
+        }
+        ++coreBases;
+
+        int high = code >> 1;
+        int low = code & 1;
+        coder.encode(high, predictor.predict(0));
+        predictor.update(0, high);
+        coder.encode(low, predictor.predict(1 + high));
+        predictor.update(1 + high, low);
+        predictor.push(code);
+
+        if (payload.size() >= BUFFER_SIZE)
+        {
+            out.write(reinterpret_cast<const char *>(payload.data()), static_cast<std::streamsize>(payload.size()));
+            payloadBytes += payload.size();
+            payload.clear();
+        }
+    }
+    coder.flush();
+    out.write(reinterpret_cast<const char *>(payload.data()), static_cast<std::streamsize>(payload.size()));
+    payloadBytes += payload.size();
+
+    std::vector<unsigned char> caseMaskBytes;
+    caseMask.serialize(caseMaskBytes);
+    out.write(reinterpret_cast<const char *>(caseMaskBytes.data()), static_cast<std::streamsize>(caseMaskBytes.size()));
+    BitIO::writeUInt(out, caseMaskBytes.size(), 8);
+
+    std::vector<unsigned char> exceptionBytes;
+    if (!exceptions.empty())
+    {
+        exceptions.serialize(exceptionBytes);
+    }
+    out.write(reinterpret_cast<const char *>(exceptionBytes.data()), static_cast<std::streamsize>(exceptionBytes.size()));
+    BitIO::writeUInt(out, exceptionBytes.size(), 8);
+
+    // The model adapts as it codes, so there is no separate count or build
+    metrics.addPhase(CompressionMetrics::Phase::Encoding, timer.seconds(), count);
+
+    // Same accounting as calculateCompressedSizeFromFile: the whole archive but its last byte,
+    // leaving out the size fields
+    metrics.calculateOriginalSize(static_cast<long long>(count) * 8);
+    metrics.calculateCompressedSize(
+        static_cast<long long>((HEADER_SIZE + payloadBytes + caseMaskBytes.size() + exceptionBytes.size() - 1) * 8));
+    return true;
+}
+
+void ContextModelGenome::decodeFromFile(const std::string &inputFilename, const std::string &outputFilename)
+{
+    try
+    {
+        if (inputFilename == outputFilename)
+        {
+            throw std::runtime_error("Error: Output file must be different from input file to prevent overwriting.");
+        }
+
+        LOG_INFO("Starting context-mixing decoding...");
+
+        MappedFile archive(inputFilename);
+        if (archive.size() >= 2 && (archive.data()[0] != FORMAT_MAGIC || archive.data()[1] != FORMAT_VERSION))
+        {
+            throw std::runtime_error("Error: '" + inputFilename + "' is not a context-model archive.");
+        }
+
+        std::ofstream outfile(outputFilename, std::ios::binary);
+        if (!outfile)
+        {
+            throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
+        }
+        decodeSequence(archive.bytes(), archive.size(), outfile);
+
+        outfile.close();
+
+        LOG_INFO("Context-mixing decoding completed.");
+        std::cout << "Decoding successful. Output file: " << outputFilename << "\n";
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR(std::string("Exception during context-mixing decoding: ") + e.what());
+        // Leave no partial output behind, and let the caller see the failure
+        if (inputFilename != outputFilename)
+        {
+            std::remove(outputFilename.c_str());
+        }
+        throw CompressionException(e.what());
+    }
+}
+
+void ContextModelGenome::decodeSequence(const unsigned char *archive, size_t size, std::ostream &out)
+{
+    CompressionMetrics::PhaseTimer timer;
+    if (size < HEADER_SIZE + 2 * SECTION_SIZE_FIELD)
+    {
+        throw std::runtime_error("Error: Encoded file is too small.");
+    }
+
+    const unsigned char *header = archive;
+    if (header[0] != FORMAT_MAGIC || header[1] != FORMAT_VERSION)
+    {
+        throw std::runtime_error("Error: Not a context-model archive.");
+    }
+    int order = header[2];
+    if (order < MIN_ORDER || order > MAX_ORDER)
+    {
+        throw std::runtime_error("Error: Invalid context order in encoded file.");
+    }
+    uint64_t sequenceBases = BitIO::readUInt(header + 3, 8);
+
+    // Both trailing sections are read back to front
+    uint64_t exceptionSize = BitIO::readUInt(archive + size - SECTION_SIZE_FIELD, 8);
+    if (exceptionSize > size - HEADER_SIZE - 2 * SECTION_SIZE_FIELD)
+    {
+        throw std::runtime_error("Error: Corrupt exception stream in encoded file.");
+    }
+    size_t exceptionOffset = size - SECTION_SIZE_FIELD - static_cast<size_t>(exceptionSize);
+    uint64_t caseMaskSize = BitIO::readUInt(archive + exceptionOffset - SECTION_SIZE_FIELD, 8);
+    if (caseMaskSize > exceptionOffset - HEADER_SIZE - SECTION_SIZE_FIELD)
+    {
+        throw std::runtime_error("Error: Corrupt case mask in encoded file.");
+    }
+    size_t payloadSize = exceptionOffset - SECTION_SIZE_FIELD - static_cast<size_t>(caseMaskSize) - HEADER_SIZE;
+    ExceptionStream exceptions;
+    if (exceptionSize > 0)
+    {
+        exceptions = ExceptionStream::parse(archive + exceptionOffset, static_cast<size_t>(exceptionSize));
+    }
+    if (exceptions.exceptionBases() > sequenceBases ||
+        exceptions.sequenceLength(sequenceBases - exceptions.exceptionBases()) != sequenceBases)
+    {
+        throw std::runtime_error("Error: Corrupt exception stream in encoded file.");
+    }
+    uint64_t totalBases = sequenceBases - exceptions.exceptionBases();
+    const CaseMask caseMask = CaseMask::parse(archive + HEADER_SIZE + payloadSize, static_cast<size_t>(caseMaskSize),
+                                              totalBases);
+
+    BasePredictor predictor(order);
+    ArithmeticDecoder coder(archive + HEADER_SIZE, payloadSize);
+    std::vector<char> bases(BUFFER_SIZE);
+    size_t filled = 0;
+    uint64_t written = 0;
+    ExceptionStream::Writer writer(exceptions, out);
+
+    for (uint64_t i = 0; i < totalBases; ++i)
+    {
+        int high = coder.decode(predictor.predict(0));
+        predictor.update(0, high);
+        int low = coder.decode(predictor.predict(1 + high));
+        predictor.update(1 + high, low);
+        int code = (high << 1) | low;
+        predictor.push(code);
+
+        bases[filled++] = BASE_SYMBOLS[code];
+        if (filled == bases.size())
+        {
+            if (coder.overrun())
+            {
+                throw std::runtime_error("Error: Encoded file is truncated.");
+            }
+            caseMask.apply(written, bases.data(), filled);
+            writer.write(bases.data(), filled);
+            written += filled;
+            filled = 0;
+        }
+    }
+    if (coder.overrun())
+    {
+        throw std::runtime_error("Error: Encoded file is truncated.");
+    }
+    caseMask.apply(written, bases.data(), filled);
+    writer.write(bases.data(), filled);
+    writer.finish();
+
+    metrics.clearPhase(CompressionMetrics::Phase::Decoding);
+    metrics.addPhase(CompressionMetrics::Phase::Decoding, timer.seconds(), sequenceBases);
+}
+
+CompressionMetrics ContextModelGenome::getMetrics() const
+{
+    return metrics;
+}
+
+bool ContextModelGenome::validateDecodedFile(const std::string &originalFilename, const std::string &decodedFilename)
+{
+    try
+    {
+        LOG_DEBUG("Validating decoded file...");
+
+        const size_t VALIDATION_BUFFER_SIZE = 65536;
+        std::ifstream originalFile(originalFilename, std::ios::binary);
+        std::ifstream decodedFile(decodedFilename, std::ios::binary);
+
+        if (!originalFile.is_open())
+        {
+            throw std::runtime_error("Error: Unable to open original file '" + originalFilename + "'.");
+        }
+        if (!decodedFile.is_open())
+        {
+            throw std::runtime_error("Error: Unable to open decoded file '" + decodedFilename + "'.");
+        }
+
+        std::vector<char> originalBuffer(VALIDATION_BUFFER_SIZE);
+        std::vector<char> decodedBuffer(VALIDATION_BUFFER_SIZE);
+
+        while (true)
+        {
+            originalFile.read(originalBuffer.data(), VALIDATION_BUFFER_SIZE);
+            std::streamsize originalBytesRead = originalFile.gcount();
+
+            decodedFile.read(decodedBuffer.data(), VALIDATION_BUFFER_SIZE);
+            std::streamsize decodedBytesRead = decodedFile.gcount();
+
+            if (originalBytesRead != decodedBytesRead)
+            {
+                LOG_ERROR("Error: Files have different sizes.");
+                return false;
+            }
+            if (originalBytesRead == 0)
+            {
+                break;
+            }
+
+            if (std::memcmp(originalBuffer.data(), decodedBuffer.data(), static_cast<size_t>(originalBytesRead)) != 0)
+            {
+                LOG_ERROR("Error: Files differ.");
+                return false;
+            }
+        }
+
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR(std::string("Exception during validation: ") + e.what());
+        return false;
+    }
+}
@@ -0,0 +1,220 @@
+#include "ExceptionStream.h"
+#include "BaseClassifier.h"
+#include "BitIO.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+const size_t RUN_BUFFER_SIZE = 64 * 1024;
+
+bool ExceptionStream::isExceptionSymbol(char ch)
+{
+    switch (ch | 0x20)
+    {
+    case 'n':
+    case 'r':
+    case 'y':
+    case 's':
+    case 'w':
+    case 'k':
+    case 'm':
+    case 'b':
+    case 'd':
+    case 'h':
+    case 'v':
+        return true;
+    default:
+        return false;
+    }
+}
+
+size_t ExceptionStream::split(const char *data, size_t size, uint64_t offset, std::string &core)
+{
+    size_t pos = 0;
+    while (pos < size)
+    {
+        size_t bases = BaseClassifier::findInvalid(data + pos, size - pos);
+        core.append(data + pos, bases);
+        pos += bases;
+        if (pos == size)
+        {
+            break;
+        }
+
+        char symbol = data[pos];
+        if (!isExceptionSymbol(symbol))
+        {
+            return pos;
+        }
+        size_t end = pos + 1;
+        while (end < size && data[end] == symbol)
+        {
+            ++end;
+        }
+        addRun(offset + pos, end - pos, symbol);
+        pos = end;
+    }
+    return size;
+}
+
+void ExceptionStream::addRun(uint64_t position, uint64_t length, char symbol)
+{
+    if (!runs.empty())
+    {
+        Run &last = runs.back();
+        if (last.symbol == symbol && last.position + last.length == position)
+        {
+            last.length += length;
+            totalExceptionBases += length;
+            return;
+        }
+    }
+    runs.push_back(Run{position, length, symbol});
+    basesBefore.push_back(totalExceptionBases);
+    totalExceptionBases += length;
+}
+
+void ExceptionStream::serialize(std::vector<unsigned char> &out) const
+{
+    BitIO::writeVarint(out, runs.size());
+    uint64_t previousEnd = 0;
+    for (const Run &run : runs)
+    {
+        BitIO::writeVarint(out, run.position - previousEnd);
+        BitIO::writeVarint(out, run.length);
+        out.push_back(static_cast<unsigned char>(run.symbol));
+        previousEnd = run.position + run.length;
+    }
+}
+
+ExceptionStream ExceptionStream::parse(const unsigned char *data, size_t size)
+{
+    ExceptionStream exceptions;
+    size_t pos = 0;
+    uint64_t runCount = BitIO::readVarint(data, size, pos);
+    if (runCount > size)
+    {
+        throw std::runtime_error("Error: Corrupt exception stream in archive.");
+    }
+    uint64_t previousEnd = 0;
+    for (uint64_t i = 0; i < runCount; ++i)
+    {
+        uint64_t gap = BitIO::readVarint(data, size, pos);
+        uint64_t length = BitIO::readVarint(data, size, pos);
+        if (pos >= size || length == 0 || !isExceptionSymbol(static_cast<char>(data[pos])) ||
+            gap > UINT64_MAX - previousEnd || length > UINT64_MAX - previousEnd - gap)
+        {
+            throw std::runtime_error("Error: Corrupt exception stream in archive.");
+        }
+        exceptions.addRun(previousEnd + gap, length, static_cast<char>(data[pos++]));
+        previousEnd += gap + length;
+    }
+    if (pos != size || exceptions.runs.size() != runCount)
+    {
+        throw std::runtime_error("Error: Corrupt exception stream in archive.");
+    }
+    return exceptions;
+}
+
+uint64_t ExceptionStream::sequenceLength(uint64_t coreBases) const
+{
+    if (totalExceptionBases > UINT64_MAX - coreBases)
+    {
+        throw std::runtime_error("Error: Corrupt exception stream in archive.");
+    }
+    uint64_t length = coreBases + totalExceptionBases;
+    if (!runs.empty() && runs.back().position + runs.back().length > length)
+    {
+        throw std::runtime_error("Error: Corrupt exception stream in archive.");
+    }
+    return length;
+}
+
+uint64_t ExceptionStream::corePosition(uint64_t position) const
+{
+    // The last run starting before `position` tells how many exception bases precede it
+    auto after = std::upper_bound(runs.begin(), runs.end(), position,
+                                  [](uint64_t value, const Run &run) { return value < run.position; });
+    if (after == runs.begin())
+    {
+        return position;
+    }
+    size_t index = static_cast<size_t>(after - runs.begin()) - 1;
+    const Run &run = runs[index];
+    return position - basesBefore[index] - std::min(run.length, position - run.position);
+}
+
+void ExceptionStream::merge(const char *core, uint64_t start, uint64_t length, char *output) const
+{
+    auto run = std::upper_bound(runs.begin(), runs.end(), start,
+                                [](uint64_t value, const Run &r) { return value < r.position + r.length; });
+    uint64_t position = start;
+    const uint64_t end = start + length;
+    while (position < end)
+    {
+        if (run != runs.end() && run->position <= position)
+        {
+            uint64_t count = std::min(run->position + run->length, end) - position;
+            std::memset(output, run->symbol, static_cast<size_t>(count));
+            output += count;
+            position += count;
+            ++run;
+            continue;
+        }
+        uint64_t count = std::min(run != runs.end() ? run->position : end, end) - position;
+        std::memcpy(output, core, static_cast<size_t>(count));
+        output += count;
+        core += count;
+        position += count;
+    }
+}
+
+ExceptionStream::Writer::Writer(const ExceptionStream &exceptions, std::ostream &out)
+    : runs(exceptions.runs), out(out), nextRun(0), position(0)
+{
+}
+
+void ExceptionStream::Writer::write(const char *core, size_t count)
+{
+    while (count > 0)
+    {
+        if (nextRun < runs.size() && runs[nextRun].position == position)
+        {
+            writeRun(runs[nextRun++]);
+            continue;
+        }
+        size_t bases = count;
+        if (nextRun < runs.size())
+        {
+            bases = static_cast<size_t>(std::min<uint64_t>(count, runs[nextRun].position - position));
+        }
+        out.write(core, static_cast<std::streamsize>(bases));
+        core += bases;
+        count -= bases;
+        position += bases;
+    }
+}
+
+void ExceptionStream::Writer::finish()
+{
+    while (nextRun < runs.size())
+    {
+        if (runs[nextRun].position != position)
+        {
+            throw std::runtime_error("Error: Exception stream does not match the decoded bases.");
+        }
+        writeRun(runs[nextRun++]);
+    }
+}
+
+void ExceptionStream::Writer::writeRun(const Run &run)
+{
+    std::string buffer(static_cast<size_t>(std::min<uint64_t>(run.length, RUN_BUFFER_SIZE)), run.symbol);
+    for (uint64_t left = run.length; left > 0;)
+    {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(left, buffer.size()));
+        out.write(buffer.data(), static_cast<std::streamsize>(count));
+        left -= count;
+    }
+    position += run.length;
+}
@@ -1,19 +1,117 @@
 #include "HuffmanCompressor.h"
 #include "Logger.h"
 #include <fstream>
+#include <cstdio>
 #include <sstream>
 #include <stdexcept>
-#include <bitset>
 #include <vector>
 #include <cstring>
 #include <queue>
 #include <FileValidator.h>
 #include <CompressionException.h>
-#include <iomanip>
+#include "BitIO.h"
+#include "MappedFile.h"
+#include "RansTable.h"
+#include <algorithm>
+
+// Archive layout: magic, version, entropy coder, model scope, stream count, then with the global model
+//   Huffman: code lengths (HuffmanTable::writeLengths), payload, padding-bits byte
+//   rANS:    frequencies (RansTable::writeFrequencies), u64 byte count, and per
+//            block of BLOCK_SIZE bytes a u32 stream size followed by the stream
+// or with block models a u64 byte count, and per block of BLOCK_SIZE bytes its code
+// lengths or frequencies, a u32 payload size (bits for Huffman, bytes for rANS) and the payload.
+// With four streams, a Huffman payload is instead a u32 bit length per stream followed by the
+// streams, each byte-aligned and coding one segment of the block; the global model then also
+// splits the input into blocks, after a u64 byte count, in place of the single payload.
+const char FORMAT_MAGIC = 'H';
+const char FORMAT_VERSION = 4;
+const size_t BLOCK_SIZE = 1024 * 1024;
+const size_t HEADER_SIZE = 5;
+
+namespace
+{
+    void writeStreams(const HuffmanTable &table, const unsigned char *data, size_t count, std::ostream &out)
+    {
+        std::vector<unsigned char> streams;
+        uint64_t bitLengths[HuffmanTable::STREAM_COUNT];
+        for (int s = 0; s < HuffmanTable::STREAM_COUNT; ++s)
+        {
+            BitWriter writer(streams);
+            for (size_t i = HuffmanTable::streamOffset(count, s); i < HuffmanTable::streamOffset(count, s + 1); ++i)
+            {
+                writer.write(table.getCode(data[i]), table.getLength(data[i]));
+            }
+            bitLengths[s] = writer.bitsWritten();
+            writer.finish();
+        }
+        for (uint64_t bits : bitLengths)
+        {
+            BitIO::writeUInt(out, bits, 4);
+        }
+        out.write(reinterpret_cast<const char *>(streams.data()), static_cast<std::streamsize>(streams.size()));
+    }
+
+    // Decodes what writeStreams wrote at bytes + pos and moves pos past it
+    void readStreams(const HuffmanTable &table, const unsigned char *bytes, size_t size, size_t &pos, char *output,
+                     size_t count)
+    {
+        const size_t tableSize = 4 * HuffmanTable::STREAM_COUNT;
+        if (size - pos < tableSize)
+        {
+            throw std::runtime_error("Error: Encoded file is too small.");
+        }
+        const unsigned char *streams[HuffmanTable::STREAM_COUNT];
+        uint64_t bitLengths[HuffmanTable::STREAM_COUNT];
+        uint64_t streamBytes = 0;
+        for (int s = 0; s < HuffmanTable::STREAM_COUNT; ++s)
+        {
+            bitLengths[s] = BitIO::readUInt(bytes + pos + 4 * s, 4);
+            streamBytes += (bitLengths[s] + 7) / 8;
+        }
+        pos += tableSize;
+        if (size - pos < streamBytes)
+        {
+            throw std::runtime_error("Error: Encoded file is too small.");
+        }
+        for (int s = 0; s < HuffmanTable::STREAM_COUNT; ++s)
+        {
+            streams[s] = bytes + pos;
+            pos += static_cast<size_t>((bitLengths[s] + 7) / 8);
+        }
+        if (table.decodeStreams(streams, bitLengths, output, count) != count)
+        {
+            throw std::runtime_error("Error: Decoding failed. A block holds fewer bytes than recorded.");
+        }
+    }
+}
 
-const size_t BUFFER_SIZE = 65536; // 64 KB buffer
+HuffmanCompressor::HuffmanCompressor()
+    : frequencyMap{}, root(nullptr), entropyCoder(EntropyCoder::Huffman), modelScope(ModelScope::Global),
+      streamCount(1), threadCount(1) {}
 
-HuffmanCompressor::HuffmanCompressor() : root(nullptr) {}
+void HuffmanCompressor::setEntropyCoder(EntropyCoder coder)
+{
+    entropyCoder = coder;
+}
+
+void HuffmanCompressor::setThreadCount(unsigned int threads)
+{
+    threadCount = threads;
+}
+
+void HuffmanCompressor::setModelScope(ModelScope scope)
+{
+    modelScope = scope;
+}
+
+void HuffmanCompressor::setStreamCount(unsigned int streams)
+{
+    if (streams != 1 && streams != HuffmanTable::STREAM_COUNT)
+    {
+        throw std::invalid_argument("Stream count must be 1 or " + std::to_string(HuffmanTable::STREAM_COUNT) + ".");
+    }
+    streamCount = streams;
+}
 
 HuffmanCompressor::~HuffmanCompressor()
 {
@@ -33,14 +131,14 @@ bool HuffmanCompressor::validateInputFile(const std::string &inputFilename) cons
 {
     if (!FileValidator::hasTxtExtension(inputFilename))
     {
-        Logger::getInstance().log("Validation Error: File '" + inputFilename + "' does not have a .txt extension.");
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' does not have a .txt extension.");
         std::cerr << "Error: Unsupported file format. Only .txt files are allowed.\n";
         return false;
     }
 
     if (!FileValidator::fileExists(inputFilename))
     {
-        Logger::getInstance().log("Validation Error: File '" + inputFilename + "' does not exist.");
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' does not exist.");
         std::cerr << "Error: File does not exist.\n";
         return false;
     }
@@ -54,14 +152,16 @@ void HuffmanCompressor::saveFrequencyMap(const std::string &freqFilename)
         throw std::runtime_error("Error: Unable to create frequency map file '" + freqFilename + "'.");
     }
 
-    for (const auto &entry : frequencyMap)
+    for (int byteValue = 0; byteValue < 256; ++byteValue)
     {
-        int byteValue = static_cast<int>(entry.first);
-        freqFile << byteValue << " " << entry.second << "\n";
+        if (frequencyMap[byteValue] != 0)
+        {
+            freqFile << byteValue << " " << frequencyMap[byteValue] << "\n";
+        }
     }
 
     freqFile.close();
-    Logger::getInstance().log("Frequency map saved to '" + freqFilename + "'.");
+    LOG_DEBUG("Frequency map saved to '" + freqFilename + "'.");
 }
 
 void HuffmanCompressor::loadFrequencyMap(const std::string &freqFilename)
@@ -72,7 +172,7 @@ void HuffmanCompressor::loadFrequencyMap(const std::string &freqFilename)
         throw std::runtime_error("Error: Unable to open frequency map file '" + freqFilename + "'.");
     }
 
-    frequencyMap.clear();
+    frequencyMap.fill(0);
     std::string line;
     while (std::getline(freqFile, line))
     {
@@ -81,7 +181,7 @@ void HuffmanCompressor::loadFrequencyMap(const std::string &freqFilename)
 
         std::istringstream iss(line);
         int byteValue;
-        int freq;
+        uint64_t freq;
 
         iss >> byteValue >> freq;
         if (iss.fail() || byteValue < 0 || byteValue > 255)
@@ -94,126 +194,133 @@ void HuffmanCompressor::loadFrequencyMap(const std::string &freqFilename)
     }
 
     freqFile.close();
-    Logger::getInstance().log("Frequency map loaded from '" + freqFilename + "'.");
+    LOG_DEBUG("Frequency map loaded from '" + freqFilename + "'.");
 }
 
 void HuffmanCompressor::encodeFromFile(const std::string &inputFilename, const std::string &outputFilename)
 {
     try
     {
-        Logger::getInstance().log("Starting Huffman encoding...***");
+        LOG_INFO("Starting Huffman encoding...***");
 
         deleteTree(root);
         root = nullptr;
-        huffmanCodes.clear();
-        frequencyMap.clear();
+        codeTable.clear();
+        frequencyMap.fill(0);
         metrics = CompressionMetrics();
 
-        // Open input file
-        std::ifstream infile(inputFilename, std::ios::binary);
-        if (!infile)
-        {
-            throw std::runtime_error("Error: Unable to open input file '" + inputFilename + "'.");
-        }
+        // Both passes read the mapped input straight from the page cache
+        MappedFile input(inputFilename);
+        const unsigned char *data = input.bytes();
 
-        // Build frequency map
-        char buffer[BUFFER_SIZE];
-        while (infile.read(buffer, sizeof(buffer)) || infile.gcount())
+        // The global model needs the whole input counted first; block models count as they go
+        const bool blockModels = modelScope == ModelScope::Block;
+        CompressionMetrics::PhaseTimer timer;
+        if (!blockModels)
         {
-            std::streamsize bytesRead = infile.gcount();
-
-            for (std::streamsize i = 0; i < bytesRead; ++i)
-            {
-                unsigned char byte = static_cast<unsigned char>(buffer[i]);
-                frequencyMap[byte]++;
-            }
+            // Build frequency map
+            frequencyMap = ByteHistogram::count(data, input.size(), threadCount);
+            metrics.addPhase(CompressionMetrics::Phase::Counting, timer.seconds(), input.size());
+
+            // Build Huffman tree
+            timer.restart();
+            buildTree();
+            metrics.addPhase(CompressionMetrics::Phase::ModelBuild, timer.seconds(), 0);
         }
-
-        infile.clear();
-        infile.seekg(0, std::ios::beg); // Rewind file
-
-        // Build Huffman tree
-        buildTree();
-
-        std::string freqFilename = outputFilename + ".freq";
-        saveFrequencyMap(freqFilename);
-
-        //  std::string freqFilename = outputFilename + ".freq";
-        // saveFrequencyMap(freqFilename);
-        // Logger::getInstance().log("Frequency map saved to '" + freqFilename + "'.");
+        timer.restart();
 
         // Open output file
         std::ofstream outfile(outputFilename, std::ios::binary);
         if (!outfile)
         {
-            infile.close();
             throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
         }
 
-        // Encode and write to output file
-        std::string bitBuffer;
-        while (infile.read(buffer, sizeof(buffer)) || infile.gcount())
-        {
-            std::streamsize bytesRead = infile.gcount();
+        outfile.put(FORMAT_MAGIC);
+        outfile.put(FORMAT_VERSION);
+        outfile.put(static_cast<char>(entropyCoder));
+        outfile.put(static_cast<char>(modelScope));
+        const bool splitStreams = entropyCoder == EntropyCoder::Huffman && streamCount > 1;
+        outfile.put(static_cast<char>(splitStreams ? streamCount : 1));
 
-            for (std::streamsize i = 0; i < bytesRead; ++i)
+        int paddingBits = 0;
+        if (blockModels)
+        {
+            encodeBlocks(data, input.size(), outfile);
+        }
+        else if (splitStreams)
+        {
+            codeTable.writeLengths(outfile);
+            BitIO::writeUInt(outfile, input.size(), 8);
+            for (size_t offset = 0; offset < input.size(); offset += BLOCK_SIZE)
             {
-                unsigned char byte = static_cast<unsigned char>(buffer[i]);
-                bitBuffer += huffmanCodes[byte];
-                // Write bytes to file when we have at least 8 bits
-                while (bitBuffer.size() >= 8)
-                {
-                    std::bitset<8> byteBits(bitBuffer.substr(0, 8));
-                    unsigned char outputByte = static_cast<unsigned char>(byteBits.to_ulong());
-                    outfile.put(outputByte);
-                    bitBuffer.erase(0, 8);
-                }
+                writeStreams(codeTable, data + offset, std::min(BLOCK_SIZE, input.size() - offset), outfile);
             }
         }
-
-        // Write remaining bits (if any)
-        int paddingBits = 0;
-        if (!bitBuffer.empty())
+        else if (entropyCoder == EntropyCoder::Rans)
         {
-            paddingBits = 8 - bitBuffer.size();
-            bitBuffer.append(paddingBits, '0'); // Pad with zeros
-            std::bitset<8> byteBits(bitBuffer);
-            unsigned char byte = static_cast<unsigned char>(byteBits.to_ulong());
-            outfile.put(byte);
+            RansTable ransTable;
+            ransTable.buildFromCounts(frequencyMap);
+            ransTable.writeFrequencies(outfile);
+            BitIO::writeUInt(outfile, input.size(), 8);
+
+            // Blocks keep the encoder's scratch space bounded
+            std::vector<unsigned char> stream;
+            for (size_t offset = 0; offset < input.size(); offset += BLOCK_SIZE)
+            {
+                stream.clear();
+                ransTable.encode(data + offset, std::min(BLOCK_SIZE, input.size() - offset), stream);
+                BitIO::writeUInt(outfile, stream.size(), 4);
+                outfile.write(reinterpret_cast<const char *>(stream.data()), static_cast<std::streamsize>(stream.size()));
+            }
         }
+        else
+        {
+            // Only the canonical code lengths are stored; the decoder rebuilds codes from them
+            codeTable.writeLengths(outfile);
 
-        // Log padding bits added
-        Logger::getInstance().log("Padding bits added during encoding: " + std::to_string(paddingBits));
+            // Encode and write to output file
+            BitWriter writer(outfile);
+            for (size_t i = 0; i < input.size(); ++i)
+            {
+                writer.write(codeTable.getCode(data[i]), codeTable.getLength(data[i]));
+            }
 
-        // Write padding information as the last byte
-        outfile.put(static_cast<char>(paddingBits));
+            // Pad the last byte with zeros
+            paddingBits = writer.finish();
 
-        infile.close();
-        outfile.close();
+            // Log padding bits added
+            LOG_DEBUG("Padding bits added during encoding: " + std::to_string(paddingBits));
 
-        std::ifstream originalFile(inputFilename, std::ios::binary | std::ios::ate);
-        if (originalFile)
+            // Write padding information as the last byte
+            outfile.put(static_cast<char>(paddingBits));
+        }
+        if (!blockModels)
         {
-            std::streamsize size = originalFile.tellg();
-            metrics.calculateOriginalSize(size * 8); // Total bits
-            originalFile.close();
+            metrics.addPhase(CompressionMetrics::Phase::Encoding, timer.seconds(), input.size());
         }
 
+        timer.restart();
+        const uint64_t archiveBytes = static_cast<uint64_t>(outfile.tellp());
+        outfile.close();
+        metrics.addPhase(CompressionMetrics::Phase::Io, timer.seconds(), archiveBytes);
+
+        metrics.calculateOriginalSize(frequencyMap);
         metrics.calculateCompressedSizeFromFile(outputFilename, paddingBits);
 
-        Logger::getInstance().log("HuffmanCompressor encoding completed.");
+        LOG_INFO("HuffmanCompressor encoding completed.");
         // Logger::getInstance().log("Compression succesfful ad in");
         std::cout << "Compression successful. Output file: " << outputFilename << "\n";
     }
-    catch (const CompressionException &ce)
-    {
-        Logger::getInstance().log(std::string("CompressionException during HuffmanCompressor encoding: ") + ce.what());
-        std::cerr << ce.what() << std::endl;
-    }
     catch (const std::exception &e)
     {
-        Logger::getInstance().log(std::string("Exception during HuffmanCompressor encoding: ") + e.what());
-        std::cerr << "An unexpected error occurred: " << e.what() << std::endl;
+        LOG_ERROR(std::string("Exception during HuffmanCompressor encoding: ") + e.what());
+        // Leave no partial output behind, and let the caller see the failure
+        if (inputFilename != outputFilename)
+        {
+            std::remove(outputFilename.c_str());
+        }
+        throw CompressionException(e.what());
     }
 }
 
@@ -221,135 +328,288 @@ void HuffmanCompressor::decodeFromFile(const std::string &inputFilename, const s
 {
     try
     {
-        Logger::getInstance().log("Starting Huffman decoding...");
+        LOG_INFO("Starting Huffman decoding...");
         if (inputFilename == outputFilename)
         {
             throw std::runtime_error("Error: Output file must be different from input file to prevent overwriting.");
         }
-        // Ensure that the Huffman tree has been built
-        std::string freqFilename = inputFilename + ".freq";
-        if (!FileValidator::fileExists(freqFilename))
+
+        MappedFile archive(inputFilename);
+        if (archive.size() < HEADER_SIZE)
         {
-            throw std::runtime_error("Error: Frequency map file '" + freqFilename + "' does not exist.");
+            throw std::runtime_error("Error: '" + inputFilename + "' is not a Huffman archive.");
         }
 
-        // Load frequency map
-        loadFrequencyMap(freqFilename);
-
-       // std::cout << "Frequency map loaded from '" << freqFilename << "'.\n";
-
-        // Rebuild Huffman tree using the frequency map
-        deleteTree(root);
-        root = nullptr;
-        buildTree();
-        std::cout << "Huffman tree rebuilt successfully.\n";
-
-        // Open input file
-        std::ifstream infile(inputFilename, std::ios::binary);
-        if (!infile)
+        // Rebuild the code table straight from the stored lengths or frequencies
+        if (archive.data()[0] != FORMAT_MAGIC || archive.data()[1] != FORMAT_VERSION)
+        {
+            throw std::runtime_error("Error: '" + inputFilename + "' is not a Huffman archive.");
+        }
+        const unsigned char coder = archive.bytes()[2];
+        if (coder != static_cast<unsigned char>(EntropyCoder::Huffman) && coder != static_cast<unsigned char>(EntropyCoder::Rans))
+        {
+            throw std::runtime_error("Error: Unknown entropy coder in '" + inputFilename + "'.");
+        }
+        const unsigned char scope = archive.bytes()[3];
+        if (scope != static_cast<unsigned char>(ModelScope::Global) && scope != static_cast<unsigned char>(ModelScope::Block))
+        {
+            throw std::runtime_error("Error: Unknown model scope in '" + inputFilename + "'.");
+        }
+        const unsigned char streams = archive.bytes()[4];
+        if (streams != 1 && streams != HuffmanTable::STREAM_COUNT)
         {
-            throw std::runtime_error("Error: Unable to open input file '" + inputFilename + "'.");
+            throw std::runtime_error("Error: Unknown stream count in '" + inputFilename + "'.");
         }
+        const bool splitStreams = streams != 1 && coder == static_cast<unsigned char>(EntropyCoder::Huffman);
+        MemoryStreamBuf headerBuffer(archive.bytes() + HEADER_SIZE, archive.size() - HEADER_SIZE);
+        std::istream header(&headerBuffer);
 
         // Open output file
         std::ofstream outfile(outputFilename, std::ios::binary);
         if (!outfile)
         {
-            infile.close();
             throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
         }
 
-        // Read padding bits count from the last byte
-        infile.seekg(-1, std::ios::end);
-        char paddingBitsChar;
-        infile.get(paddingBitsChar);
-        int paddingBits = static_cast<unsigned char>(paddingBitsChar);
-        Logger::getInstance().log("Padding bits read during decoding: " + std::to_string(paddingBits));
-
-        if (paddingBits < 0 || paddingBits > 7)
+        CompressionMetrics::PhaseTimer timer;
+        uint64_t decodedBytes = 0;
+        if (scope == static_cast<unsigned char>(ModelScope::Block))
         {
-            throw std::runtime_error("Error: Invalid padding bits value in encoded file.");
+            decodedBytes = decodeBlocks(archive.bytes(), archive.size(), HEADER_SIZE,
+                                        coder == static_cast<unsigned char>(EntropyCoder::Rans), splitStreams, outfile);
         }
-
-        infile.seekg(0, std::ios::end);
-        std::streampos fileSize = infile.tellg();
-        size_t encodedDataSize = static_cast<size_t>(fileSize) - 1; // Exclude padding bits byte
-
-        infile.seekg(0, std::ios::beg); // Reset to the beginning
-
-        std::string bitString;
-        char ch;
-        size_t bytesRead = 0;
-        while (bytesRead < encodedDataSize && infile.get(ch))
+        else if (splitStreams)
         {
-            std::bitset<8> bits(static_cast<unsigned char>(ch));
-            bitString += bits.to_string();
-            bytesRead++;
-        }
-        infile.close();
+            codeTable.buildFromLengths(HuffmanTable::readLengths(header));
+            size_t pos = HEADER_SIZE + headerBuffer.position();
+            if (!header || archive.size() - pos < 8)
+            {
+                throw std::runtime_error("Error: Encoded file is too small.");
+            }
+            const uint64_t totalBytes = BitIO::readUInt(archive.bytes() + pos, 8);
+            pos += 8;
 
-        if (paddingBits > 0)
-        {
-            if (paddingBits > bitString.size())
+            std::vector<char> block(BLOCK_SIZE + HuffmanTable::DECODE_SLACK);
+            for (uint64_t done = 0; done < totalBytes; done += BLOCK_SIZE)
             {
-                throw std::runtime_error("Error: Padding bits exceed the size of the bit string.");
+                size_t count = static_cast<size_t>(std::min<uint64_t>(BLOCK_SIZE, totalBytes - done));
+                readStreams(codeTable, archive.bytes(), archive.size(), pos, block.data(), count);
+                outfile.write(block.data(), static_cast<std::streamsize>(count));
             }
-            bitString.erase(bitString.end() - paddingBits, bitString.end());
+            decodedBytes = totalBytes;
         }
-        // Decode the bit string
-        size_t decodedBytes = 0;
-        HuffmanNode *currentNode = root;
-        for (size_t i = 0; i < bitString.size(); ++i)
+        else if (coder == static_cast<unsigned char>(EntropyCoder::Rans))
         {
-            char bitChar = bitString[i];
-            if (bitChar == '0')
-            {
-                currentNode = currentNode->left;
-            }
-            else if (bitChar == '1')
+            RansTable ransTable;
+            ransTable.buildFromFrequencies(RansTable::readFrequencies(header));
+            uint64_t totalBytes = BitIO::readUInt(header, 8);
+            size_t pos = HEADER_SIZE + headerBuffer.position();
+
+            std::vector<unsigned char> block(BLOCK_SIZE);
+            for (uint64_t done = 0; done < totalBytes; done += BLOCK_SIZE)
             {
-                currentNode = currentNode->right;
+                size_t count = static_cast<size_t>(std::min<uint64_t>(BLOCK_SIZE, totalBytes - done));
+                if (archive.size() - pos < 4)
+                {
+                    throw std::runtime_error("Error: Encoded file is too small.");
+                }
+                size_t streamSize = static_cast<size_t>(BitIO::readUInt(archive.bytes() + pos, 4));
+                pos += 4;
+                if (archive.size() - pos < streamSize)
+                {
+                    throw std::runtime_error("Error: Encoded file is too small.");
+                }
+                ransTable.decode(archive.bytes() + pos, streamSize, block.data(), count);
+                outfile.write(reinterpret_cast<const char *>(block.data()), static_cast<std::streamsize>(count));
+                pos += streamSize;
             }
-            else
+            decodedBytes = totalBytes;
+        }
+        else
+        {
+            codeTable.buildFromLengths(HuffmanTable::readLengths(header));
+            size_t headerSize = HEADER_SIZE + headerBuffer.position();
+
+            if (archive.size() < headerSize + 1)
             {
-                throw std::runtime_error("Error: Invalid bit character in bit string.");
+                throw std::runtime_error("Error: Encoded file is too small.");
             }
 
-            if (!currentNode)
+            // Read padding bits count from the last byte
+            int paddingBits = archive.bytes()[archive.size() - 1];
+            LOG_DEBUG("Padding bits read during decoding: " + std::to_string(paddingBits));
+
+            if (paddingBits < 0 || paddingBits > 7)
             {
-                throw std::runtime_error("Error: Decoding failed. Invalid path in Huffman tree.");
+                throw std::runtime_error("Error: Invalid padding bits value in encoded file.");
             }
 
-            // leaf
-            if (!currentNode->left && !currentNode->right)
+            size_t encodedDataSize = archive.size() - headerSize - 1; // Exclude padding bits byte
+
+            uint64_t totalBits = static_cast<uint64_t>(encodedDataSize) * 8;
+            if (static_cast<uint64_t>(paddingBits) > totalBits)
             {
-                outfile.put(static_cast<char>(currentNode->byte));
-                decodedBytes++;
-                // Log each decoded byte
-                // Logger::getInstance().log("Decoded byte: '" + std::string(1, static_cast<char>(currentNode->byte)) + "'");
-                currentNode = root;
+                throw std::runtime_error("Error: Padding bits exceed the size of the bit string.");
             }
+            totalBits -= paddingBits;
+
+            BitReader reader(archive.bytes() + headerSize, encodedDataSize, totalBits);
+            decodedBytes = codeTable.decode(reader, outfile);
         }
 
         outfile.close();
+        metrics.clearPhase(CompressionMetrics::Phase::Decoding);
+        metrics.addPhase(CompressionMetrics::Phase::Decoding, timer.seconds(), decodedBytes);
         std::cout << "Total decoded bytes: " << decodedBytes << "\n";
 
-        Logger::getInstance().log("Huffman decoding completed.");
+        LOG_INFO("Huffman decoding completed.");
         std::cout << "Decoding successful. Output file: " << outputFilename << "\n";
     }
     catch (const std::exception &e)
     {
-        Logger::getInstance().log(std::string("Exception during Huffman decoding: ") + e.what());
+        LOG_ERROR(std::string("Exception during Huffman decoding: ") + e.what());
+        // Leave no partial output behind, and let the caller see the failure
+        if (inputFilename != outputFilename)
+        {
+            std::remove(outputFilename.c_str());
+        }
+        throw CompressionException(e.what());
     }
 }
 
+void HuffmanCompressor::encodeBlocks(const unsigned char *data, size_t size, std::ostream &out)
+{
+    BitIO::writeUInt(out, size, 8);
+    std::vector<unsigned char> payload;
+    for (size_t offset = 0; offset < size; offset += BLOCK_SIZE)
+    {
+        const size_t count = std::min(BLOCK_SIZE, size - offset);
+        CompressionMetrics::PhaseTimer timer;
+        ByteHistogram::Counts counts{};
+        ByteHistogram::add(data + offset, count, counts);
+        for (int byte = 0; byte < 256; ++byte)
+        {
+            frequencyMap[byte] += counts[byte];
+        }
+        metrics.addPhase(CompressionMetrics::Phase::Counting, timer.seconds(), count);
+
+        timer.restart();
+        payload.clear();
+        uint64_t payloadSize;
+        if (entropyCoder == EntropyCoder::Rans)
+        {
+            RansTable table;
+            table.buildFromCounts(counts);
+            metrics.addPhase(CompressionMetrics::Phase::ModelBuild, timer.seconds(), 0);
+            timer.restart();
+            table.writeFrequencies(out);
+            table.encode(data + offset, count, payload);
+            payloadSize = payload.size();
+        }
+        else
+        {
+            HuffmanTable table;
+            table.buildFromCounts(counts);
+            metrics.addPhase(CompressionMetrics::Phase::ModelBuild, timer.seconds(), 0);
+            timer.restart();
+            table.writeLengths(out);
+            if (streamCount > 1)
+            {
+                writeStreams(table, data + offset, count, out);
+                metrics.addPhase(CompressionMetrics::Phase::Encoding, timer.seconds(), count);
+                continue;
+            }
+            BitWriter writer(payload);
+            for (size_t i = offset; i < offset + count; ++i)
+            {
+                writer.write(table.getCode(data[i]), table.getLength(data[i]));
+            }
+            payloadSize = writer.bitsWritten();
+            writer.finish();
+        }
+        BitIO::writeUInt(out, payloadSize, 4);
+        out.write(reinterpret_cast<const char *>(payload.data()), static_cast<std::streamsize>(payload.size()));
+        metrics.addPhase(CompressionMetrics::Phase::Encoding, timer.seconds(), count);
+    }
+}
+
+uint64_t HuffmanCompressor::decodeBlocks(const unsigned char *bytes, size_t size, size_t pos, bool useRans,
+                                         bool splitStreams, std::ostream &out) const
+{
+    if (size - pos < 8)
+    {
+        throw std::runtime_error("Error: Encoded file is too small.");
+    }
+    const uint64_t totalBytes = BitIO::readUInt(bytes + pos, 8);
+    pos += 8;
+
+    std::vector<char> block(BLOCK_SIZE + HuffmanTable::DECODE_SLACK);
+    for (uint64_t done = 0; done < totalBytes; done += BLOCK_SIZE)
+    {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(BLOCK_SIZE, totalBytes - done));
+        MemoryStreamBuf tableBuffer(bytes + pos, size - pos);
+        std::istream tableStream(&tableBuffer);
+        RansTable ransTable;
+        HuffmanTable huffmanTable;
+        if (useRans)
+        {
+            ransTable.buildFromFrequencies(RansTable::readFrequencies(tableStream));
+        }
+        else
+        {
+            huffmanTable.buildFromLengths(HuffmanTable::readLengths(tableStream));
+        }
+        pos += tableBuffer.position();
+        if (!tableStream)
+        {
+            throw std::runtime_error("Error: Encoded file is too small.");
+        }
+        if (splitStreams)
+        {
+            readStreams(huffmanTable, bytes, size, pos, block.data(), count);
+            out.write(block.data(), static_cast<std::streamsize>(count));
+            continue;
+        }
+        if (size - pos < 4)
+        {
+            throw std::runtime_error("Error: Encoded file is too small.");
+        }
+        const uint64_t payloadSize = BitIO::readUInt(bytes + pos, 4);
+        pos += 4;
+        const uint64_t payloadBytes = useRans ? payloadSize : (payloadSize + 7) / 8;
+        if (size - pos < payloadBytes)
+        {
+            throw std::runtime_error("Error: Encoded file is too small.");
+        }
+
+        if (useRans)
+        {
+            ransTable.decode(bytes + pos, static_cast<size_t>(payloadBytes), reinterpret_cast<unsigned char *>(block.data()), count);
+        }
+        else
+        {
+            BitReader reader(bytes + pos, static_cast<size_t>(payloadBytes), payloadSize);
+            if (huffmanTable.decode(reader, block.data(), count) != count)
+            {
+                throw std::runtime_error("Error: Decoding failed. A block holds fewer bytes than recorded.");
+            }
+        }
+        out.write(block.data(), static_cast<std::streamsize>(count));
+        pos += static_cast<size_t>(payloadBytes);
+    }
+    return totalBytes;
+}
+
 void HuffmanCompressor::buildTree()
 {
     std::priority_queue<HuffmanNode *, std::vector<HuffmanNode *>, Compare> pq;
 
-    for (const auto &entry : frequencyMap)
+    for (int byte = 0; byte < 256; ++byte)
     {
-        pq.push(new HuffmanNode(entry.first, entry.second));
+        if (frequencyMap[byte] != 0)
+        {
+            pq.push(new HuffmanNode(static_cast<unsigned char>(byte), frequencyMap[byte]));
+        }
     }
 
     while (pq.size() > 1)
@@ -359,55 +619,41 @@ void HuffmanCompressor::buildTree()
         HuffmanNode *right = pq.top();
         pq.pop();
 
-        int sum = left->frequency + right->frequency;
+        uint64_t sum = left->frequency + right->frequency;
         HuffmanNode *newNode = new HuffmanNode(0, sum);
         newNode->left = left;
         newNode->right = right;
         pq.push(newNode);
     }
 
-    if (!pq.empty())
+    if (pq.empty())
     {
-        root = pq.top();
-        generateCodes(root, "");
+        return;
     }
+    root = pq.top();
+
+    // Depths from the tree, capped at MAX_CODE_LENGTH so every code fits one decode-table probe
+    std::array<unsigned char, 256> lengths{};
+    generateCodeLengths(root, 0, lengths);
+    HuffmanTable::limitCodeLengths(lengths);
+    codeTable.buildFromLengths(lengths);
 }
 
-void HuffmanCompressor::generateCodes(HuffmanNode *node, const std::string &code)
+void HuffmanCompressor::generateCodeLengths(HuffmanNode *node, int depth, std::array<unsigned char, 256> &lengths)
 {
     if (!node)
         return;
 
     if (!node->left && !node->right)
     {
-        huffmanCodes[node->byte] = code;
-
-        // Determine if the byte is a printable character
-        std::string byteStr;
-        if (std::isprint(static_cast<unsigned char>(node->byte)))
-        {
-            byteStr = std::string(1, node->byte);
-        }
-        else
-        {
-            // Represent non-printable characters in hexadecimal
-            std::ostringstream oss;
-            oss << "0x"
-                << std::hex
-                << std::uppercase
-                << std::setw(2)
-                << std::setfill('0')
-                << static_cast<int>(static_cast<unsigned char>(node->byte));
-            byteStr = oss.str();
-        }
-
-        // Log the character code
-        // Logger::getInstance().log("Character '" + byteStr + "' has code: " + code);
+        // A lone symbol still needs one bit per occurrence
+        int length = depth > 0 ? depth : 1;
+        lengths[node->byte] = static_cast<unsigned char>(length > 255 ? 255 : length);
+        return;
     }
 
-    // Recursively generate codes
-    generateCodes(node->left, code + "0");
-    generateCodes(node->right, code + "1");
+    generateCodeLengths(node->left, depth + 1, lengths);
+    generateCodeLengths(node->right, depth + 1, lengths);
 }
 
 CompressionMetrics HuffmanCompressor::getMetrics() const
@@ -419,9 +665,10 @@ bool HuffmanCompressor::validateDecodedFile(const std::string &originalFilename,
 {
     try
     {
-        Logger::getInstance().log("Validating decoded file...");
+        LOG_DEBUG("Validating decoded file...");
 
         const size_t BUFFER_SIZE = 65536; // 64 KB buffer
+
         std::ifstream originalFile(originalFilename, std::ios::binary);
         std::ifstream decodedFile(decodedFilename, std::ios::binary);
 
@@ -451,7 +698,7 @@ bool HuffmanCompressor::validateDecodedFile(const std::string &originalFilename,
             //  Check if bytes read are equal
             if (originalBytesRead != decodedBytesRead)
             {
-                Logger::getInstance().log("Error: Files have different sizes.");
+                LOG_ERROR("Error: Files have different sizes.");
 
                 return false;
             }
@@ -464,7 +711,7 @@ bool HuffmanCompressor::validateDecodedFile(const std::string &originalFilename,
             // Compare the buffers
             if (std::memcmp(originalBuffer.data(), decodedBuffer.data(), static_cast<size_t>(originalBytesRead)) != 0)
             {
-                Logger::getInstance().log("Error: Files differ.");
+                LOG_ERROR("Error: Files differ.");
                 return false;
             }
         }
@@ -475,7 +722,7 @@ bool HuffmanCompressor::validateDecodedFile(const std::string &originalFilename,
     }
     catch (const std::exception &e)
     {
-        Logger::getInstance().log(std::string("Exception during validation: ") + e.what());
+        LOG_ERROR(std::string("Exception during validation: ") + e.what());
         return false;
     }
 }
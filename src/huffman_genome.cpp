@@ -1,17 +1,87 @@
 #include "HuffmanGenome.h"
 #include "Logger.h"
+#include <atomic>
+#include <cstdio>
 #include <fstream>
 #include <sstream>
 #include <cstring>
 #include <stdexcept>
-#include <bitset>
 #include <vector>
 #include "FileValidator.h"
 #include "CompressionException.h"
+#include "BitIO.h"
+#include "ThreadPool.h"
+#include "MappedFile.h"
+#include "BaseClassifier.h"
+#include "ExceptionStream.h"
+#include "CaseMask.h"
+#include <algorithm>
+
+// Archive layout (version 7):
+//   header  magic, version, entropy coder, model scope, stream count, code table, u32 block size in bases,
+//           u64 exception stream size, exception stream, u64 case mask size, case mask
+//           Huffman: one byte of 2-bit code lengths (A C G T)
+//           rANS:    four u16 normalized frequencies (A C G T)
+//   blocks  one byte-aligned stream per block of core bases. With the global model they all
+//           share the header's code table; with block models each starts with its own table,
+//           in the header's format, and the header's table covers the whole sequence.
+//           With four streams, a Huffman payload is a u32 bit length per stream followed by
+//           the streams, each byte-aligned and coding one segment of the block's bases.
+//   index   per block: u64 byte offset, u64 bit length
+//   footer  u64 index offset, u64 core bases, u32 block count
+// Blocks hold upper-case core bases; the case mask lower-cases them again on decode.
+// Blocks are independent, so both directions process a batch of them at a time on a thread pool.
+const char FORMAT_MAGIC = 'G';
+const char FORMAT_VERSION = 7;
+const char BASE_SYMBOLS[] = {'A', 'C', 'G', 'T'};
+const std::streamsize HUFFMAN_MODEL_SIZE = 1;
+const std::streamsize RANS_MODEL_SIZE = 8;
+const std::streamsize MODEL_OFFSET = 5;
+const std::streamsize HUFFMAN_HEADER_SIZE = MODEL_OFFSET + HUFFMAN_MODEL_SIZE + 4;
+const std::streamsize RANS_HEADER_SIZE = MODEL_OFFSET + RANS_MODEL_SIZE + 4;
+const size_t STREAM_TABLE_SIZE = 4 * HuffmanTable::STREAM_COUNT;
+const std::streamsize SECTION_SIZE_FIELD = 8;
+const std::streamsize FOOTER_SIZE = 20;
+const std::streamsize INDEX_ENTRY_SIZE = 16;
+
+namespace
+{
+    // Canonical code lengths are at most 3 bits for four bases, so they pack into one byte
+    unsigned char packLengths(const HuffmanTable &table)
+    {
+        unsigned char packed = 0;
+        for (int i = 0; i < HuffmanGenome::BASE_COUNT; ++i)
+        {
+            packed |= static_cast<unsigned char>(table.getLength(BASE_SYMBOLS[i]) << (6 - 2 * i));
+        }
+        return packed;
+    }
 
-const size_t BUFFER_SIZE = 65536;
+    std::array<unsigned char, HuffmanTable::ALPHABET_SIZE> unpackLengths(unsigned char packed)
+    {
+        std::array<unsigned char, HuffmanTable::ALPHABET_SIZE> lengths{};
+        for (int i = 0; i < HuffmanGenome::BASE_COUNT; ++i)
+        {
+            lengths[static_cast<unsigned char>(BASE_SYMBOLS[i])] = (packed >> (6 - 2 * i)) & 0x03;
+        }
+        return lengths;
+    }
 
-HuffmanGenome::HuffmanGenome() : root(nullptr)
+    std::array<uint16_t, RansTable::ALPHABET_SIZE> readBaseFrequencies(const unsigned char *model)
+    {
+        std::array<uint16_t, RansTable::ALPHABET_SIZE> frequencies{};
+        for (int i = 0; i < HuffmanGenome::BASE_COUNT; ++i)
+        {
+            frequencies[static_cast<unsigned char>(BASE_SYMBOLS[i])] = static_cast<uint16_t>(BitIO::readUInt(model + 2 * i, 2));
+        }
+        return frequencies;
+    }
+}
+
+HuffmanGenome::HuffmanGenome()
+    : root(nullptr), entropyCoder(EntropyCoder::Huffman), modelScope(ModelScope::Global), streamCount(1),
+      threadCount(ThreadPool::defaultThreadCount()),
+      blockSize(DEFAULT_BLOCK_SIZE), memoryLimit(0)
 {
     frequencyMap.fill(0);
 }
@@ -21,6 +91,44 @@ HuffmanGenome::~HuffmanGenome()
     deleteTree(root);
 }
 
+void HuffmanGenome::setThreadCount(unsigned int threads)
+{
+    threadCount = threads == 0 ? ThreadPool::defaultThreadCount() : threads;
+}
+
+void HuffmanGenome::setBlockSize(size_t bases)
+{
+    if (bases == 0 || bases > UINT32_MAX)
+    {
+        throw std::invalid_argument("Block size must be between 1 and 4294967295 bases.");
+    }
+    blockSize = bases;
+}
+
+void HuffmanGenome::setEntropyCoder(EntropyCoder coder)
+{
+    entropyCoder = coder;
+}
+
+void HuffmanGenome::setModelScope(ModelScope scope)
+{
+    modelScope = scope;
+}
+
+void HuffmanGenome::setStreamCount(unsigned int streams)
+{
+    if (streams != 1 && streams != HuffmanTable::STREAM_COUNT)
+    {
+        throw std::invalid_argument("Stream count must be 1 or " + std::to_string(HuffmanTable::STREAM_COUNT) + ".");
+    }
+    streamCount = streams;
+}
+
+void HuffmanGenome::setMemoryLimit(size_t bytes)
+{
+    memoryLimit = bytes;
+}
+
 void HuffmanGenome::deleteTree(HuffmanGenomeNode *node)
 {
     if (!node)
@@ -40,32 +148,50 @@ size_t HuffmanGenome::getFileSize(const std::string &filename)
     return static_cast<size_t>(infile.tellg());
 }
 
-bool HuffmanGenome::validateInputFile(const std::string &inputFilename) const
+bool HuffmanGenome::validateInputPath(const std::string &inputFilename) const
 {
     if (!FileValidator::hasTxtExtension(inputFilename))
     {
-        Logger::getInstance().log("Validation Error: File '" + inputFilename + "' does not have a .txt extension.");
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' does not have a .txt extension.");
         std::cerr << "Error: Unsupported file format. Only .txt files are allowed.\n";
         return false;
     }
 
     if (!FileValidator::fileExists(inputFilename))
     {
-        Logger::getInstance().log("Validation Error: File '" + inputFilename + "' does not exist.");
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' does not exist.");
         std::cerr << "Error: File does not exist.\n";
         return false;
     }
 
-    if (!FileValidator::hasValidGenomeData(inputFilename))
+    return true;
+}
+
+bool HuffmanGenome::validateInputFile(const std::string &inputFilename) const
+{
+    if (!validateInputPath(inputFilename))
     {
-        Logger::getInstance().log("Validation Error: File '" + inputFilename + "' contains invalid characters.");
-        std::cerr << "Error: File contains invalid characters. Only A, C, G, T are allowed.\n";
+        return false;
+    }
+
+    if (!FileValidator::hasValidSequenceData(inputFilename))
+    {
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' contains invalid characters.");
+        std::cerr << "Error: File contains invalid characters. Only A, C, G, T, N and IUPAC ambiguity codes are allowed.\n";
         return false;
     }
 
     return true;
 }
 
+void HuffmanGenome::reportInvalidBase(const std::string &inputFilename, size_t offset, char ch) const
+{
+    LOG_WARNING("Validation Error: File '" + inputFilename + "' has an invalid character at offset " +
+                              std::to_string(offset) + ".");
+    std::cerr << "Error: Invalid character '" << ch << "' at offset " << offset
+              << " in input file. Only A, C, G, T, N and IUPAC ambiguity codes are allowed.\n";
+}
+
 int HuffmanGenome::charToIndex(char ch) const
 {
     switch (ch)
@@ -95,105 +221,324 @@ void HuffmanGenome::encodeFromFile(const std::string &inputFilename, const std::
 {
     try
     {
-        Logger::getInstance().log("Starting Huffman encoding...");
+        LOG_INFO("Starting Huffman encoding...");
 
-        if (!validateInputFile(inputFilename))
+        CompressionMetrics::PhaseTimer timer;
+        if (!validateInputPath(inputFilename))
         {
-            Logger::getInstance().log("Encoding aborted due to input file validation failure.");
+            LOG_WARNING("Encoding aborted due to input file validation failure.");
             return;
         }
+        const double validationSeconds = timer.seconds();
 
-        deleteTree(root);
-        root = nullptr;
-        frequencyMap.fill(0);
-        huffmanCodes.fill("");
-        encodedSequence.clear();
-        metrics = CompressionMetrics(); // Reset metrics
+        MappedFile input(inputFilename);
+        std::ofstream outfile(outputFilename, std::ios::binary);
+        if (!outfile)
+        {
+            throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
+        }
+        if (!encodeSequence(input.data(), input.size(), outfile, inputFilename))
+        {
+            // Leave no partial archive behind
+            outfile.close();
+            std::remove(outputFilename.c_str());
+            LOG_WARNING("Encoding aborted due to input file validation failure.");
+            return;
+        }
 
-        std::ifstream infile(inputFilename, std::ios::binary); // open in binary
-        if (!infile)
+        // encodeSequence starts the metrics afresh, so the path checks are added afterwards
+        metrics.addPhase(CompressionMetrics::Phase::Validation, validationSeconds, 0);
+        timer.restart();
+        outfile.close();
+        if (!outfile)
         {
-            throw std::runtime_error("Error: Unable to open input file '" + inputFilename + "'.");
+            throw std::runtime_error("Error: Failed to write output file '" + outputFilename + "'.");
         }
+        // The archive bytes were counted as encodeSequence wrote them
+        metrics.addPhase(CompressionMetrics::Phase::Io, timer.seconds(), 0);
 
-        char buffer[BUFFER_SIZE];
-        while (infile.read(buffer, sizeof(buffer)) || infile.gcount())
+        LOG_INFO("Huffman Genome encoding completed.");
+        std::cout << "Compression successful. Output file: " << outputFilename << "\n";
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR(std::string("Exception during Huffman Genome encoding: ") + e.what());
+        // Leave no partial output behind, and let the caller see the failure
+        if (inputFilename != outputFilename)
         {
-            std::streamsize bytesRead = infile.gcount();
+            std::remove(outputFilename.c_str());
+        }
+        throw CompressionException(e.what());
+    }
+}
 
-            for (std::streamsize i = 0; i < bytesRead; ++i)
+bool HuffmanGenome::encodeSequence(const char *data, size_t count, std::ostream &out, const std::string &sourceName)
+{
+    deleteTree(root);
+    root = nullptr;
+    frequencyMap.fill(0);
+    codeTable.clear();
+    encodedSequence.clear();
+    metrics = CompressionMetrics(); // Reset metrics
+    const size_t inputBytes = count;
+    CompressionMetrics::PhaseTimer timer;
+
+    ThreadPool pool(threadCount);
+
+    // First pass: each block validates and counts into its own histogram in one sweep.
+    // Both passes read blocks straight out of the caller's buffer unless it holds N or
+    // other ambiguity codes; those move to the exception stream and the remaining core
+    // bases are copied out and counted again. With block models there is no second pass:
+    // a valid block is encoded with its own code as soon as it is counted, while it is
+    // still in cache.
+    const bool useRans = entropyCoder == EntropyCoder::Rans;
+    const bool blockModels = modelScope == ModelScope::Block;
+    ExceptionStream exceptions;
+    std::string core;
+    std::vector<std::array<uint64_t, BASE_COUNT>> blockCounts;
+    std::vector<std::vector<uint64_t>> blockToggles;
+    std::vector<std::vector<unsigned char>> modelledBlocks;
+    std::vector<uint64_t> modelledBits;
+    for (;;)
+    {
+        // The same sweep notes where the case changes, for the case mask
+        const size_t blockCount = static_cast<size_t>((count + blockSize - 1) / blockSize);
+        blockCounts.assign(blockCount, std::array<uint64_t, BASE_COUNT>{});
+        blockToggles.assign(blockCount, std::vector<uint64_t>());
+        modelledBlocks.assign(blockModels ? blockCount : 0, std::vector<unsigned char>());
+        modelledBits.assign(blockModels ? blockCount : 0, 0);
+        std::vector<size_t> validBases(blockCount);
+        std::atomic<bool> sawInvalid(false);
+        pool.parallelFor(blockCount, [&](size_t b)
+        {
+            size_t begin = b * blockSize;
+            size_t length = static_cast<size_t>(std::min<uint64_t>(blockSize, count - begin));
+            validBases[b] = BaseClassifier::countBases(data + begin, length, blockCounts[b].data(), blockToggles[b]);
+            if (validBases[b] != length)
             {
-                // Directly map character to index and update frequency
-                int index = charToIndex(buffer[i]);
-                frequencyMap[index]++;
+                sawInvalid.store(true, std::memory_order_relaxed);
             }
-        }
-
-        infile.clear();
-        infile.seekg(0, std::ios::beg); // Rewind file
-
-        // Build Huffman tree
-        buildTree();
-
-        std::string freqFilename = outputFilename + ".freq";
-        saveFrequencyMap(freqFilename);
-        Logger::getInstance().log("Frequency map saved to '" + freqFilename + "'.");
+            // Once a block is known to be invalid, everything is counted again over the core bases
+            else if (blockModels && !sawInvalid.load(std::memory_order_relaxed))
+            {
+                encodeBlockModel(data + begin, length, blockCounts[b], modelledBlocks[b], modelledBits[b]);
+            }
+        });
 
-        std::ofstream outfile(outputFilename, std::ios::binary);
-        if (!outfile)
+        size_t b = 0;
+        while (b < blockCount && validBases[b] == static_cast<size_t>(std::min<uint64_t>(blockSize, count - b * blockSize)))
         {
-            infile.close();
-            throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
+            ++b;
         }
-
-        std::string bitBuffer;
-        while (infile.read(buffer, sizeof(buffer)) || infile.gcount())
+        if (b == blockCount)
         {
-            std::streamsize bytesRead = infile.gcount();
+            break;
+        }
 
-            for (std::streamsize i = 0; i < bytesRead; ++i)
+        // Blocks are checked in order, so the split starts at the first non-base byte
+        size_t firstInvalid = b * blockSize + validBases[b];
+        core.reserve(count);
+        core.assign(data, firstInvalid);
+        size_t splitBases = exceptions.split(data + firstInvalid, count - firstInvalid, firstInvalid, core);
+        if (splitBases != count - firstInvalid)
+        {
+            reportInvalidBase(sourceName, firstInvalid + splitBases, data[firstInvalid + splitBases]);
+            return false;
+        }
+        data = core.data();
+        count = core.size();
+    }
+    CaseMask caseMask;
+    for (size_t b = 0; b < blockCounts.size(); ++b)
+    {
+        for (int i = 0; i < BASE_COUNT; ++i)
+        {
+            frequencyMap[i] += blockCounts[b][i];
+        }
+        caseMask.addToggles(blockToggles[b], static_cast<uint64_t>(b) * blockSize);
+    }
+    const uint64_t totalBases = count;
+    const size_t blockCount = blockCounts.size();
+    std::vector<unsigned char> exceptionBytes;
+    exceptions.serialize(exceptionBytes);
+    std::vector<unsigned char> caseMaskBytes;
+    caseMask.serialize(caseMaskBytes);
+    metrics.addPhase(blockModels ? CompressionMetrics::Phase::Encoding : CompressionMetrics::Phase::Counting,
+                     timer.seconds(), inputBytes);
+
+    // Build Huffman tree
+    timer.restart();
+    buildTree();
+
+    out.put(FORMAT_MAGIC);
+    out.put(FORMAT_VERSION);
+    out.put(static_cast<char>(entropyCoder));
+    out.put(static_cast<char>(modelScope));
+    out.put(static_cast<char>(useRans ? 1 : streamCount));
+    if (useRans)
+    {
+        std::array<uint64_t, RansTable::ALPHABET_SIZE> counts{};
+        for (int i = 0; i < BASE_COUNT; ++i)
+        {
+            counts[static_cast<unsigned char>(BASE_SYMBOLS[i])] = frequencyMap[i];
+        }
+        ransTable.buildFromCounts(counts);
+        for (int i = 0; i < BASE_COUNT; ++i)
+        {
+            ransTable.addAlias(static_cast<unsigned char>(BASE_SYMBOLS[i] | 0x20), static_cast<unsigned char>(BASE_SYMBOLS[i]));
+            BitIO::writeUInt(out, ransTable.getFrequency(BASE_SYMBOLS[i]), 2);
+        }
+    }
+    else
+    {
+        out.put(static_cast<char>(packLengths(codeTable)));
+    }
+    metrics.addPhase(CompressionMetrics::Phase::ModelBuild, timer.seconds(), 0);
+    BitIO::writeUInt(out, blockSize, 4);
+    BitIO::writeUInt(out, exceptionBytes.size(), 8);
+    out.write(reinterpret_cast<const char *>(exceptionBytes.data()), static_cast<std::streamsize>(exceptionBytes.size()));
+    BitIO::writeUInt(out, caseMaskBytes.size(), 8);
+    out.write(reinterpret_cast<const char *>(caseMaskBytes.data()), static_cast<std::streamsize>(caseMaskBytes.size()));
+
+    std::vector<BlockEntry> blockIndex;
+    blockIndex.reserve(blockCount);
+    uint64_t offset = static_cast<uint64_t>(useRans ? RANS_HEADER_SIZE : HUFFMAN_HEADER_SIZE) + 2 * SECTION_SIZE_FIELD +
+                      exceptionBytes.size() + caseMaskBytes.size();
+    if (blockModels)
+    {
+        // Every block was encoded in the first pass
+        timer.restart();
+        for (size_t b = 0; b < blockCount; ++b)
+        {
+            out.write(reinterpret_cast<const char *>(modelledBlocks[b].data()),
+                      static_cast<std::streamsize>(modelledBlocks[b].size()));
+            blockIndex.push_back({offset, modelledBits[b]});
+            offset += modelledBlocks[b].size();
+            std::vector<unsigned char>().swap(modelledBlocks[b]);
+        }
+        metrics.addPhase(CompressionMetrics::Phase::Io, timer.seconds(), 0);
+    }
+    else
+    {
+        // Input is already validated, so the encoder maps bytes to codes with plain lookups
+        const BaseCode code(codeTable);
+
+        // Second pass: a batch of blocks is encoded in parallel, then written in order
+        const size_t batchBlocks = pool.size();
+        std::vector<std::vector<unsigned char>> encodedBlocks(batchBlocks);
+        std::vector<uint64_t> blockBits(batchBlocks);
+        for (size_t first = 0; first < blockCount; first += batchBlocks)
+        {
+            size_t blocksInBatch = std::min(batchBlocks, blockCount - first);
+            timer.restart();
+            pool.parallelFor(blocksInBatch, [&](size_t b)
             {
-                char ch = buffer[i];
-                int index = charToIndex(ch);
-                bitBuffer += huffmanCodes[index];
-
-                while (bitBuffer.size() >= 8)
+                encodedBlocks[b].clear();
+                size_t begin = (first + b) * blockSize;
+                size_t end = static_cast<size_t>(std::min<uint64_t>(begin + static_cast<uint64_t>(blockSize), totalBases));
+                if (useRans)
                 {
-                    std::bitset<8> byteBits(bitBuffer.substr(0, 8));
-                    unsigned char byte = static_cast<unsigned char>(byteBits.to_ulong());
-                    outfile.put(byte);
-                    bitBuffer.erase(0, 8);
+                    ransTable.encode(reinterpret_cast<const unsigned char *>(data) + begin, end - begin, encodedBlocks[b]);
+                    blockBits[b] = static_cast<uint64_t>(encodedBlocks[b].size()) * 8;
+                    return;
                 }
+                blockBits[b] = encodePayload(code, data + begin, end - begin, encodedBlocks[b]);
+            });
+            uint64_t batchBases = std::min<uint64_t>(static_cast<uint64_t>(blocksInBatch) * blockSize,
+                                                     totalBases - static_cast<uint64_t>(first) * blockSize);
+            metrics.addPhase(CompressionMetrics::Phase::Encoding, timer.seconds(), batchBases);
+
+            timer.restart();
+            for (size_t b = 0; b < blocksInBatch; ++b)
+            {
+                out.write(reinterpret_cast<const char *>(encodedBlocks[b].data()),
+                              static_cast<std::streamsize>(encodedBlocks[b].size()));
+                blockIndex.push_back({offset, blockBits[b]});
+                offset += encodedBlocks[b].size();
             }
+            metrics.addPhase(CompressionMetrics::Phase::Io, timer.seconds(), 0);
         }
+    }
 
-        int paddingBits = 0;
-        if (!bitBuffer.empty())
-        {
-            paddingBits = 8 - static_cast<int>(bitBuffer.size());
-            bitBuffer.append(paddingBits, '0'); // Pad with zeros
-            std::bitset<8> byteBits(bitBuffer);
-            unsigned char byte = static_cast<unsigned char>(byteBits.to_ulong());
-            outfile.put(byte);
-        }
+    timer.restart();
+    for (const BlockEntry &entry : blockIndex)
+    {
+        BitIO::writeUInt(out, entry.offset, 8);
+        BitIO::writeUInt(out, entry.bitLength, 8);
+    }
+    BitIO::writeUInt(out, offset, 8);
+    BitIO::writeUInt(out, totalBases, 8);
+    BitIO::writeUInt(out, blockIndex.size(), 4);
+    uint64_t archiveBytes = offset + blockIndex.size() * INDEX_ENTRY_SIZE + FOOTER_SIZE;
+    metrics.addPhase(CompressionMetrics::Phase::Io, timer.seconds(), archiveBytes);
 
-        Logger::getInstance().log("Padding bits added during encoding: " + std::to_string(paddingBits));
+    LOG_DEBUG("Encoded " + std::to_string(blockIndex.size()) + " blocks on " +
+                              std::to_string(pool.size()) + " threads.");
 
-        outfile.put(static_cast<char>(paddingBits));
+    metrics.calculateOriginalSize(static_cast<long long>(exceptions.sequenceLength(totalBases) * 8));
+    metrics.calculateCompressedSize(static_cast<long long>(archiveBytes * 8));
+    return true;
+}
 
-        infile.close();
-        outfile.close();
+void HuffmanGenome::encodeBlockModel(const char *bases, size_t count, const std::array<uint64_t, BASE_COUNT> &counts,
+                                     std::vector<unsigned char> &out, uint64_t &payloadBits) const
+{
+    std::array<uint64_t, HuffmanTable::ALPHABET_SIZE> symbolCounts{};
+    for (int i = 0; i < BASE_COUNT; ++i)
+    {
+        symbolCounts[static_cast<unsigned char>(BASE_SYMBOLS[i])] = counts[i];
+    }
 
-        metrics.calculateOriginalSize(frequencyMap);
-        metrics.calculateCompressedSizeFromFile(outputFilename, paddingBits);
+    if (entropyCoder == EntropyCoder::Rans)
+    {
+        RansTable table;
+        table.buildFromCounts(symbolCounts);
+        for (int i = 0; i < BASE_COUNT; ++i)
+        {
+            table.addAlias(static_cast<unsigned char>(BASE_SYMBOLS[i] | 0x20), static_cast<unsigned char>(BASE_SYMBOLS[i]));
+            uint32_t frequency = table.getFrequency(BASE_SYMBOLS[i]);
+            out.push_back(static_cast<unsigned char>(frequency & 0xFF));
+            out.push_back(static_cast<unsigned char>(frequency >> 8));
+        }
+        table.encode(reinterpret_cast<const unsigned char *>(bases), count, out);
+        payloadBits = static_cast<uint64_t>(out.size() - RANS_MODEL_SIZE) * 8;
+        return;
+    }
 
-        Logger::getInstance().log("Huffman Genome encoding completed.");
-        std::cout << "Compression successful. Output file: " << outputFilename << "\n";
+    HuffmanTable table;
+    table.buildFromCounts(symbolCounts);
+    out.push_back(packLengths(table));
+    payloadBits = encodePayload(BaseCode(table), bases, count, out);
+}
+
+uint64_t HuffmanGenome::encodePayload(const BaseCode &code, const char *bases, size_t count,
+                                      std::vector<unsigned char> &out) const
+{
+    if (streamCount == 1)
+    {
+        BitWriter writer(out);
+        code.encode(bases, count, writer);
+        uint64_t bits = writer.bitsWritten();
+        writer.finish();
+        return bits;
     }
-    catch (const std::exception &e)
+
+    // The stream table goes first and is filled in as each stream is finished
+    const size_t start = out.size();
+    out.resize(start + STREAM_TABLE_SIZE);
+    for (int s = 0; s < HuffmanTable::STREAM_COUNT; ++s)
     {
-        Logger::getInstance().log(std::string("Exception during Huffman Genome encoding: ") + e.what());
+        size_t begin = HuffmanTable::streamOffset(count, s);
+        BitWriter writer(out);
+        code.encode(bases + begin, HuffmanTable::streamOffset(count, s + 1) - begin, writer);
+        uint64_t bits = writer.bitsWritten();
+        writer.finish();
+        for (int i = 0; i < 4; ++i)
+        {
+            out[start + 4 * s + i] = static_cast<unsigned char>(bits >> (8 * i));
+        }
     }
+    return static_cast<uint64_t>(out.size() - start) * 8;
 }
 
 void HuffmanGenome::decodeFromFile(const std::string &inputFilename, const std::string &outputFilename)
@@ -205,111 +550,350 @@ void HuffmanGenome::decodeFromFile(const std::string &inputFilename, const std::
             throw std::runtime_error("Error: Output file must be different from input file to prevent overwriting.");
         }
 
-        Logger::getInstance().log("Starting Huffman decoding...");
+        LOG_INFO("Starting Huffman decoding...");
 
-        std::string freqFilename = inputFilename + ".freq";
-        if (!FileValidator::fileExists(freqFilename))
+        MappedFile archive(inputFilename, MappedFile::Access::Random);
+        std::ofstream outfile(outputFilename, std::ios::binary);
+        if (!outfile)
         {
-            throw std::runtime_error("Error: Frequency map file '" + freqFilename + "' does not exist.");
+            throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
         }
-        loadFrequencyMap(freqFilename);
-        Logger::getInstance().log("Frequency map loaded from '" + freqFilename + "'.");
 
-        if (!root)
-        {
-            throw std::runtime_error("Error: Huffman tree not built. Load frequency map or encode data first.");
-        }
+        decodeArchive(archive.bytes(), archive.size(), outfile, inputFilename, &archive);
 
-        // Open the input file in binary mode
-        std::ifstream infile(inputFilename, std::ios::binary | std::ios::ate);
-        if (!infile)
+        outfile.close();
+
+        LOG_INFO("Huffman decoding completed.");
+        std::cout << "Decoding successful. Output file: " << outputFilename << "\n";
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR(std::string("Exception during Huffman decoding: ") + e.what());
+        // Leave no partial output behind, and let the caller see the failure
+        if (inputFilename != outputFilename)
         {
-            throw std::runtime_error("Error: Unable to open input file '" + inputFilename + "'.");
+            std::remove(outputFilename.c_str());
         }
+        throw CompressionException(e.what());
+    }
+}
 
-        std::streamsize fileSize = infile.tellg();
-        if (fileSize < 1)
+void HuffmanGenome::decodeSequence(const unsigned char *archive, size_t size, std::ostream &out)
+{
+    decodeArchive(archive, size, out, "embedded sequence", nullptr);
+}
+
+void HuffmanGenome::decodeArchive(const unsigned char *bytes, uint64_t size, std::ostream &out, const std::string &archiveName,
+                                  const MappedFile *mapping)
+{
+    CompressionMetrics::PhaseTimer timer;
+    const ArchiveLayout layout = readArchiveLayout(bytes, size, archiveName);
+
+    std::vector<BlockEntry> blockIndex(static_cast<size_t>(layout.blockCount));
+    for (size_t i = 0; i < blockIndex.size(); ++i)
+    {
+        blockIndex[i] = readBlockEntry(bytes, layout, i, archiveName);
+    }
+    LOG_DEBUG("Total bases to decode: " + std::to_string(layout.sequenceBases) + " in " +
+                              std::to_string(layout.blockCount) + " blocks.");
+
+    // Runs of N and other ambiguity codes are written between the core bases of the blocks
+    ExceptionStream::Writer writer(layout.exceptions, out);
+
+    // Memory in use is the batch of decoded blocks and the archive pages behind it, whatever
+    // the size of the archive. Buffers are sized for the largest block actually present, so
+    // a short sequence does not pay for the nominal block size. The limit counts decoded
+    // bases only; the few bytes of decoder slack per block come on top.
+    const uint64_t largestBlock = std::min(layout.blockSize, layout.totalBases);
+    const size_t blockCapacity = static_cast<size_t>(largestBlock) + HuffmanTable::DECODE_SLACK;
+    size_t batchBlocks = std::max<size_t>(1, std::min<size_t>(threadCount, blockIndex.size()));
+    if (memoryLimit > 0 && largestBlock > 0)
+    {
+        if (largestBlock > memoryLimit)
         {
-            throw std::runtime_error("Error: Encoded file is too small.");
+            throw std::runtime_error("Error: A memory limit of " + std::to_string(memoryLimit) +
+                                     " bytes cannot hold one block of " + std::to_string(largestBlock) +
+                                     " bases from '" + archiveName + "'.");
         }
+        batchBlocks = std::min<size_t>(batchBlocks, memoryLimit / static_cast<size_t>(largestBlock));
+    }
+    ThreadPool pool(static_cast<unsigned int>(batchBlocks));
+    std::vector<char> decoded(batchBlocks * blockCapacity);
 
-        infile.seekg(fileSize - 1, std::ios::beg);
-        char paddingBitsChar;
-        infile.get(paddingBitsChar);
-        int paddingBits = static_cast<unsigned char>(paddingBitsChar);
-        Logger::getInstance().log("Padding bits read during decoding: " + std::to_string(paddingBits));
+    for (size_t first = 0; first < blockIndex.size(); first += batchBlocks)
+    {
+        size_t blocksInBatch = std::min(batchBlocks, blockIndex.size() - first);
+        pool.parallelFor(blocksInBatch, [&](size_t b)
+        {
+            decodeBlock(bytes, layout, blockIndex[first + b], first + b, decoded.data() + b * blockCapacity);
+        });
 
-        if (paddingBits < 0 || paddingBits > 7)
+        for (size_t b = 0; b < blocksInBatch; ++b)
+        {
+            writer.write(decoded.data() + b * blockCapacity, static_cast<size_t>(blockBases(layout, first + b)));
+        }
+        if (mapping)
         {
-            throw std::runtime_error("Error: Invalid padding bits value in encoded file.");
+            uint64_t end = first + blocksInBatch < blockIndex.size() ? blockIndex[first + blocksInBatch].offset : layout.indexOffset;
+            mapping->release(static_cast<size_t>(blockIndex[first].offset), static_cast<size_t>(end - blockIndex[first].offset));
         }
+    }
+    writer.finish();
 
-        std::streamsize dataSize = fileSize - 1;
-        infile.seekg(0, std::ios::beg);
+    // Decoding leaves the sizes of the last encode alone; only its own phase is replaced
+    metrics.clearPhase(CompressionMetrics::Phase::Decoding);
+    metrics.addPhase(CompressionMetrics::Phase::Decoding, timer.seconds(), layout.sequenceBases);
+}
 
-        std::vector<char> buffer(dataSize);
-        infile.read(buffer.data(), dataSize);
-        infile.close();
+std::string HuffmanGenome::decodeRange(const std::string &archiveFilename, uint64_t start, uint64_t length)
+{
+    MappedFile archive(archiveFilename, MappedFile::Access::Random);
+    return decodeArchiveRange(archive.bytes(), archive.size(), start, length, archiveFilename);
+}
 
-        std::string bitString;
-        for (std::streamsize i = 0; i < dataSize; ++i)
-        {
-            std::bitset<8> bits(static_cast<unsigned char>(buffer[i]));
-            bitString += bits.to_string();
-        }
+std::string HuffmanGenome::decodeSequenceRange(const unsigned char *archive, size_t size, uint64_t start, uint64_t length)
+{
+    return decodeArchiveRange(archive, size, start, length, "embedded sequence");
+}
 
-        if (paddingBits > 0)
+std::string HuffmanGenome::decodeArchiveRange(const unsigned char *bytes, uint64_t size, uint64_t start, uint64_t length,
+                                              const std::string &archiveFilename)
+{
+    const ArchiveLayout layout = readArchiveLayout(bytes, size, archiveFilename);
+    if (start > layout.sequenceBases)
+    {
+        throw std::out_of_range("Error: Range starts at base " + std::to_string(start) + " but '" + archiveFilename +
+                                "' holds only " + std::to_string(layout.sequenceBases) + " bases.");
+    }
+    length = std::min(length, layout.sequenceBases - start);
+    if (layout.exceptions.empty())
+    {
+        return decodeCoreRange(bytes, layout, start, length, archiveFilename);
+    }
+
+    // Decode the core bases under the range, then put the exception runs back in
+    uint64_t coreStart = layout.exceptions.corePosition(start);
+    uint64_t coreEnd = layout.exceptions.corePosition(start + length);
+    std::string core = decodeCoreRange(bytes, layout, coreStart, coreEnd - coreStart, archiveFilename);
+    std::string range(static_cast<size_t>(length), '\0');
+    layout.exceptions.merge(core.data(), start, length, &range[0]);
+    return range;
+}
+
+std::string HuffmanGenome::decodeCoreRange(const unsigned char *bytes, const ArchiveLayout &layout, uint64_t start,
+                                           uint64_t length, const std::string &archiveFilename) const
+{
+    std::string range;
+    if (length == 0)
+    {
+        return range;
+    }
+    range.resize(static_cast<size_t>(length));
+
+    // Blocks are a fixed number of bases, so the covering blocks follow from the range alone
+    const uint64_t firstBlock = start / layout.blockSize;
+    const uint64_t lastBlock = (start + length - 1) / layout.blockSize;
+    const size_t blockCount = static_cast<size_t>(lastBlock - firstBlock + 1);
+    const size_t blockCapacity = static_cast<size_t>(std::min(layout.blockSize, layout.totalBases)) + HuffmanTable::DECODE_SLACK;
+
+    auto decodeOne = [&](size_t b, std::vector<char> &buffer)
+    {
+        uint64_t block = firstBlock + b;
+        uint64_t blockStart = block * layout.blockSize;
+        uint64_t from = std::max(start, blockStart);
+        uint64_t to = std::min(start + length, blockStart + blockBases(layout, block));
+
+        buffer.resize(blockCapacity);
+        decodeBlock(bytes, layout, readBlockEntry(bytes, layout, block, archiveFilename), block, buffer.data());
+        std::memcpy(&range[static_cast<size_t>(from - start)], buffer.data() + (from - blockStart),
+                    static_cast<size_t>(to - from));
+    };
+
+    // Small reads touch one or two blocks; only wider ones are worth a pool
+    if (blockCount == 1 || threadCount == 1)
+    {
+        std::vector<char> buffer;
+        for (size_t b = 0; b < blockCount; ++b)
         {
-            bitString.erase(bitString.end() - paddingBits, bitString.end());
+            decodeOne(b, buffer);
         }
+        return range;
+    }
+    ThreadPool pool(static_cast<unsigned int>(std::min<size_t>(threadCount, blockCount)));
+    std::vector<std::vector<char>> buffers(blockCount);
+    pool.parallelFor(blockCount, [&](size_t b)
+    {
+        decodeOne(b, buffers[b]);
+        std::vector<char>().swap(buffers[b]);
+    });
+    return range;
+}
 
-        Logger::getInstance().log("Total bits to process: " + std::to_string(bitString.size()));
+HuffmanGenome::ArchiveLayout HuffmanGenome::readArchiveLayout(const unsigned char *bytes, uint64_t fileSize,
+                                                              const std::string &inputFilename)
+{
+    if (fileSize < static_cast<uint64_t>(HUFFMAN_HEADER_SIZE + 2 * SECTION_SIZE_FIELD + FOOTER_SIZE))
+    {
+        throw std::runtime_error("Error: Encoded file is too small.");
+    }
 
-        std::ofstream outfile(outputFilename, std::ios::binary);
-        if (!outfile)
+    // Rebuild the code table straight from the stored lengths or frequencies
+    if (bytes[0] != FORMAT_MAGIC || bytes[1] != FORMAT_VERSION)
+    {
+        throw std::runtime_error("Error: '" + inputFilename + "' is not a Huffman Genome archive.");
+    }
+    ArchiveLayout layout;
+    layout.useRans = bytes[2] == static_cast<unsigned char>(EntropyCoder::Rans);
+    if (!layout.useRans && bytes[2] != static_cast<unsigned char>(EntropyCoder::Huffman))
+    {
+        throw std::runtime_error("Error: Unknown entropy coder in '" + inputFilename + "'.");
+    }
+    layout.blockModels = bytes[3] == static_cast<unsigned char>(ModelScope::Block);
+    if (!layout.blockModels && bytes[3] != static_cast<unsigned char>(ModelScope::Global))
+    {
+        throw std::runtime_error("Error: Unknown model scope in '" + inputFilename + "'.");
+    }
+    layout.splitStreams = bytes[4] == HuffmanTable::STREAM_COUNT;
+    if (!layout.splitStreams && bytes[4] != 1)
+    {
+        throw std::runtime_error("Error: Unknown stream count in '" + inputFilename + "'.");
+    }
+    const uint64_t tableSize = static_cast<uint64_t>(layout.useRans ? RANS_HEADER_SIZE : HUFFMAN_HEADER_SIZE);
+    if (fileSize < tableSize + 2 * SECTION_SIZE_FIELD + FOOTER_SIZE)
+    {
+        throw std::runtime_error("Error: Encoded file is too small.");
+    }
+    const uint64_t exceptionSize = BitIO::readUInt(bytes + tableSize, 8);
+    if (exceptionSize > fileSize - tableSize - 2 * SECTION_SIZE_FIELD - FOOTER_SIZE)
+    {
+        throw std::runtime_error("Error: Corrupt exception stream in '" + inputFilename + "'.");
+    }
+    layout.exceptions = ExceptionStream::parse(bytes + tableSize + SECTION_SIZE_FIELD, static_cast<size_t>(exceptionSize));
+    const uint64_t caseMaskOffset = tableSize + SECTION_SIZE_FIELD + exceptionSize;
+    const uint64_t caseMaskSize = BitIO::readUInt(bytes + caseMaskOffset, 8);
+    if (caseMaskSize > fileSize - caseMaskOffset - SECTION_SIZE_FIELD - FOOTER_SIZE)
+    {
+        throw std::runtime_error("Error: Corrupt case mask in '" + inputFilename + "'.");
+    }
+    const uint64_t headerSize = caseMaskOffset + SECTION_SIZE_FIELD + caseMaskSize;
+    if (layout.useRans)
+    {
+        ransTable.buildFromFrequencies(readBaseFrequencies(bytes + MODEL_OFFSET));
+    }
+    else
+    {
+        codeTable.buildFromLengths(unpackLengths(bytes[MODEL_OFFSET]));
+        layout.code = BaseCode(codeTable);
+    }
+    layout.blockSize = BitIO::readUInt(bytes + tableSize - 4, 4);
+
+    const unsigned char *footer = bytes + fileSize - FOOTER_SIZE;
+    layout.indexOffset = BitIO::readUInt(footer, 8);
+    layout.totalBases = BitIO::readUInt(footer + 8, 8);
+    layout.blockCount = BitIO::readUInt(footer + 16, 4);
+
+    if (layout.blockSize == 0 ||
+        layout.blockCount != (layout.totalBases + layout.blockSize - 1) / layout.blockSize ||
+        layout.indexOffset < headerSize ||
+        layout.indexOffset + layout.blockCount * INDEX_ENTRY_SIZE + FOOTER_SIZE != fileSize)
+    {
+        throw std::runtime_error("Error: Corrupt block index in '" + inputFilename + "'.");
+    }
+    layout.sequenceBases = layout.exceptions.sequenceLength(layout.totalBases);
+    layout.caseMask = CaseMask::parse(bytes + caseMaskOffset + SECTION_SIZE_FIELD, static_cast<size_t>(caseMaskSize),
+                                      layout.totalBases);
+    return layout;
+}
+
+HuffmanGenome::BlockEntry HuffmanGenome::readBlockEntry(const unsigned char *bytes, const ArchiveLayout &layout,
+                                                        uint64_t block, const std::string &inputFilename) const
+{
+    const unsigned char *row = bytes + layout.indexOffset + block * INDEX_ENTRY_SIZE;
+    BlockEntry entry;
+    entry.offset = BitIO::readUInt(row, 8);
+    entry.bitLength = BitIO::readUInt(row + 8, 8);
+
+    // A block ends where the next one starts, so its row is checked against its successor
+    uint64_t next = block + 1 < layout.blockCount ? BitIO::readUInt(row + INDEX_ENTRY_SIZE, 8) : layout.indexOffset;
+    const uint64_t modelSize = layout.blockModels ? static_cast<uint64_t>(layout.useRans ? RANS_MODEL_SIZE : HUFFMAN_MODEL_SIZE) : 0;
+    if (entry.offset > next || next > layout.indexOffset || modelSize + (entry.bitLength + 7) / 8 != next - entry.offset)
+    {
+        throw std::runtime_error("Error: Corrupt block index in '" + inputFilename + "'.");
+    }
+    return entry;
+}
+
+uint64_t HuffmanGenome::blockBases(const ArchiveLayout &layout, uint64_t block) const
+{
+    return std::min<uint64_t>(layout.blockSize, layout.totalBases - block * layout.blockSize);
+}
+
+void HuffmanGenome::decodeBlock(const unsigned char *bytes, const ArchiveLayout &layout, const BlockEntry &entry,
+                                uint64_t block, char *output) const
+{
+    size_t count = static_cast<size_t>(blockBases(layout, block));
+    const unsigned char *payload = bytes + entry.offset;
+    if (layout.useRans)
+    {
+        const RansTable *table = &ransTable;
+        RansTable blockTable;
+        if (layout.blockModels)
         {
-            throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
+            blockTable.buildFromFrequencies(readBaseFrequencies(payload));
+            table = &blockTable;
+            payload += RANS_MODEL_SIZE;
         }
-
-        HuffmanGenomeNode *currentNode = root;
-        for (size_t i = 0; i < bitString.size(); ++i)
+        table->decode(payload, static_cast<size_t>(entry.bitLength / 8), reinterpret_cast<unsigned char *>(output), count);
+    }
+    else
+    {
+        const BaseCode *code = &layout.code;
+        BaseCode blockCode;
+        if (layout.blockModels)
         {
-            char bitChar = bitString[i];
-            if (bitChar == '0')
-            {
-                currentNode = currentNode->left;
-            }
-            else if (bitChar == '1')
+            HuffmanTable blockTable;
+            blockTable.buildFromLengths(unpackLengths(*payload));
+            blockCode = BaseCode(blockTable);
+            code = &blockCode;
+            payload += HUFFMAN_MODEL_SIZE;
+        }
+        size_t decoded;
+        if (layout.splitStreams)
+        {
+            // The streams must exactly fill the payload that the index gives the block
+            const uint64_t payloadBytes = entry.bitLength / 8;
+            const unsigned char *streams[HuffmanTable::STREAM_COUNT];
+            uint64_t bitLengths[HuffmanTable::STREAM_COUNT];
+            const bool hasTable = entry.bitLength % 8 == 0 && payloadBytes >= STREAM_TABLE_SIZE;
+            uint64_t used = STREAM_TABLE_SIZE;
+            for (int s = 0; hasTable && s < HuffmanTable::STREAM_COUNT; ++s)
             {
-                currentNode = currentNode->right;
+                bitLengths[s] = BitIO::readUInt(payload + 4 * s, 4);
+                used += (bitLengths[s] + 7) / 8;
             }
-            else
+            if (!hasTable || used != payloadBytes)
             {
-                throw std::runtime_error("Error: Invalid bit character in bit string.");
+                throw std::runtime_error("Error: Decoding failed. Block " + std::to_string(block) +
+                                         " has a corrupt stream table.");
             }
-
-            if (!currentNode)
+            streams[0] = payload + STREAM_TABLE_SIZE;
+            for (int s = 1; s < HuffmanTable::STREAM_COUNT; ++s)
             {
-                throw std::runtime_error("Error: Decoding failed. Invalid path in Huffman tree.");
-            }
-
-            // Leaf node
-            if (!currentNode->left && !currentNode->right)
-            {
-                outfile.put(currentNode->character);
-                currentNode = root;
+                streams[s] = streams[s - 1] + (bitLengths[s - 1] + 7) / 8;
             }
+            decoded = code->decodeStreams(streams, bitLengths, output, count);
+        }
+        else
+        {
+            decoded = code->decode(payload, entry.bitLength, output, count);
+        }
+        if (decoded != count)
+        {
+            throw std::runtime_error("Error: Decoding failed. Block " + std::to_string(block) +
+                                     " holds fewer bases than recorded.");
         }
-
-        outfile.close();
-
-        Logger::getInstance().log("Huffman decoding completed.");
-        std::cout << "Decoding successful. Output file: " << outputFilename << "\n";
-    }
-    catch (const std::exception &e)
-    {
-        Logger::getInstance().log(std::string("Exception during Huffman decoding: ") + e.what());
     }
+    layout.caseMask.apply(block * layout.blockSize, output, count);
 }
 
 // void HuffmanGenome::encode(const std::string& sequence) {
@@ -357,8 +941,7 @@ void HuffmanGenome::buildTree()
         pq.pop();
         root = new HuffmanGenomeNode('\0', onlyNode->frequency);
         root->left = onlyNode;
-        generateCodes(root, "");
-        return;
+        pq.push(root);
     }
 
     while (pq.size() > 1)
@@ -368,53 +951,37 @@ void HuffmanGenome::buildTree()
         HuffmanGenomeNode *right = pq.top();
         pq.pop();
 
-        int sum = left->frequency + right->frequency;
+        uint64_t sum = left->frequency + right->frequency;
         HuffmanGenomeNode *newNode = new HuffmanGenomeNode('\0', sum);
         newNode->left = left;
         newNode->right = right;
         pq.push(newNode);
     }
 
-    if (!pq.empty())
+    if (pq.empty())
     {
-        root = pq.top();
-        generateCodes(root, "");
+        return;
     }
+    root = pq.top();
+
+    std::array<unsigned char, HuffmanTable::ALPHABET_SIZE> lengths{};
+    generateCodeLengths(root, 0, lengths);
+    codeTable.buildFromLengths(lengths);
 }
 
-void HuffmanGenome::generateCodes(HuffmanGenomeNode *node, const std::string &code)
+void HuffmanGenome::generateCodeLengths(HuffmanGenomeNode *node, int depth, std::array<unsigned char, 256> &lengths)
 {
     if (!node)
         return;
 
     if (!node->left && !node->right)
     {
-        // Map character to enum index
-        int index;
-        switch (node->character)
-        {
-        case 'A':
-            index = A;
-            break;
-        case 'C':
-            index = C;
-            break;
-        case 'G':
-            index = G;
-            break;
-        case 'T':
-            index = T;
-            break;
-        default:
-            throw std::invalid_argument("Invalid character in Huffman tree.");
-        }
-        huffmanCodes[index] = code;
-
-        // Logger::getInstance().log(std::string("Character '") + node->character + "' has code: " + code);
+        lengths[static_cast<unsigned char>(node->character)] = static_cast<unsigned char>(depth);
+        return;
     }
 
-    generateCodes(node->left, code + "0");
-    generateCodes(node->right, code + "1");
+    generateCodeLengths(node->left, depth + 1, lengths);
+    generateCodeLengths(node->right, depth + 1, lengths);
 }
 
 std::string HuffmanGenome::getEncodedSequence() const
@@ -475,7 +1042,7 @@ void HuffmanGenome::loadFrequencyMap(const std::string &filename)
         deleteTree(root);
         root = nullptr;
         frequencyMap.fill(0);
-        huffmanCodes.fill("");
+        codeTable.clear();
         encodedSequence.clear();
 
         std::ifstream infile(filename);
@@ -484,7 +1051,7 @@ void HuffmanGenome::loadFrequencyMap(const std::string &filename)
             throw std::runtime_error("Error: Unable to open file '" + filename + "' for reading frequency map.");
         }
         char ch;
-        int freq;
+        uint64_t freq;
         while (infile >> ch >> freq)
         {
             int index = charToIndex(ch);
@@ -496,7 +1063,7 @@ void HuffmanGenome::loadFrequencyMap(const std::string &filename)
     }
     catch (const std::exception &e)
     {
-        Logger::getInstance().log(std::string("Exception during loading frequency map: ") + e.what());
+        LOG_ERROR(std::string("Exception during loading frequency map: ") + e.what());
     }
 }
 
@@ -504,7 +1071,7 @@ bool HuffmanGenome::validateDecodedFile(const std::string &originalFilename, con
 {
     try
     {
-        Logger::getInstance().log("Validating decoded file...");
+        LOG_DEBUG("Validating decoded file...");
 
         const size_t VALIDATION_BUFFER_SIZE = 65536;
         std::ifstream originalFile(originalFilename, std::ios::binary);
@@ -527,12 +1094,12 @@ bool HuffmanGenome::validateDecodedFile(const std::string &originalFilename, con
         std::streamsize decodedFileSize = decodedFile.tellg();
         decodedFile.seekg(0, std::ios::beg);
 
-        Logger::getInstance().log("Original file size: " + std::to_string(originalFileSize));
-        Logger::getInstance().log("Decoded file size: " + std::to_string(decodedFileSize));
+        LOG_DEBUG("Original file size: " + std::to_string(originalFileSize));
+        LOG_DEBUG("Decoded file size: " + std::to_string(decodedFileSize));
 
         if (originalFileSize != decodedFileSize)
         {
-            Logger::getInstance().log("Error: Files have different sizes.");
+            LOG_ERROR("Error: Files have different sizes.");
             return false;
         }
 
@@ -549,7 +1116,7 @@ bool HuffmanGenome::validateDecodedFile(const std::string &originalFilename, con
 
             if (originalBytesRead != decodedBytesRead)
             {
-                Logger::getInstance().log("Error: Files have different read sizes.");
+                LOG_ERROR("Error: Files have different read sizes.");
                 return false;
             }
             if (originalBytesRead == 0)
@@ -559,7 +1126,7 @@ bool HuffmanGenome::validateDecodedFile(const std::string &originalFilename, con
 
             if (std::memcmp(originalBuffer.data(), decodedBuffer.data(), static_cast<size_t>(originalBytesRead)) != 0)
             {
-                Logger::getInstance().log("Error: Files differ.");
+                LOG_ERROR("Error: Files differ.");
                 return false;
             }
         }
@@ -569,7 +1136,7 @@ bool HuffmanGenome::validateDecodedFile(const std::string &originalFilename, con
     }
     catch (const std::exception &e)
     {
-        Logger::getInstance().log(std::string("Exception during validation: ") + e.what());
+        LOG_ERROR(std::string("Exception during validation: ") + e.what());
         return false;
     }
 }
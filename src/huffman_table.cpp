@@ -0,0 +1,448 @@
+#include "HuffmanTable.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+HuffmanTable::HuffmanTable()
+{
+    clear();
+}
+
+void HuffmanTable::clear()
+{
+    codes.fill(0);
+    lengths.fill(0);
+    decodeTable.clear();
+}
+
+void HuffmanTable::limitCodeLengths(std::array<unsigned char, ALPHABET_SIZE> &lengths, int maxLength)
+{
+    const long long kraftLimit = 1LL << maxLength;
+    long long kraft = 0;
+
+    for (auto &length : lengths)
+    {
+        if (length > maxLength)
+        {
+            length = static_cast<unsigned char>(maxLength);
+        }
+        if (length > 0)
+        {
+            kraft += 1LL << (maxLength - length);
+        }
+    }
+
+    // Over-subscribed after clamping: lengthen the longest codes that can still grow
+    while (kraft > kraftLimit)
+    {
+        int candidate = -1;
+        for (int s = 0; s < ALPHABET_SIZE; ++s)
+        {
+            if (lengths[s] > 0 && lengths[s] < maxLength &&
+                (candidate < 0 || lengths[s] >= lengths[candidate]))
+            {
+                candidate = s;
+            }
+        }
+        if (candidate < 0)
+        {
+            throw std::runtime_error("Error: Alphabet too large for the maximum code length.");
+        }
+        lengths[candidate]++;
+        kraft -= 1LL << (maxLength - lengths[candidate]);
+    }
+
+    // Hand any slack back to the longest codes
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int length = maxLength; length > 1 && !changed; --length)
+        {
+            for (int s = ALPHABET_SIZE - 1; s >= 0; --s)
+            {
+                if (lengths[s] == length && kraft + (1LL << (maxLength - length)) <= kraftLimit)
+                {
+                    kraft += 1LL << (maxLength - length);
+                    lengths[s]--;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void HuffmanTable::buildFromLengths(const std::array<unsigned char, ALPHABET_SIZE> &codeLengths)
+{
+    clear();
+    lengths = codeLengths;
+
+    // Canonical assignment: walk lengths in increasing order, symbols in increasing order
+    std::array<int, MAX_CODE_LENGTH + 1> lengthCount{};
+    for (int s = 0; s < ALPHABET_SIZE; ++s)
+    {
+        if (lengths[s] > MAX_CODE_LENGTH)
+        {
+            throw std::runtime_error("Error: Huffman code length exceeds the supported maximum.");
+        }
+        lengthCount[lengths[s]]++;
+    }
+    lengthCount[0] = 0;
+
+    std::array<uint32_t, MAX_CODE_LENGTH + 2> nextCode{};
+    uint32_t code = 0;
+    for (int length = 1; length <= MAX_CODE_LENGTH; ++length)
+    {
+        code = (code + lengthCount[length - 1]) << 1;
+        nextCode[length] = code;
+    }
+
+    for (int s = 0; s < ALPHABET_SIZE; ++s)
+    {
+        if (lengths[s] > 0)
+        {
+            codes[s] = nextCode[lengths[s]]++;
+            if (codes[s] >= (1u << lengths[s]))
+            {
+                throw std::runtime_error("Error: Huffman code lengths are over-subscribed.");
+            }
+        }
+    }
+
+    // Single-symbol table: every LOOKUP_BITS pattern starting with a code maps to it
+    const uint32_t tableSize = 1u << LOOKUP_BITS;
+    std::vector<unsigned char> singleSymbol(tableSize, 0);
+    std::vector<unsigned char> singleBits(tableSize, 0);
+    for (int s = 0; s < ALPHABET_SIZE; ++s)
+    {
+        if (lengths[s] == 0)
+            continue;
+        uint32_t first = codes[s] << (LOOKUP_BITS - lengths[s]);
+        uint32_t count = 1u << (LOOKUP_BITS - lengths[s]);
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            singleSymbol[i] = static_cast<unsigned char>(s);
+            singleBits[i] = lengths[s];
+        }
+    }
+
+    // Multi-symbol table: greedily decode as many whole codes as fit in the index
+    decodeTable.assign(tableSize, DecodeEntry{});
+    for (uint32_t index = 0; index < tableSize; ++index)
+    {
+        DecodeEntry &entry = decodeTable[index];
+        int used = 0;
+        while (entry.symbolCount < MAX_SYMBOLS_PER_ENTRY)
+        {
+            uint32_t next = (index << used) & (tableSize - 1);
+            int bits = singleBits[next];
+            if (bits == 0 || bits > LOOKUP_BITS - used)
+                break;
+            entry.symbols[entry.symbolCount++] = singleSymbol[next];
+            used += bits;
+        }
+        entry.totalBits = static_cast<unsigned char>(used);
+        entry.firstBits = singleBits[index];
+    }
+}
+
+void HuffmanTable::buildFromCounts(const std::array<uint64_t, ALPHABET_SIZE> &counts)
+{
+    // Merge the two lightest nodes until one is left; parent links then give each leaf's depth
+    typedef std::pair<uint64_t, int> WeightedNode;
+    std::priority_queue<WeightedNode, std::vector<WeightedNode>, std::greater<WeightedNode>> heap;
+    for (int s = 0; s < ALPHABET_SIZE; ++s)
+    {
+        if (counts[s] > 0)
+        {
+            heap.push(WeightedNode(counts[s], s));
+        }
+    }
+
+    std::array<unsigned char, ALPHABET_SIZE> codeLengths{};
+    if (heap.size() == 1)
+    {
+        codeLengths[heap.top().second] = 1;
+    }
+    else if (heap.size() > 1)
+    {
+        std::vector<int> parent(2 * ALPHABET_SIZE, -1);
+        int nextNode = ALPHABET_SIZE;
+        while (heap.size() > 1)
+        {
+            WeightedNode first = heap.top();
+            heap.pop();
+            WeightedNode second = heap.top();
+            heap.pop();
+            parent[first.second] = nextNode;
+            parent[second.second] = nextNode;
+            heap.push(WeightedNode(first.first + second.first, nextNode++));
+        }
+        for (int s = 0; s < ALPHABET_SIZE; ++s)
+        {
+            if (counts[s] == 0)
+                continue;
+            int depth = 0;
+            for (int node = s; parent[node] >= 0; node = parent[node])
+            {
+                ++depth;
+            }
+            codeLengths[s] = static_cast<unsigned char>(std::min(depth, 255));
+        }
+        limitCodeLengths(codeLengths);
+    }
+
+    buildFromLengths(codeLengths);
+}
+
+uint64_t HuffmanTable::decode(BitReader &reader, std::ostream &out) const
+{
+    const size_t DECODE_BUFFER_SIZE = 65536;
+    std::vector<char> outBuffer(DECODE_BUFFER_SIZE + 4 * MAX_SYMBOLS_PER_ENTRY);
+    size_t outPos = 0;
+    uint64_t decodedSymbols = 0;
+
+    // Four probes fit in one refill (4 * LOOKUP_BITS <= 56 bits)
+    while (reader.bitsRemaining() >= 4 * LOOKUP_BITS)
+    {
+        reader.refill();
+        for (int probe = 0; probe < 4; ++probe)
+        {
+            const DecodeEntry &entry = decodeTable[reader.peek(LOOKUP_BITS)];
+            if (entry.totalBits == 0)
+            {
+                throw std::runtime_error("Error: Decoding failed. Invalid Huffman code in bit stream.");
+            }
+            std::memcpy(&outBuffer[outPos], entry.symbols, MAX_SYMBOLS_PER_ENTRY);
+            outPos += entry.symbolCount;
+            reader.consume(entry.totalBits);
+        }
+        if (outPos >= DECODE_BUFFER_SIZE)
+        {
+            out.write(outBuffer.data(), static_cast<std::streamsize>(outPos));
+            decodedSymbols += outPos;
+            outPos = 0;
+        }
+    }
+
+    // Tail: one symbol per probe so nothing is decoded from the padding bits
+    while (reader.bitsRemaining() > 0)
+    {
+        reader.refill();
+        const DecodeEntry &entry = decodeTable[reader.peek(LOOKUP_BITS)];
+        if (entry.firstBits == 0 || entry.firstBits > reader.bitsRemaining())
+        {
+            throw std::runtime_error("Error: Decoding failed. Invalid Huffman code in bit stream.");
+        }
+        outBuffer[outPos++] = static_cast<char>(entry.symbols[0]);
+        reader.consume(entry.firstBits);
+        if (outPos >= DECODE_BUFFER_SIZE)
+        {
+            out.write(outBuffer.data(), static_cast<std::streamsize>(outPos));
+            decodedSymbols += outPos;
+            outPos = 0;
+        }
+    }
+
+    out.write(outBuffer.data(), static_cast<std::streamsize>(outPos));
+    decodedSymbols += outPos;
+    return decodedSymbols;
+}
+
+size_t HuffmanTable::decode(BitReader &reader, char *output, size_t maxSymbols) const
+{
+    return decodeSegment(reader, output, 0, maxSymbols);
+}
+
+size_t HuffmanTable::decodeStreams(const unsigned char *const *streams, const uint64_t *bitLengths, char *output,
+                                   size_t count) const
+{
+    static_assert(STREAM_COUNT == 4, "one reader per stream below");
+    BitReader readers[STREAM_COUNT] = {
+        BitReader(streams[0], static_cast<size_t>((bitLengths[0] + 7) / 8), bitLengths[0]),
+        BitReader(streams[1], static_cast<size_t>((bitLengths[1] + 7) / 8), bitLengths[1]),
+        BitReader(streams[2], static_cast<size_t>((bitLengths[2] + 7) / 8), bitLengths[2]),
+        BitReader(streams[3], static_cast<size_t>((bitLengths[3] + 7) / 8), bitLengths[3])};
+    size_t outPos[STREAM_COUNT];
+    size_t end[STREAM_COUNT];
+    for (int s = 0; s < STREAM_COUNT; ++s)
+    {
+        outPos[s] = streamOffset(count, s);
+        end[s] = streamOffset(count, s + 1);
+    }
+
+    // Round-robin over the streams, one probe each, while all of them have four probes'
+    // worth of bits and room left
+    for (;;)
+    {
+        bool ready = true;
+        for (int s = 0; s < STREAM_COUNT; ++s)
+        {
+            ready = ready && readers[s].bitsRemaining() >= 4 * LOOKUP_BITS &&
+                    outPos[s] + 4 * MAX_SYMBOLS_PER_ENTRY <= end[s];
+        }
+        if (!ready)
+        {
+            break;
+        }
+        for (int s = 0; s < STREAM_COUNT; ++s)
+        {
+            readers[s].refill();
+        }
+        for (int probe = 0; probe < 4; ++probe)
+        {
+            for (int s = 0; s < STREAM_COUNT; ++s)
+            {
+                const DecodeEntry &entry = decodeTable[readers[s].peek(LOOKUP_BITS)];
+                if (entry.totalBits == 0)
+                {
+                    throw std::runtime_error("Error: Decoding failed. Invalid Huffman code in bit stream.");
+                }
+                std::memcpy(output + outPos[s], entry.symbols, MAX_SYMBOLS_PER_ENTRY);
+                outPos[s] += entry.symbolCount;
+                readers[s].consume(entry.totalBits);
+            }
+        }
+    }
+
+    size_t decoded = 0;
+    for (int s = 0; s < STREAM_COUNT; ++s)
+    {
+        decoded += decodeSegment(readers[s], output, outPos[s], end[s]) - streamOffset(count, s);
+    }
+    return decoded;
+}
+
+size_t HuffmanTable::decodeSegment(BitReader &reader, char *output, size_t outPos, size_t end) const
+{
+    while (reader.bitsRemaining() >= 4 * LOOKUP_BITS && outPos + 4 * MAX_SYMBOLS_PER_ENTRY <= end)
+    {
+        reader.refill();
+        for (int probe = 0; probe < 4; ++probe)
+        {
+            const DecodeEntry &entry = decodeTable[reader.peek(LOOKUP_BITS)];
+            if (entry.totalBits == 0)
+            {
+                throw std::runtime_error("Error: Decoding failed. Invalid Huffman code in bit stream.");
+            }
+            std::memcpy(output + outPos, entry.symbols, MAX_SYMBOLS_PER_ENTRY);
+            outPos += entry.symbolCount;
+            reader.consume(entry.totalBits);
+        }
+    }
+
+    // Near the end of the bits or the room, one symbol per probe
+    while (reader.bitsRemaining() > 0)
+    {
+        reader.refill();
+        const DecodeEntry &entry = decodeTable[reader.peek(LOOKUP_BITS)];
+        if (entry.firstBits == 0 || entry.firstBits > reader.bitsRemaining())
+        {
+            throw std::runtime_error("Error: Decoding failed. Invalid Huffman code in bit stream.");
+        }
+        if (outPos >= end)
+        {
+            throw std::runtime_error("Error: Decoding failed. Block holds more symbols than expected.");
+        }
+        output[outPos++] = static_cast<char>(entry.symbols[0]);
+        reader.consume(entry.firstBits);
+    }
+    return outPos;
+}
+
+void HuffmanTable::writeLengths(std::ostream &out) const
+{
+    // A sparse list costs 1.5 bytes per symbol, the dense form a flat 128 bytes
+    const int SPARSE_LIMIT = 85;
+
+    std::vector<unsigned char> used;
+    for (int s = 0; s < ALPHABET_SIZE; ++s)
+    {
+        if (lengths[s] > 0)
+        {
+            used.push_back(static_cast<unsigned char>(s));
+        }
+    }
+
+    uint16_t symbolCount = static_cast<uint16_t>(used.size());
+    out.put(static_cast<char>(symbolCount & 0xFF));
+    out.put(static_cast<char>(symbolCount >> 8));
+
+    std::vector<unsigned char> nibbleSource;
+    if (symbolCount <= SPARSE_LIMIT)
+    {
+        out.write(reinterpret_cast<const char *>(used.data()), static_cast<std::streamsize>(used.size()));
+        for (unsigned char symbol : used)
+        {
+            nibbleSource.push_back(lengths[symbol]);
+        }
+    }
+    else
+    {
+        nibbleSource.assign(lengths.begin(), lengths.end());
+    }
+
+    for (size_t i = 0; i < nibbleSource.size(); i += 2)
+    {
+        unsigned char high = nibbleSource[i];
+        unsigned char low = (i + 1 < nibbleSource.size()) ? nibbleSource[i + 1] : 0;
+        out.put(static_cast<char>((high << 4) | low));
+    }
+}
+
+std::array<unsigned char, HuffmanTable::ALPHABET_SIZE> HuffmanTable::readLengths(std::istream &in)
+{
+    const int SPARSE_LIMIT = 85;
+    std::array<unsigned char, ALPHABET_SIZE> result{};
+
+    unsigned char countBytes[2];
+    if (!in.read(reinterpret_cast<char *>(countBytes), 2))
+    {
+        throw std::runtime_error("Error: Truncated Huffman header.");
+    }
+    int symbolCount = countBytes[0] | (countBytes[1] << 8);
+    if (symbolCount > ALPHABET_SIZE)
+    {
+        throw std::runtime_error("Error: Invalid symbol count in Huffman header.");
+    }
+
+    std::vector<unsigned char> symbols;
+    if (symbolCount <= SPARSE_LIMIT)
+    {
+        symbols.resize(symbolCount);
+    }
+    else
+    {
+        symbols.resize(ALPHABET_SIZE);
+        for (int s = 0; s < ALPHABET_SIZE; ++s)
+        {
+            symbols[s] = static_cast<unsigned char>(s);
+        }
+    }
+    if (symbolCount <= SPARSE_LIMIT && symbolCount > 0 &&
+        !in.read(reinterpret_cast<char *>(symbols.data()), symbolCount))
+    {
+        throw std::runtime_error("Error: Truncated Huffman header.");
+    }
+
+    std::vector<unsigned char> packed((symbols.size() + 1) / 2);
+    if (!packed.empty() && !in.read(reinterpret_cast<char *>(packed.data()), static_cast<std::streamsize>(packed.size())))
+    {
+        throw std::runtime_error("Error: Truncated Huffman header.");
+    }
+
+    for (size_t i = 0; i < symbols.size(); ++i)
+    {
+        unsigned char nibble = (i % 2 == 0) ? (packed[i / 2] >> 4) : (packed[i / 2] & 0x0F);
+        if (nibble > MAX_CODE_LENGTH)
+        {
+            throw std::runtime_error("Error: Invalid code length in Huffman header.");
+        }
+        result[symbols[i]] = nibble;
+    }
+    return result;
+}
@@ -1,4 +1,42 @@
 #include "Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <time.h>
+
+namespace
+{
+    // The coarse clock is read without a system call and is as fine as log lines need
+    uint64_t coarseNanoseconds()
+    {
+#if defined(CLOCK_MONOTONIC_COARSE)
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+        return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+#endif
+    }
+
+    const char *levelName(LogLevel level)
+    {
+        switch (level)
+        {
+        case LogLevel::Debug:
+            return "DEBUG";
+        case LogLevel::Info:
+            return "INFO ";
+        case LogLevel::Warning:
+            return "WARN ";
+        default:
+            return "ERROR";
+        }
+    }
+
+    const std::chrono::milliseconds POLL_INTERVAL(20);
+}
 
 Logger &Logger::getInstance()
 {
@@ -6,8 +44,165 @@ Logger &Logger::getInstance()
     return instance;
 }
 
-void Logger::log(const std::string &message)
+Logger::Logger() : startTime(coarseNanoseconds())
+{
+    for (size_t i = 0; i < RING_SIZE; ++i)
+    {
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    worker = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger()
+{
+    {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void Logger::push(LogLevel level, const std::string &message)
+{
+    // Each slot's sequence says whose turn it is: pos when free for the producer that
+    // claims position pos, pos + 1 once that producer has filled it
+    uint64_t pos = enqueuePosition.load(std::memory_order_relaxed);
+    Slot *slot;
+    for (;;)
+    {
+        slot = &ring[pos & (RING_SIZE - 1)];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int64_t lag = static_cast<int64_t>(sequence - pos);
+        if (lag == 0)
+        {
+            if (enqueuePosition.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (lag < 0)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            pos = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+    slot->level = level;
+    slot->timestamp = coarseNanoseconds();
+    slot->message.assign(message); // reuses the slot's capacity once warmed up
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+bool Logger::drain()
+{
+    bool wrote = false;
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    for (;;)
+    {
+        Slot &slot = ring[dequeuePosition & (RING_SIZE - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+        {
+            break;
+        }
+        write(slot);
+        slot.sequence.store(dequeuePosition + RING_SIZE, std::memory_order_release);
+        ++dequeuePosition;
+        wrote = true;
+    }
+
+    uint64_t lost = dropped.load(std::memory_order_relaxed);
+    if (lost != reportedDrops)
+    {
+        Slot note;
+        note.level = LogLevel::Warning;
+        note.timestamp = coarseNanoseconds();
+        note.message = std::to_string(lost - reportedDrops) + " log messages dropped; the log ring was full.";
+        write(note);
+        reportedDrops = lost;
+        wrote = true;
+    }
+    if (wrote && sink != Sink::None)
+    {
+        (sink == Sink::File ? static_cast<std::ostream &>(file) : std::cerr).flush();
+    }
+    return wrote;
+}
+
+void Logger::write(const Slot &slot)
+{
+    if (sink == Sink::None)
+    {
+        return;
+    }
+    char prefix[32];
+    double seconds = static_cast<double>(slot.timestamp - startTime) / 1e9;
+    int length = std::snprintf(prefix, sizeof(prefix), "[%10.3f] %s ", seconds, levelName(slot.level));
+    std::ostream &out = sink == Sink::File ? static_cast<std::ostream &>(file) : std::cerr;
+    out.write(prefix, length);
+    out.write(slot.message.data(), static_cast<std::streamsize>(slot.message.size()));
+    out.put('\n');
+}
+
+void Logger::run()
+{
+    std::unique_lock<std::mutex> lock(drainMutex);
+    for (;;)
+    {
+        const bool stop = stopping;
+        const uint64_t requested = flushRequests;
+        // Everything claimed before this point gets written, even if its producer is mid-copy
+        const uint64_t target = enqueuePosition.load(std::memory_order_acquire);
+        lock.unlock();
+
+        drain();
+        while (dequeuePosition < target)
+        {
+            std::this_thread::yield();
+            drain();
+        }
+
+        lock.lock();
+        if (requested != flushesServed)
+        {
+            flushesServed = requested;
+            drained.notify_all();
+        }
+        if (stop)
+        {
+            return;
+        }
+        wake.wait_for(lock, POLL_INTERVAL, [this]() { return stopping || flushRequests != flushesServed; });
+    }
+}
+
+void Logger::flush()
+{
+    std::unique_lock<std::mutex> lock(drainMutex);
+    const uint64_t ticket = ++flushRequests;
+    wake.notify_one();
+    drained.wait(lock, [this, ticket]() { return flushesServed >= ticket; });
+}
+
+void Logger::setSink(Sink newSink, const std::string &path)
 {
-    std::lock_guard<std::mutex> lock(logMutex);
-    std::cout << message << std::endl;
+    flush();
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    if (file.is_open())
+    {
+        file.close();
+    }
+    if (newSink == Sink::File)
+    {
+        file.open(path, std::ios::app);
+        if (!file)
+        {
+            sink = Sink::Stderr;
+            throw std::runtime_error("Error: Unable to open log file '" + path + "'.");
+        }
+    }
+    sink = newSink;
 }
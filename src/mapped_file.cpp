@@ -0,0 +1,113 @@
+#include "MappedFile.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPEDFILE_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string &filename, Access access)
+    : data_(nullptr), size_(0), mapped_(false)
+{
+#ifdef MAPPEDFILE_POSIX
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Error: Unable to open input file '" + filename + "'.");
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Error: Unable to read the size of '" + filename + "'.");
+    }
+    bool regularFile = S_ISREG(info.st_mode);
+    size_ = regularFile ? static_cast<size_t>(info.st_size) : 0;
+
+    // mmap rejects empty ranges; an empty file simply has no data
+    if (size_ > 0)
+    {
+        void *mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            ::madvise(mapping, size_, access == Access::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+#ifdef MADV_HUGEPAGE
+            ::madvise(mapping, size_, MADV_HUGEPAGE);
+#endif
+            data_ = static_cast<const char *>(mapping);
+            mapped_ = true;
+        }
+    }
+    ::close(fd);
+
+    if (mapped_ || (regularFile && size_ == 0))
+    {
+        return;
+    }
+#else
+    (void)access;
+#endif
+
+    // Fallback for platforms and files (pipes, devices) that cannot be mapped
+    std::ifstream infile(filename, std::ios::binary);
+    if (!infile)
+    {
+        throw std::runtime_error("Error: Unable to open input file '" + filename + "'.");
+    }
+    const size_t CHUNK_SIZE = 1 << 20;
+    size_t used = 0;
+    do
+    {
+        fallback_.resize(used + CHUNK_SIZE);
+        infile.read(fallback_.data() + used, static_cast<std::streamsize>(CHUNK_SIZE));
+        used += static_cast<size_t>(infile.gcount());
+    } while (infile);
+    if (infile.bad())
+    {
+        throw std::runtime_error("Error: Unable to read input file '" + filename + "'.");
+    }
+    fallback_.resize(used);
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+}
+
+void MappedFile::release(size_t offset, size_t length) const
+{
+#ifdef MAPPEDFILE_POSIX
+    if (!mapped_ || offset >= size_)
+    {
+        return;
+    }
+    // Only whole pages are dropped; a partial page at the end of the file is whole to us
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t begin = (offset + page - 1) / page * page;
+    size_t end = std::min(size_, offset + length);
+    if (end < size_)
+    {
+        end = end / page * page;
+    }
+    if (end > begin)
+    {
+        ::madvise(const_cast<char *>(data_) + begin, end - begin, MADV_DONTNEED);
+    }
+#else
+    (void)offset;
+    (void)length;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef MAPPEDFILE_POSIX
+    if (mapped_)
+    {
+        ::munmap(const_cast<char *>(data_), size_);
+    }
+#endif
+}
@@ -0,0 +1,687 @@
+#include "Pack2Genome.h"
+#include "Logger.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include "FileValidator.h"
+#include "CompressionException.h"
+#include "MappedFile.h"
+#include "BitIO.h"
+#include "ExceptionStream.h"
+#include "BaseClassifier.h"
+#include "CaseMask.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PACK2_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+const size_t BUFFER_SIZE = 1024 * 1024; // multiple of 4, so only the last chunk ends mid-byte
+
+// Archive layout (version 3): magic, version, packed core bases, count of unused 2-bit slots
+// in the last byte, case mask over the core bases, u64 case mask size, exception stream,
+// u64 exception stream size. Both streams are empty when the input was plain upper-case bases.
+const char FORMAT_MAGIC = 'P';
+const char FORMAT_VERSION = 3;
+const size_t HEADER_SIZE = 2;
+const size_t SECTION_SIZE_FIELD = 8;
+
+const unsigned char INVALID_CODE = 0xFF;
+const char BASE_SYMBOLS[] = {'A', 'C', 'G', 'T'};
+
+struct Pack2Tables
+{
+    unsigned char encode[256]; // ASCII -> 2-bit code, INVALID_CODE for anything but A/C/G/T
+    char decode[256][4];       // packed byte -> four ASCII bases
+
+    Pack2Tables()
+    {
+        std::memset(encode, INVALID_CODE, sizeof(encode));
+        for (int code = 0; code < 4; ++code)
+        {
+            encode[static_cast<unsigned char>(BASE_SYMBOLS[code])] = static_cast<unsigned char>(code);
+            encode[static_cast<unsigned char>(BASE_SYMBOLS[code] | 0x20)] = static_cast<unsigned char>(code);
+        }
+        for (int byte = 0; byte < 256; ++byte)
+        {
+            for (int slot = 0; slot < 4; ++slot)
+            {
+                decode[byte][slot] = BASE_SYMBOLS[(byte >> (2 * slot)) & 0x03];
+            }
+        }
+    }
+};
+
+static const Pack2Tables &tables()
+{
+    static const Pack2Tables instance;
+    return instance;
+}
+
+static size_t packScalar(const char *input, size_t count, unsigned char *output)
+{
+    const unsigned char *encode = tables().encode;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        unsigned char c0 = encode[static_cast<unsigned char>(input[i])];
+        unsigned char c1 = encode[static_cast<unsigned char>(input[i + 1])];
+        unsigned char c2 = encode[static_cast<unsigned char>(input[i + 2])];
+        unsigned char c3 = encode[static_cast<unsigned char>(input[i + 3])];
+        if ((c0 | c1 | c2 | c3) & 0x80)
+        {
+            break;
+        }
+        output[i / 4] = static_cast<unsigned char>(c0 | (c1 << 2) | (c2 << 4) | (c3 << 6));
+    }
+
+    // Tail, or the 4-base group that holds an invalid byte
+    unsigned char packed = 0;
+    for (size_t j = i; j < count; ++j)
+    {
+        unsigned char code = encode[static_cast<unsigned char>(input[j])];
+        if (code == INVALID_CODE)
+        {
+            return j;
+        }
+        packed |= static_cast<unsigned char>(code << (2 * (j % 4)));
+        if (j % 4 == 3 || j + 1 == count)
+        {
+            output[j / 4] = packed;
+            packed = 0;
+        }
+    }
+    return count;
+}
+
+static void unpackScalar(const unsigned char *input, size_t count, char *output)
+{
+    const Pack2Tables &t = tables();
+    size_t fullBytes = count / 4;
+    for (size_t i = 0; i < fullBytes; ++i)
+    {
+        std::memcpy(output + 4 * i, t.decode[input[i]], 4);
+    }
+    if (count % 4)
+    {
+        std::memcpy(output + 4 * fullBytes, t.decode[input[fullBytes]], count % 4);
+    }
+}
+
+#ifdef PACK2_X86_KERNELS
+
+// Low nibble of the ASCII code tells the bases apart in either case: A=1, C=3, G=7, T=4
+#define PACK2_NIBBLE_LUT 0, 0, 0, 1, 3, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0
+#define PACK2_FIRST_LUT 'A', 'C', 'G', 'T', 'A', 'C', 'G', 'T', 'A', 'C', 'G', 'T', 'A', 'C', 'G', 'T'
+#define PACK2_SECOND_LUT 'A', 'A', 'A', 'A', 'C', 'C', 'C', 'C', 'G', 'G', 'G', 'G', 'T', 'T', 'T', 'T'
+
+__attribute__((target("ssse3"))) static size_t packSsse3(const char *input, size_t count, unsigned char *output)
+{
+    const __m128i lut = _mm_setr_epi8(PACK2_NIBBLE_LUT);
+    const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+    const __m128i caseMask = _mm_set1_epi8(static_cast<char>(0xDF));
+    const __m128i baseA = _mm_set1_epi8('A');
+    const __m128i baseC = _mm_set1_epi8('C');
+    const __m128i baseG = _mm_set1_epi8('G');
+    const __m128i baseT = _mm_set1_epi8('T');
+    const __m128i pairWeights = _mm_set1_epi16(0x0401); // c0 + 4 * c1
+    const __m128i quadWeights = _mm_set1_epi32(0x00100001); // p0 + 16 * p1
+    const __m128i gather = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+        __m128i upper = _mm_and_si128(v, caseMask);
+        __m128i valid = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(upper, baseA), _mm_cmpeq_epi8(upper, baseC)),
+                                     _mm_or_si128(_mm_cmpeq_epi8(upper, baseG), _mm_cmpeq_epi8(upper, baseT)));
+        if (_mm_movemask_epi8(valid) != 0xFFFF)
+        {
+            break;
+        }
+        __m128i codes = _mm_shuffle_epi8(lut, _mm_and_si128(v, nibbleMask));
+        __m128i packed = _mm_madd_epi16(_mm_maddubs_epi16(codes, pairWeights), quadWeights);
+        uint32_t word = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_shuffle_epi8(packed, gather)));
+        std::memcpy(output + i / 4, &word, sizeof(word));
+    }
+    return i + packScalar(input + i, count - i, output + i / 4);
+}
+
+__attribute__((target("avx2"))) static size_t packAvx2(const char *input, size_t count, unsigned char *output)
+{
+    const __m256i lut = _mm256_setr_epi8(PACK2_NIBBLE_LUT, PACK2_NIBBLE_LUT);
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+    const __m256i caseMask = _mm256_set1_epi8(static_cast<char>(0xDF));
+    const __m256i baseA = _mm256_set1_epi8('A');
+    const __m256i baseC = _mm256_set1_epi8('C');
+    const __m256i baseG = _mm256_set1_epi8('G');
+    const __m256i baseT = _mm256_set1_epi8('T');
+    const __m256i pairWeights = _mm256_set1_epi16(0x0401);
+    const __m256i quadWeights = _mm256_set1_epi32(0x00100001);
+    const __m256i gather = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                            0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i joinLanes = _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1);
+
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));
+        __m256i upper = _mm256_and_si256(v, caseMask);
+        __m256i valid = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(upper, baseA), _mm256_cmpeq_epi8(upper, baseC)),
+                                        _mm256_or_si256(_mm256_cmpeq_epi8(upper, baseG), _mm256_cmpeq_epi8(upper, baseT)));
+        if (static_cast<uint32_t>(_mm256_movemask_epi8(valid)) != 0xFFFFFFFFu)
+        {
+            break;
+        }
+        __m256i codes = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, nibbleMask));
+        __m256i packed = _mm256_madd_epi16(_mm256_maddubs_epi16(codes, pairWeights), quadWeights);
+        packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(packed, gather), joinLanes);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(output + i / 4), _mm256_castsi256_si128(packed));
+    }
+    return i + packScalar(input + i, count - i, output + i / 4);
+}
+
+__attribute__((target("ssse3"))) static void unpackSsse3(const unsigned char *input, size_t count, char *output)
+{
+    const __m128i firstLut = _mm_setr_epi8(PACK2_FIRST_LUT);
+    const __m128i secondLut = _mm_setr_epi8(PACK2_SECOND_LUT);
+    const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+
+    size_t fullBytes = count / 4;
+    size_t j = 0;
+    for (; j + 16 <= fullBytes; j += 16)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + j));
+        __m128i lo = _mm_and_si128(x, nibbleMask);
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), nibbleMask);
+        __m128i a = _mm_shuffle_epi8(firstLut, lo);
+        __m128i b = _mm_shuffle_epi8(secondLut, lo);
+        __m128i c = _mm_shuffle_epi8(firstLut, hi);
+        __m128i d = _mm_shuffle_epi8(secondLut, hi);
+        __m128i ab0 = _mm_unpacklo_epi8(a, b);
+        __m128i ab1 = _mm_unpackhi_epi8(a, b);
+        __m128i cd0 = _mm_unpacklo_epi8(c, d);
+        __m128i cd1 = _mm_unpackhi_epi8(c, d);
+        char *out = output + 4 * j;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi16(ab0, cd0));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), _mm_unpackhi_epi16(ab0, cd0));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 32), _mm_unpacklo_epi16(ab1, cd1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 48), _mm_unpackhi_epi16(ab1, cd1));
+    }
+    unpackScalar(input + j, count - 4 * j, output + 4 * j);
+}
+
+__attribute__((target("avx2"))) static void unpackAvx2(const unsigned char *input, size_t count, char *output)
+{
+    const __m256i firstLut = _mm256_setr_epi8(PACK2_FIRST_LUT, PACK2_FIRST_LUT);
+    const __m256i secondLut = _mm256_setr_epi8(PACK2_SECOND_LUT, PACK2_SECOND_LUT);
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+
+    size_t fullBytes = count / 4;
+    size_t j = 0;
+    for (; j + 32 <= fullBytes; j += 32)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + j));
+        __m256i lo = _mm256_and_si256(x, nibbleMask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibbleMask);
+        __m256i a = _mm256_shuffle_epi8(firstLut, lo);
+        __m256i b = _mm256_shuffle_epi8(secondLut, lo);
+        __m256i c = _mm256_shuffle_epi8(firstLut, hi);
+        __m256i d = _mm256_shuffle_epi8(secondLut, hi);
+        __m256i ab0 = _mm256_unpacklo_epi8(a, b);
+        __m256i ab1 = _mm256_unpackhi_epi8(a, b);
+        __m256i cd0 = _mm256_unpacklo_epi8(c, d);
+        __m256i cd1 = _mm256_unpackhi_epi8(c, d);
+        // Unpacks work per 128-bit lane: lane 0 holds input bytes 0-15, lane 1 bytes 16-31
+        __m256i r0 = _mm256_unpacklo_epi16(ab0, cd0);
+        __m256i r1 = _mm256_unpackhi_epi16(ab0, cd0);
+        __m256i r2 = _mm256_unpacklo_epi16(ab1, cd1);
+        __m256i r3 = _mm256_unpackhi_epi16(ab1, cd1);
+        char *out = output + 4 * j;
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_permute2x128_si256(r0, r1, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 32), _mm256_permute2x128_si256(r2, r3, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 64), _mm256_permute2x128_si256(r0, r1, 0x31));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 96), _mm256_permute2x128_si256(r2, r3, 0x31));
+    }
+    unpackScalar(input + j, count - 4 * j, output + 4 * j);
+}
+
+#endif
+
+typedef size_t (*PackKernel)(const char *, size_t, unsigned char *);
+typedef void (*UnpackKernel)(const unsigned char *, size_t, char *);
+
+static PackKernel selectPackKernel()
+{
+#ifdef PACK2_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return packAvx2;
+    if (__builtin_cpu_supports("ssse3"))
+        return packSsse3;
+#endif
+    return packScalar;
+}
+
+static UnpackKernel selectUnpackKernel()
+{
+#ifdef PACK2_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return unpackAvx2;
+    if (__builtin_cpu_supports("ssse3"))
+        return unpackSsse3;
+#endif
+    return unpackScalar;
+}
+
+size_t Pack2Genome::packBases(const char *input, size_t count, unsigned char *output)
+{
+    static const PackKernel kernel = selectPackKernel();
+    return kernel(input, count, output);
+}
+
+void Pack2Genome::unpackBases(const unsigned char *input, size_t count, char *output)
+{
+    static const UnpackKernel kernel = selectUnpackKernel();
+    kernel(input, count, output);
+}
+
+Pack2Genome::Pack2Genome() : metrics() {}
+
+bool Pack2Genome::validateInputPath(const std::string &inputFilename) const
+{
+    if (!FileValidator::hasTxtExtension(inputFilename))
+    {
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' does not have a .txt extension.");
+        std::cerr << "Error: Unsupported file format. Only .txt files are allowed.\n";
+        return false;
+    }
+
+    if (!FileValidator::fileExists(inputFilename))
+    {
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' does not exist.");
+        std::cerr << "Error: File does not exist.\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool Pack2Genome::validateInputFile(const std::string &inputFilename) const
+{
+    if (!validateInputPath(inputFilename))
+    {
+        return false;
+    }
+
+    if (!FileValidator::hasValidSequenceData(inputFilename))
+    {
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' contains invalid characters.");
+        std::cerr << "Error: File contains invalid characters. Only A, C, G, T, N and IUPAC ambiguity codes are allowed.\n";
+        return false;
+    }
+
+    return true;
+}
+
+void Pack2Genome::reportInvalidBase(const std::string &inputFilename, size_t offset, char ch) const
+{
+    LOG_WARNING("Validation Error: File '" + inputFilename + "' has an invalid character at offset " +
+                              std::to_string(offset) + ".");
+    std::cerr << "Error: Invalid character '" << ch << "' at offset " << offset
+              << " in input file. Only A, C, G, T, N and IUPAC ambiguity codes are allowed.\n";
+}
+
+void Pack2Genome::encodeFromFile(const std::string &inputFilename, const std::string &outputFilename)
+{
+    try
+    {
+        metrics = CompressionMetrics();
+
+        CompressionMetrics::PhaseTimer timer;
+        if (!validateInputPath(inputFilename))
+        {
+            LOG_WARNING("Encoding aborted due to input file validation failure.");
+            return;
+        }
+        const double validationSeconds = timer.seconds();
+
+        LOG_INFO("Compressing using 2-bit packing...");
+
+        MappedFile input(inputFilename);
+
+        std::ofstream outfile(outputFilename, std::ios::binary);
+        if (!outfile)
+        {
+            throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
+        }
+        if (!encodeSequence(input.data(), input.size(), outfile, inputFilename))
+        {
+            outfile.close();
+            std::remove(outputFilename.c_str());
+            LOG_WARNING("Encoding aborted due to input file validation failure.");
+            return;
+        }
+
+        metrics.addPhase(CompressionMetrics::Phase::Validation, validationSeconds, 0);
+        timer.restart();
+        const uint64_t archiveBytes = static_cast<uint64_t>(outfile.tellp());
+        outfile.close();
+        metrics.addPhase(CompressionMetrics::Phase::Io, timer.seconds(), archiveBytes);
+
+        LOG_INFO("2-bit packing completed.");
+        std::cout << "Compression successful. Output file: " << outputFilename << "\n";
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR(std::string("Exception during 2-bit packing: ") + e.what());
+        // Leave no partial output behind, and let the caller see the failure
+        if (inputFilename != outputFilename)
+        {
+            std::remove(outputFilename.c_str());
+        }
+        throw CompressionException(e.what());
+    }
+}
+
+bool Pack2Genome::encodeSequence(const char *data, size_t count, std::ostream &out, const std::string &sourceName)
+{
+    metrics = CompressionMetrics();
+    CompressionMetrics::PhaseTimer timer;
+
+    out.put(FORMAT_MAGIC);
+    out.put(FORMAT_VERSION);
+
+    // Bases are packed one output chunk at a time.
+    // The pack kernels double as the validator: they stop at the first non-base byte. A chunk
+    // they stop in is split into core bases and exception runs, and the core is packed instead.
+    // Core bases that do not fill a byte carry over to the next chunk.
+    // Packing folds case, so each packed piece is scanned again for its case toggles.
+    ExceptionStream exceptions;
+    CaseMask caseMask;
+    std::vector<uint64_t> toggles;
+    uint64_t counts[4];
+    std::vector<unsigned char> packed(BUFFER_SIZE / 4 + 2);
+    std::string core;
+    char carry[4];
+    size_t carried = 0;
+    uint64_t packedBytes = 0;
+    uint64_t packedBases = 0;
+
+    for (size_t offset = 0; offset < count; offset += BUFFER_SIZE)
+    {
+        size_t chunk = std::min(BUFFER_SIZE, count - offset);
+        const char *bases = data + offset;
+        if (carried == 0 && packBases(bases, chunk, packed.data()) == chunk)
+        {
+            out.write(reinterpret_cast<const char *>(packed.data()), static_cast<std::streamsize>((chunk + 3) / 4));
+            packedBytes += (chunk + 3) / 4;
+            toggles.clear();
+            BaseClassifier::countBases(bases, chunk, counts, toggles);
+            caseMask.addToggles(toggles, packedBases);
+            packedBases += chunk;
+            continue;
+        }
+
+        core.assign(carry, carried);
+        size_t splitBases = exceptions.split(bases, chunk, offset, core);
+        if (splitBases != chunk)
+        {
+            reportInvalidBase(sourceName, offset + splitBases, bases[splitBases]);
+            return false;
+        }
+        bool lastChunk = offset + chunk == count;
+        size_t packCount = lastChunk ? core.size() : core.size() / 4 * 4;
+        packBases(core.data(), packCount, packed.data());
+        out.write(reinterpret_cast<const char *>(packed.data()), static_cast<std::streamsize>((packCount + 3) / 4));
+        packedBytes += (packCount + 3) / 4;
+        toggles.clear();
+        BaseClassifier::countBases(core.data(), packCount, counts, toggles);
+        caseMask.addToggles(toggles, packedBases);
+        packedBases += packCount;
+        carried = core.size() - packCount;
+        std::memcpy(carry, core.data() + packCount, carried);
+    }
+
+    uint64_t coreBases = count - exceptions.exceptionBases();
+    int paddingSlots = static_cast<int>((4 - coreBases % 4) % 4);
+    out.put(static_cast<char>(paddingSlots));
+
+    std::vector<unsigned char> caseMaskBytes;
+    caseMask.serialize(caseMaskBytes);
+    out.write(reinterpret_cast<const char *>(caseMaskBytes.data()), static_cast<std::streamsize>(caseMaskBytes.size()));
+    BitIO::writeUInt(out, caseMaskBytes.size(), 8);
+
+    std::vector<unsigned char> exceptionBytes;
+    if (!exceptions.empty())
+    {
+        exceptions.serialize(exceptionBytes);
+    }
+    out.write(reinterpret_cast<const char *>(exceptionBytes.data()), static_cast<std::streamsize>(exceptionBytes.size()));
+    BitIO::writeUInt(out, exceptionBytes.size(), 8);
+
+    // Validation, counting and packing share one sweep, so all of it is encoding time
+    metrics.addPhase(CompressionMetrics::Phase::Encoding, timer.seconds(), count);
+
+    // The padding byte, the unused slots it counts and the size fields are not payload
+    metrics.calculateOriginalSize(static_cast<long long>(count) * 8);
+    metrics.calculateCompressedSize(
+        static_cast<long long>((HEADER_SIZE + packedBytes + caseMaskBytes.size() + exceptionBytes.size()) * 8) -
+        paddingSlots * 2);
+    return true;
+}
+
+void Pack2Genome::decodeFromFile(const std::string &inputFilename, const std::string &outputFilename)
+{
+    try
+    {
+        if (inputFilename == outputFilename)
+        {
+            throw std::runtime_error("Error: Output file must be different from input file to prevent overwriting.");
+        }
+
+        LOG_INFO("Starting 2-bit unpacking...");
+
+        MappedFile archive(inputFilename);
+        readLayout(archive.bytes(), archive.size(), inputFilename);
+
+        std::ofstream outfile(outputFilename, std::ios::binary);
+        if (!outfile)
+        {
+            throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
+        }
+        decodeSequence(archive.bytes(), archive.size(), outfile);
+
+        outfile.close();
+
+        LOG_INFO("2-bit unpacking completed.");
+        std::cout << "Decoding successful. Output file: " << outputFilename << "\n";
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR(std::string("Exception during 2-bit unpacking: ") + e.what());
+        // Leave no partial output behind, and let the caller see the failure
+        if (inputFilename != outputFilename)
+        {
+            std::remove(outputFilename.c_str());
+        }
+        throw CompressionException(e.what());
+    }
+}
+
+void Pack2Genome::decodeSequence(const unsigned char *archive, size_t size, std::ostream &out)
+{
+    CompressionMetrics::PhaseTimer timer;
+    const ArchiveLayout layout = readLayout(archive, size, "embedded sequence");
+
+    // Unpack straight out of the archive; BUFFER_SIZE is a multiple of 4, so chunks start on byte boundaries
+    const unsigned char *packed = archive + HEADER_SIZE;
+    std::vector<char> bases(BUFFER_SIZE);
+    ExceptionStream::Writer writer(layout.exceptions, out);
+    for (uint64_t done = 0; done < layout.coreBases; done += BUFFER_SIZE)
+    {
+        size_t chunkBases = static_cast<size_t>(std::min<uint64_t>(layout.coreBases - done, BUFFER_SIZE));
+        unpackBases(packed + done / 4, chunkBases, bases.data());
+        layout.caseMask.apply(done, bases.data(), chunkBases);
+        writer.write(bases.data(), chunkBases);
+    }
+    writer.finish();
+
+    metrics.clearPhase(CompressionMetrics::Phase::Decoding);
+    metrics.addPhase(CompressionMetrics::Phase::Decoding, timer.seconds(),
+                       layout.exceptions.sequenceLength(layout.coreBases));
+}
+
+std::string Pack2Genome::decodeRange(const std::string &archiveFilename, uint64_t start, uint64_t length)
+{
+    MappedFile archive(archiveFilename, MappedFile::Access::Random);
+    return unpackRange(archive.bytes(), archive.size(), start, length, archiveFilename);
+}
+
+std::string Pack2Genome::decodeSequenceRange(const unsigned char *archive, size_t size, uint64_t start, uint64_t length)
+{
+    return unpackRange(archive, size, start, length, "embedded sequence");
+}
+
+std::string Pack2Genome::unpackRange(const unsigned char *archive, size_t size, uint64_t start, uint64_t length,
+                                     const std::string &archiveFilename)
+{
+    const ArchiveLayout layout = readLayout(archive, size, archiveFilename);
+    if (start > layout.sequenceBases)
+    {
+        throw std::out_of_range("Error: Range starts at base " + std::to_string(start) + " but '" + archiveFilename +
+                                "' holds only " + std::to_string(layout.sequenceBases) + " bases.");
+    }
+    length = std::min(length, layout.sequenceBases - start);
+
+    // The core bases under the range, with the exception runs put back in
+    uint64_t coreStart = layout.exceptions.corePosition(start);
+    uint64_t coreLength = layout.exceptions.corePosition(start + length) - coreStart;
+
+    // Unpack from the byte holding the first base, then drop the bases before it in that byte
+    size_t skip = static_cast<size_t>(coreStart % 4);
+    std::string core(static_cast<size_t>(coreLength) + skip, '\0');
+    unpackBases(archive + HEADER_SIZE + coreStart / 4, core.size(), &core[0]);
+    core.erase(0, skip);
+    layout.caseMask.apply(coreStart, &core[0], core.size());
+    if (layout.exceptions.empty())
+    {
+        return core;
+    }
+    std::string range(static_cast<size_t>(length), '\0');
+    layout.exceptions.merge(core.data(), start, length, &range[0]);
+    return range;
+}
+
+Pack2Genome::ArchiveLayout Pack2Genome::readLayout(const unsigned char *archive, size_t fileSize,
+                                                   const std::string &inputFilename)
+{
+    if (fileSize < HEADER_SIZE + 1 + 2 * SECTION_SIZE_FIELD)
+    {
+        throw std::runtime_error("Error: Encoded file is too small.");
+    }
+
+    if (archive[0] != static_cast<unsigned char>(FORMAT_MAGIC) || archive[1] != static_cast<unsigned char>(FORMAT_VERSION))
+    {
+        throw std::runtime_error("Error: '" + inputFilename + "' is not a 2-bit packed archive.");
+    }
+
+    // Both trailing sections are read back to front
+    uint64_t exceptionSize = BitIO::readUInt(archive + fileSize - SECTION_SIZE_FIELD, 8);
+    if (exceptionSize > fileSize - HEADER_SIZE - 1 - 2 * SECTION_SIZE_FIELD)
+    {
+        throw std::runtime_error("Error: Corrupt exception stream in '" + inputFilename + "'.");
+    }
+    size_t exceptionOffset = fileSize - SECTION_SIZE_FIELD - static_cast<size_t>(exceptionSize);
+    uint64_t caseMaskSize = BitIO::readUInt(archive + exceptionOffset - SECTION_SIZE_FIELD, 8);
+    if (caseMaskSize > exceptionOffset - HEADER_SIZE - 1 - SECTION_SIZE_FIELD)
+    {
+        throw std::runtime_error("Error: Corrupt case mask in '" + inputFilename + "'.");
+    }
+    size_t caseMaskOffset = exceptionOffset - SECTION_SIZE_FIELD - static_cast<size_t>(caseMaskSize);
+    size_t paddingOffset = caseMaskOffset - 1;
+
+    ArchiveLayout layout;
+    if (exceptionSize > 0)
+    {
+        layout.exceptions = ExceptionStream::parse(archive + exceptionOffset, static_cast<size_t>(exceptionSize));
+    }
+
+    int paddingSlots = archive[paddingOffset];
+    uint64_t packedBytes = static_cast<uint64_t>(paddingOffset - HEADER_SIZE);
+    if (paddingSlots > 3 || (packedBytes == 0 && paddingSlots != 0))
+    {
+        throw std::runtime_error("Error: Invalid padding value in encoded file.");
+    }
+    layout.coreBases = packedBytes * 4 - static_cast<uint64_t>(paddingSlots);
+    layout.caseMask = CaseMask::parse(archive + caseMaskOffset, static_cast<size_t>(caseMaskSize), layout.coreBases);
+    layout.sequenceBases = layout.exceptions.sequenceLength(layout.coreBases);
+    return layout;
+}
+
+CompressionMetrics Pack2Genome::getMetrics() const
+{
+    return metrics;
+}
+
+bool Pack2Genome::validateDecodedFile(const std::string &originalFilename, const std::string &decodedFilename)
+{
+    try
+    {
+        LOG_DEBUG("Validating decoded file...");
+
+        const size_t VALIDATION_BUFFER_SIZE = 65536;
+        std::ifstream originalFile(originalFilename, std::ios::binary);
+        std::ifstream decodedFile(decodedFilename, std::ios::binary);
+
+        if (!originalFile.is_open())
+        {
+            throw std::runtime_error("Error: Unable to open original file '" + originalFilename + "'.");
+        }
+        if (!decodedFile.is_open())
+        {
+            throw std::runtime_error("Error: Unable to open decoded file '" + decodedFilename + "'.");
+        }
+
+        std::vector<char> originalBuffer(VALIDATION_BUFFER_SIZE);
+        std::vector<char> decodedBuffer(VALIDATION_BUFFER_SIZE);
+
+        while (true)
+        {
+            originalFile.read(originalBuffer.data(), VALIDATION_BUFFER_SIZE);
+            std::streamsize originalBytesRead = originalFile.gcount();
+
+            decodedFile.read(decodedBuffer.data(), VALIDATION_BUFFER_SIZE);
+            std::streamsize decodedBytesRead = decodedFile.gcount();
+
+            if (originalBytesRead != decodedBytesRead)
+            {
+                LOG_ERROR("Error: Files have different sizes.");
+                return false;
+            }
+            if (originalBytesRead == 0)
+            {
+                break;
+            }
+
+            if (std::memcmp(originalBuffer.data(), decodedBuffer.data(), static_cast<size_t>(originalBytesRead)) != 0)
+            {
+                LOG_ERROR("Error: Files differ.");
+                return false;
+            }
+        }
+
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR(std::string("Exception during validation: ") + e.what());
+        return false;
+    }
+}
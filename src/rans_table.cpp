@@ -0,0 +1,298 @@
+#include "RansTable.h"
+#include "BitIO.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+// Lower bound of the normalized state interval [RANS_L, 2^32). Renormalization moves one
+// 16-bit word at a time, and a 12-bit probability scale means a symbol never needs more than
+// one, so the decoder can renormalize without a loop or a data-dependent branch.
+const uint32_t RANS_L = 1u << 16;
+
+static_assert(RansTable::LANES == 4, "The coding loops are unrolled for four lanes");
+
+template <typename Symbol>
+static inline void encodeSymbol(uint32_t &state, unsigned char *&ptr, const Symbol &symbol)
+{
+    uint32_t x = state;
+    if (x >= symbol.maxState)
+    {
+        ptr -= 2;
+        ptr[0] = static_cast<unsigned char>(x & 0xFF);
+        ptr[1] = static_cast<unsigned char>((x >> 8) & 0xFF);
+        x >>= 16;
+    }
+    state = ((x / symbol.frequency) << RansTable::PROB_BITS) + (x % symbol.frequency) + symbol.start;
+}
+
+template <typename Entry>
+static inline unsigned char decodeSymbol(uint32_t &state, const unsigned char *&ptr, const Entry *table)
+{
+    const Entry &entry = table[state & (RansTable::PROB_SCALE - 1)];
+    uint32_t x = entry.frequency * (state >> RansTable::PROB_BITS) + entry.offset;
+    uint32_t word = static_cast<uint32_t>(ptr[0]) | (static_cast<uint32_t>(ptr[1]) << 8);
+    bool renormalize = x < RANS_L;
+    state = renormalize ? (x << 16) | word : x;
+    ptr += renormalize ? 2 : 0;
+    return entry.symbol;
+}
+
+RansTable::RansTable()
+{
+    clear();
+}
+
+void RansTable::clear()
+{
+    frequencies.fill(0);
+    encodeSymbols.fill(EncodeSymbol{0, 0, 0});
+    decodeTable.clear();
+}
+
+void RansTable::buildFromCounts(const std::array<uint64_t, ALPHABET_SIZE> &counts)
+{
+    uint64_t total = std::accumulate(counts.begin(), counts.end(), static_cast<uint64_t>(0));
+    if (total == 0)
+    {
+        clear();
+        return;
+    }
+
+    std::array<uint16_t, ALPHABET_SIZE> scaled{};
+    uint32_t sum = 0;
+    int largest = 0;
+    for (int s = 0; s < ALPHABET_SIZE; ++s)
+    {
+        if (counts[s] == 0)
+        {
+            continue;
+        }
+        double share = static_cast<double>(counts[s]) * PROB_SCALE / static_cast<double>(total);
+        scaled[s] = static_cast<uint16_t>(std::max(1.0, std::min(share, static_cast<double>(PROB_SCALE))));
+        sum += scaled[s];
+        if (counts[s] > counts[largest])
+        {
+            largest = s;
+        }
+    }
+
+    // Rounding leaves the sum a little off; the most frequent symbol absorbs a shortfall,
+    // and an excess (from the 1-minimums of rare symbols) is taken from the largest frequencies
+    if (sum < PROB_SCALE)
+    {
+        scaled[largest] = static_cast<uint16_t>(scaled[largest] + (PROB_SCALE - sum));
+    }
+    while (sum > PROB_SCALE)
+    {
+        int biggest = static_cast<int>(std::max_element(scaled.begin(), scaled.end()) - scaled.begin());
+        uint32_t take = std::min<uint32_t>(scaled[biggest] - 1u, sum - PROB_SCALE);
+        scaled[biggest] = static_cast<uint16_t>(scaled[biggest] - take);
+        sum -= take;
+    }
+
+    buildFromFrequencies(scaled);
+}
+
+void RansTable::buildFromFrequencies(const std::array<uint16_t, ALPHABET_SIZE> &stored)
+{
+    uint32_t sum = std::accumulate(stored.begin(), stored.end(), 0u);
+    if (sum == 0)
+    {
+        clear();
+        return;
+    }
+    if (sum != PROB_SCALE)
+    {
+        throw std::runtime_error("Error: rANS frequencies do not sum to the probability scale.");
+    }
+
+    frequencies = stored;
+    decodeTable.assign(PROB_SCALE, DecodeEntry{0, 0, 0});
+    uint32_t start = 0;
+    for (int s = 0; s < ALPHABET_SIZE; ++s)
+    {
+        uint32_t frequency = frequencies[s];
+        EncodeSymbol &symbol = encodeSymbols[s];
+        if (frequency == 0)
+        {
+            symbol = EncodeSymbol{0, 0, 0};
+            continue;
+        }
+
+        symbol.maxState = static_cast<uint64_t>((RANS_L >> PROB_BITS) << 16) * frequency;
+        symbol.frequency = frequency;
+        symbol.start = start;
+
+        for (uint32_t slot = 0; slot < frequency; ++slot)
+        {
+            decodeTable[start + slot] = DecodeEntry{static_cast<uint16_t>(frequency), static_cast<uint16_t>(slot),
+                                                    static_cast<unsigned char>(s)};
+        }
+        start += frequency;
+    }
+}
+
+void RansTable::addAlias(unsigned char alias, unsigned char symbol)
+{
+    encodeSymbols[alias] = encodeSymbols[symbol];
+}
+
+void RansTable::encode(const unsigned char *data, size_t count, std::vector<unsigned char> &out) const
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (encodeSymbols[data[i]].maxState == 0)
+        {
+            throw std::runtime_error("Error: Symbol missing from the rANS frequency table.");
+        }
+    }
+
+    // rANS codes last-in first-out, so the stream is built backwards from the end of a
+    // scratch buffer. A symbol emits at most one 16-bit word.
+    std::vector<unsigned char> scratch(2 * count + STATE_BYTES);
+    unsigned char *end = scratch.data() + scratch.size();
+    unsigned char *ptr = end;
+    const EncodeSymbol *symbols = encodeSymbols.data();
+
+    uint32_t state0 = RANS_L, state1 = RANS_L, state2 = RANS_L, state3 = RANS_L;
+    uint32_t *lanes[LANES] = {&state0, &state1, &state2, &state3};
+
+    // Symbol i belongs to lane i % LANES; the partial group at the end goes first
+    size_t i = count;
+    while (i % LANES)
+    {
+        --i;
+        encodeSymbol(*lanes[i % LANES], ptr, symbols[data[i]]);
+    }
+    while (i > 0)
+    {
+        i -= LANES;
+        encodeSymbol(state3, ptr, symbols[data[i + 3]]);
+        encodeSymbol(state2, ptr, symbols[data[i + 2]]);
+        encodeSymbol(state1, ptr, symbols[data[i + 1]]);
+        encodeSymbol(state0, ptr, symbols[data[i]]);
+    }
+
+    for (int lane = LANES - 1; lane >= 0; --lane)
+    {
+        ptr -= sizeof(uint32_t);
+        for (int b = 0; b < 4; ++b)
+        {
+            ptr[b] = static_cast<unsigned char>(*lanes[lane] >> (8 * b));
+        }
+    }
+    out.insert(out.end(), ptr, end);
+}
+
+void RansTable::decode(const unsigned char *data, size_t size, unsigned char *output, size_t count) const
+{
+    if (size < STATE_BYTES)
+    {
+        throw std::runtime_error("Error: Decoding failed. Truncated rANS stream.");
+    }
+    if (count > 0 && decodeTable.empty())
+    {
+        throw std::runtime_error("Error: Decoding failed. Empty rANS frequency table.");
+    }
+
+    uint32_t state[LANES];
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        state[lane] = static_cast<uint32_t>(BitIO::readUInt(data + lane * sizeof(uint32_t), 4));
+        if (state[lane] < RANS_L)
+        {
+            throw std::runtime_error("Error: Decoding failed. Invalid rANS state.");
+        }
+    }
+    uint32_t state0 = state[0], state1 = state[1], state2 = state[2], state3 = state[3];
+
+    const unsigned char *ptr = data + STATE_BYTES;
+    const unsigned char *end = data + size;
+    const DecodeEntry *table = decodeTable.data();
+
+    // Unchecked loop: a group of four symbols reads at most one word per lane
+    size_t i = 0;
+    for (; i + LANES <= count && static_cast<size_t>(end - ptr) >= 2 * LANES; i += LANES)
+    {
+        output[i] = decodeSymbol(state0, ptr, table);
+        output[i + 1] = decodeSymbol(state1, ptr, table);
+        output[i + 2] = decodeSymbol(state2, ptr, table);
+        output[i + 3] = decodeSymbol(state3, ptr, table);
+    }
+
+    state[0] = state0;
+    state[1] = state1;
+    state[2] = state2;
+    state[3] = state3;
+    for (; i < count; ++i)
+    {
+        uint32_t &x = state[i % LANES];
+        const DecodeEntry &entry = table[x & (PROB_SCALE - 1)];
+        output[i] = entry.symbol;
+        x = entry.frequency * (x >> PROB_BITS) + entry.offset;
+        if (x < RANS_L)
+        {
+            if (end - ptr < 2)
+            {
+                throw std::runtime_error("Error: Decoding failed. Truncated rANS stream.");
+            }
+            x = (x << 16) | static_cast<uint32_t>(ptr[0]) | (static_cast<uint32_t>(ptr[1]) << 8);
+            ptr += 2;
+        }
+    }
+
+    // Decoding undoes every encoder step, so each lane must be back at its starting state
+    if (ptr != end)
+    {
+        throw std::runtime_error("Error: Decoding failed. Unexpected data after the rANS stream.");
+    }
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        if (state[lane] != RANS_L)
+        {
+            throw std::runtime_error("Error: Decoding failed. Corrupt rANS stream.");
+        }
+    }
+}
+
+void RansTable::writeFrequencies(std::ostream &out) const
+{
+    uint32_t used = static_cast<uint32_t>(
+        std::count_if(frequencies.begin(), frequencies.end(), [](uint16_t f) { return f != 0; }));
+    BitIO::writeUInt(out, used, 2);
+    for (int s = 0; s < ALPHABET_SIZE; ++s)
+    {
+        if (frequencies[s] != 0)
+        {
+            out.put(static_cast<char>(s));
+            BitIO::writeUInt(out, frequencies[s], 2);
+        }
+    }
+}
+
+std::array<uint16_t, RansTable::ALPHABET_SIZE> RansTable::readFrequencies(std::istream &in)
+{
+    std::array<uint16_t, ALPHABET_SIZE> stored{};
+    uint64_t used = BitIO::readUInt(in, 2);
+    if (used > ALPHABET_SIZE)
+    {
+        throw std::runtime_error("Error: Invalid symbol count in rANS header.");
+    }
+    uint32_t sum = 0;
+    for (uint64_t i = 0; i < used; ++i)
+    {
+        unsigned char symbol = static_cast<unsigned char>(BitIO::readUInt(in, 1));
+        uint64_t frequency = BitIO::readUInt(in, 2);
+        if (frequency == 0 || frequency > PROB_SCALE || stored[symbol] != 0)
+        {
+            throw std::runtime_error("Error: Invalid frequency in rANS header.");
+        }
+        stored[symbol] = static_cast<uint16_t>(frequency);
+        sum += static_cast<uint32_t>(frequency);
+    }
+    if (used > 0 && sum != PROB_SCALE)
+    {
+        throw std::runtime_error("Error: Invalid frequency in rANS header.");
+    }
+    return stored;
+}
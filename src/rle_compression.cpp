@@ -4,33 +4,114 @@
 #include <vector>
 #include <cstring>
 #include <FileValidator.h>
+#include <CompressionException.h>
 #include <logger.h>
+#include "MappedFile.h"
+#include "BaseClassifier.h"
+#include "BitIO.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+
+// Archive layout (version 3): magic, version, one token per run, case mask, u64 case mask size.
+// A token byte holds the base in bits 7-6 (A=00, C=01, G=10, T=11) and the run length
+// in bits 5-0 for runs of 1-63 bases. A length field of 0 escapes a longer run: its
+// length minus 64 follows as a little-endian base-128 varint, so runs are unbounded.
+// Runs fold case; the case mask restores lower-case stretches.
+const char FORMAT_MAGIC = 'R';
+const char FORMAT_VERSION = 3;
+const size_t CASE_MASK_SIZE_FIELD = 8;
+const uint64_t SHORT_RUN_MAX = 63;
+const char BASE_SYMBOLS[] = {'A', 'C', 'G', 'T'};
+
+const size_t SCAN_CHUNK = 64 * 1024;
+const size_t OUTPUT_BUFFER_SIZE = 1024 * 1024;
+
+// 2-bit code of a validated base in either case: bits 2-1 of the ASCII value are
+// A=00, C=01, T=10, G=11, so only G and T need swapping
+static unsigned char baseCode(char ch)
+{
+    static const unsigned char SWAP_GT[] = {0, 1, 3, 2};
+    return SWAP_GT[(static_cast<unsigned char>(ch) >> 1) & 0x03];
+}
+
+static void appendRun(std::vector<unsigned char> &out, unsigned char code, uint64_t length)
+{
+    if (length <= SHORT_RUN_MAX)
+    {
+        out.push_back(static_cast<unsigned char>((code << 6) | length));
+        return;
+    }
+    out.push_back(static_cast<unsigned char>(code << 6));
+    uint64_t extra = length - (SHORT_RUN_MAX + 1);
+    while (extra >= 0x80)
+    {
+        out.push_back(static_cast<unsigned char>(0x80 | (extra & 0x7F)));
+        extra >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(extra));
+}
 
-const int COUNT_BITS = 16;
-const size_t BUFFER_SIZE = 1024 * 1024;
+// Length of an escaped run whose varint starts at tokens[pos]; advances pos past it
+static uint64_t readLongRun(const unsigned char *tokens, size_t size, size_t &pos)
+{
+    uint64_t extra = 0;
+    for (int shift = 0;; shift += 7)
+    {
+        if (pos >= size)
+        {
+            throw std::runtime_error("Error: Truncated run length in RLE archive.");
+        }
+        unsigned char byte = tokens[pos++];
+        if (shift >= 64 || (shift > 57 && ((byte & 0x7F) >> (64 - shift)) != 0))
+        {
+            throw std::runtime_error("Error: Run length overflows in RLE archive.");
+        }
+        extra |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            break;
+        }
+    }
+    if (extra > UINT64_MAX - (SHORT_RUN_MAX + 1))
+    {
+        throw std::runtime_error("Error: Run length overflows in RLE archive.");
+    }
+    return extra + SHORT_RUN_MAX + 1;
+}
 
 RLEGenome::RLEGenome() : metrics() {}
 
-bool RLEGenome::validateInputFile(const std::string &inputFilename) const
+bool RLEGenome::validateInputPath(const std::string &inputFilename) const
 {
-
     if (!FileValidator::hasTxtExtension(inputFilename))
     {
-        Logger::getInstance().log("Validation Error: File '" + inputFilename + "' does not have a .txt extension.");
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' does not have a .txt extension.");
         std::cerr << "Error: Unsupported file format. Only .txt files are allowed.\n";
         return false;
     }
 
     if (!FileValidator::fileExists(inputFilename))
     {
-        Logger::getInstance().log("Validation Error: File '" + inputFilename + "' does not exist.");
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' does not exist.");
         std::cerr << "Error: File does not exist.\n";
         return false;
     }
 
+    return true;
+}
+
+bool RLEGenome::validateInputFile(const std::string &inputFilename) const
+{
+    if (!validateInputPath(inputFilename))
+    {
+        return false;
+    }
+
     if (!FileValidator::hasValidGenomeData(inputFilename))
     {
-        Logger::getInstance().log("Validation Error: File '" + inputFilename + "' contains invalid characters.");
+        LOG_WARNING("Validation Error: File '" + inputFilename + "' contains invalid characters.");
         std::cerr << "Error: File contains invalid characters. Only A, C, G, T are allowed.\n";
         return false;
     }
@@ -38,206 +119,303 @@ bool RLEGenome::validateInputFile(const std::string &inputFilename) const
     return true;
 }
 
-void RLEGenome::encodeFromFile(const std::string &inputFilename, const std::string &outputFilename)
+void RLEGenome::reportInvalidBase(const std::string &inputFilename, size_t offset, char ch) const
 {
+    LOG_WARNING("Validation Error: File '" + inputFilename + "' has an invalid character at offset " +
+                              std::to_string(offset) + ".");
+    std::cerr << "Error: Invalid character '" << ch << "' at offset " << offset
+              << " in input file. Only A, C, G, T are allowed.\n";
+}
 
+bool RLEGenome::encodeTokens(const std::string &inputFilename, const TokenSink &sink, CaseMask *caseMask)
+{
     metrics = CompressionMetrics();
-
-    if (!validateInputFile(inputFilename))
+    CompressionMetrics::PhaseTimer timer;
+    if (!validateInputPath(inputFilename))
     {
-        Logger::getInstance().log("Encoding aborted due to input file validation failure.");
-        return;
+        return false;
     }
+    metrics.addPhase(CompressionMetrics::Phase::Validation, timer.seconds(), 0);
+    timer.restart();
 
-    Logger::getInstance().log("Compressing using Run Length encoding...");
+    // The whole input is mapped, so the run scan walks the page cache directly
+    MappedFile input(inputFilename);
 
-    std::ifstream infile(inputFilename, std::ios::binary);
-    if (!infile)
-    {
-        std::cerr << "Error: Unable to open input file '" << inputFilename << "'." << std::endl;
-        return;
-    }
-
-    std::ofstream outfile(outputFilename, std::ios::binary);
-    if (!outfile)
-    {
-        std::cerr << "Error: Unable to open output file '" << outputFilename << "'." << std::endl;
-        infile.close();
-        return;
-    }
+    std::vector<unsigned char> tokens;
+    tokens.reserve(OUTPUT_BUFFER_SIZE + 16);
 
-    char currentChar = '\0';
-    int count = 0;
-    char buffer[BUFFER_SIZE];
-    bool firstChar = true;
+    const char *bases = input.data();
+    const size_t size = input.size();
+    size_t validatedEnd = 0;
+    char runBase = 0; // lower-case folded, so 'A' and 'a' share a run
+    uint64_t runLength = 0;
+    std::vector<uint64_t> toggles;
+    uint64_t counts[4] = {0, 0, 0, 0};
 
-    while (infile.read(buffer, sizeof(buffer)) || infile.gcount())
+    size_t i = 0;
+    while (i < size)
     {
-        std::streamsize bytesRead = infile.gcount();
-        for (std::streamsize i = 0; i < bytesRead; ++i)
+        if (i == validatedEnd)
         {
-            char ch = buffer[i];
-
-            if (!(ch == 'A' || ch == 'C' || ch == 'G' || ch == 'T' || ch == 'a' || ch == 'c' || ch == 'g' || ch == 't'))
+            // Classify the next chunk just ahead of the run scan; a stray byte ends the valid range early.
+            // The same sweep collects case changes when the caller keeps a mask.
+            size_t chunk = std::min(SCAN_CHUNK, size - i);
+            if (caseMask)
             {
-                std::cerr << "Error: Invalid character '" << ch << "' in input file." << std::endl;
-                infile.close();
-                outfile.close();
-                return;
+                toggles.clear();
+                validatedEnd = i + BaseClassifier::countBases(bases + i, chunk, counts, toggles);
+                caseMask->addToggles(toggles, i);
             }
-
-            if (firstChar)
+            else
             {
-                currentChar = ch;
-                count = 1;
-                firstChar = false;
+                validatedEnd = i + BaseClassifier::findInvalid(bases + i, chunk);
             }
-            else if (ch == currentChar)
+            if (validatedEnd == i)
             {
-                count++;
-                if (count > (1 << COUNT_BITS) - 1)
-                {
-                    std::cerr << "Error: Run length too long for encoding." << std::endl;
-                    infile.close();
-                    outfile.close();
-                    return;
-                }
+                reportInvalidBase(inputFilename, i, bases[i]);
+                return false;
             }
-            else
+        }
+
+        char folded = static_cast<char>(bases[i] | 0x20);
+        if (folded != runBase)
+        {
+            if (runLength > 0)
             {
-                unsigned char charBits = 0;
-                switch (currentChar)
-                {
-                case 'A':
-                    charBits = 0b00;
-                    break;
-                case 'C':
-                    charBits = 0b01;
-                    break;
-                case 'G':
-                    charBits = 0b10;
-                    break;
-                case 'T':
-                    charBits = 0b11;
-                    break;
-                }
+                appendRun(tokens, baseCode(runBase), runLength);
+            }
+            runBase = folded;
+            runLength = 0;
+        }
 
-                outfile.put(charBits);
-                outfile.write(reinterpret_cast<char *>(&count), sizeof(count));
+        // A run may continue into the next chunk; it is only emitted once a different base shows up
+        size_t runEnd = i + 1;
+        while (runEnd < validatedEnd && static_cast<char>(bases[runEnd] | 0x20) == folded)
+        {
+            ++runEnd;
+        }
+        runLength += runEnd - i;
+        i = runEnd;
 
-                // Update metrics
-                metrics.addOriginalSize(count * 8);
-                metrics.addCompressedSize(2 + COUNT_BITS);
-                currentChar = ch;
-                count = 1;
-            }
+        if (tokens.size() >= OUTPUT_BUFFER_SIZE)
+        {
+            sink(std::move(tokens));
+            tokens.clear();
+            tokens.reserve(OUTPUT_BUFFER_SIZE + 16);
         }
     }
+    if (runLength > 0)
+    {
+        appendRun(tokens, baseCode(runBase), runLength);
+    }
+    if (!tokens.empty())
+    {
+        sink(std::move(tokens));
+    }
+
+    // Bases are validated just ahead of the run scan, and the sink writes as it goes
+    metrics.addPhase(CompressionMetrics::Phase::Encoding, timer.seconds(), size);
+    metrics.calculateOriginalSize(static_cast<long long>(size) * 8);
+    return true;
+}
 
-    if (!firstChar)
+uint64_t RLEGenome::decodeTokens(const unsigned char *tokens, size_t size, std::ostream &out, const CaseMask *caseMask,
+                                 uint64_t start)
+{
+    // Short runs are written as a fixed 64-byte fill and the cursor advances by the
+    // run length, so the buffer keeps SHORT_RUN_MAX + 1 bytes of slack past its end
+    std::vector<char> buffer(OUTPUT_BUFFER_SIZE + SHORT_RUN_MAX + 1);
+    size_t used = 0;
+    uint64_t written = 0;
+    auto flush = [&]()
     {
+        if (caseMask)
+        {
+            caseMask->apply(start + written, buffer.data(), used);
+        }
+        out.write(buffer.data(), static_cast<std::streamsize>(used));
+    };
 
-        unsigned char charBits = 0;
-        switch (currentChar)
+    size_t pos = 0;
+    while (pos < size)
+    {
+        unsigned char token = tokens[pos++];
+        char base = BASE_SYMBOLS[token >> 6];
+        uint64_t length = token & SHORT_RUN_MAX;
+
+        if (length != 0)
         {
-        case 'A':
-            charBits = 0b00;
-            break;
-        case 'C':
-            charBits = 0b01;
-            break;
-        case 'G':
-            charBits = 0b10;
-            break;
-        case 'T':
-            charBits = 0b11;
-            break;
+            std::memset(buffer.data() + used, base, SHORT_RUN_MAX + 1);
+            used += static_cast<size_t>(length);
         }
+        else
+        {
+            length = readLongRun(tokens, size, pos);
 
-        outfile.put(charBits);
-        outfile.write(reinterpret_cast<char *>(&count), sizeof(count));
+            while (length > 0)
+            {
+                size_t fill = static_cast<size_t>(std::min<uint64_t>(length, OUTPUT_BUFFER_SIZE - used));
+                if (fill == 0)
+                {
+                    flush();
+                    written += used;
+                    used = 0;
+                    continue;
+                }
+                std::memset(buffer.data() + used, base, fill);
+                used += fill;
+                length -= fill;
+            }
+        }
 
-        metrics.addOriginalSize(count * 8);
-        metrics.addCompressedSize(2 + COUNT_BITS); // Character bits + count bits
+        if (used >= OUTPUT_BUFFER_SIZE)
+        {
+            flush();
+            written += used;
+            used = 0;
+        }
     }
 
-    infile.close();
-    outfile.close();
-    std::cout << "Compression successful.\n Output file: " << outputFilename << "\n";
+    flush();
+    written += used;
+    return written;
 }
 
-void RLEGenome::decodeFromFile(const std::string &inputFilename, const std::string &outputFilename)
+uint64_t RLEGenome::countTokenBases(const unsigned char *tokens, size_t size)
 {
-
-    std::ifstream infile(inputFilename, std::ios::binary);
-    if (!infile)
+    uint64_t total = 0;
+    size_t pos = 0;
+    while (pos < size)
     {
-        std::cerr << "Error: Unable to open input file '" << inputFilename << "'." << std::endl;
-        return;
-    }
-
-    std::ofstream outfile(outputFilename, std::ios::binary);
-    if (!outfile)
-    {
-        std::cerr << "Error: Unable to open output file '" << outputFilename << "'." << std::endl;
-        infile.close();
-        return;
+        uint64_t length = tokens[pos++] & SHORT_RUN_MAX;
+        total += length != 0 ? length : readLongRun(tokens, size, pos);
     }
+    return total;
+}
 
-    while (!infile.eof())
+void RLEGenome::encodeFromFile(const std::string &inputFilename, const std::string &outputFilename)
+{
+    try
     {
-        unsigned char charBits;
-        int count;
+        metrics = CompressionMetrics();
 
-        // read the encoded char bits
-        infile.read(reinterpret_cast<char *>(&charBits), sizeof(charBits)); // casting
-        if (infile.gcount() != sizeof(charBits))
-            break; // incomplete file
+        LOG_INFO("Compressing using Run Length encoding...");
 
-        // record the count of consecutive characters
-        infile.read(reinterpret_cast<char *>(&count), sizeof(count));
-        if (infile.gcount() != sizeof(count))
+        std::ofstream outfile(outputFilename, std::ios::binary);
+        if (!outfile)
         {
-            std::cerr << "Error: Incomplete count in input file." << std::endl;
-            infile.close();
-            outfile.close();
-            return;
+            throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
         }
 
-        // decode to determine which nucleotide base
-        char currentChar;
-        if (charBits == 0b00)
-            currentChar = 'A';
-        else if (charBits == 0b01)
-            currentChar = 'C';
-        else if (charBits == 0b10)
-            currentChar = 'G';
-        else if (charBits == 0b11)
-            currentChar = 'T';
-        else
+        outfile.put(FORMAT_MAGIC);
+        outfile.put(FORMAT_VERSION);
+        uint64_t archiveBytes = 2;
+
+        CaseMask caseMask;
+        bool accepted = encodeTokens(inputFilename, [&](std::vector<unsigned char> &&tokens)
         {
-            std::cerr << "Error: Invalid character bits in input file." << std::endl;
-            infile.close();
-            outfile.close();
-            return;
+            outfile.write(reinterpret_cast<const char *>(tokens.data()), static_cast<std::streamsize>(tokens.size()));
+            archiveBytes += tokens.size();
+        }, &caseMask);
+        if (accepted)
+        {
+            std::vector<unsigned char> caseMaskBytes;
+            caseMask.serialize(caseMaskBytes);
+            outfile.write(reinterpret_cast<const char *>(caseMaskBytes.data()), static_cast<std::streamsize>(caseMaskBytes.size()));
+            BitIO::writeUInt(outfile, caseMaskBytes.size(), 8);
+            archiveBytes += caseMaskBytes.size(); // the size field is not payload
         }
 
-        if (count <= 0)
+        CompressionMetrics::PhaseTimer timer;
+        const uint64_t writtenBytes = static_cast<uint64_t>(outfile.tellp());
+        outfile.close();
+        metrics.addPhase(CompressionMetrics::Phase::Io, timer.seconds(), writtenBytes);
+        if (!accepted)
         {
-            std::cerr << "Error: Invalid count in input file." << std::endl;
-            infile.close();
-            outfile.close();
+            // Leave no partial archive behind
+            std::remove(outputFilename.c_str());
+            metrics = CompressionMetrics();
+            LOG_WARNING("Encoding aborted due to input file validation failure.");
             return;
         }
+        if (!outfile)
+        {
+            throw std::runtime_error("Error: Failed to write output file '" + outputFilename + "'.");
+        }
+
+        metrics.calculateCompressedSize(static_cast<long long>(archiveBytes) * 8);
 
-        // create a string of the repetitions of the decoded character and writ to file
-        std::string sequence(count, currentChar);
-        outfile.write(sequence.c_str(), count);
+        std::cout << "Compression successful.\n Output file: " << outputFilename << "\n";
     }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR(std::string("Exception during RLE encoding: ") + e.what());
+        // Leave no partial output behind, and let the caller see the failure
+        if (inputFilename != outputFilename)
+        {
+            std::remove(outputFilename.c_str());
+        }
+        throw CompressionException(e.what());
+    }
+}
+
+void RLEGenome::decodeFromFile(const std::string &inputFilename, const std::string &outputFilename)
+{
+    try
+    {
+        if (inputFilename == outputFilename)
+        {
+            throw std::runtime_error("Error: Output file must be different from input file to prevent overwriting.");
+        }
 
-    infile.close();
-    outfile.close();
-    std::cout << "Decompression successful.\n Output file: " << outputFilename << "\n";
+        MappedFile archive(inputFilename);
+        const unsigned char *bytes = archive.bytes();
+        if (archive.size() < 2 + CASE_MASK_SIZE_FIELD || bytes[0] != FORMAT_MAGIC || bytes[1] != FORMAT_VERSION)
+        {
+            throw std::runtime_error("Error: '" + inputFilename + "' is not an RLE archive.");
+        }
+        uint64_t caseMaskSize = BitIO::readUInt(bytes + archive.size() - CASE_MASK_SIZE_FIELD, 8);
+        if (caseMaskSize > archive.size() - 2 - CASE_MASK_SIZE_FIELD)
+        {
+            throw std::runtime_error("Error: Corrupt case mask in '" + inputFilename + "'.");
+        }
+        size_t tokenBytes = archive.size() - 2 - CASE_MASK_SIZE_FIELD - static_cast<size_t>(caseMaskSize);
+        CaseMask caseMask;
+        if (caseMaskSize > 0)
+        {
+            caseMask = CaseMask::parse(bytes + 2 + tokenBytes, static_cast<size_t>(caseMaskSize),
+                                       countTokenBases(bytes + 2, tokenBytes));
+        }
+
+        std::ofstream outfile(outputFilename, std::ios::binary);
+        if (!outfile)
+        {
+            throw std::runtime_error("Error: Unable to open output file '" + outputFilename + "'.");
+        }
+
+        CompressionMetrics::PhaseTimer timer;
+        uint64_t decodedBases = decodeTokens(bytes + 2, tokenBytes, outfile, &caseMask);
+        metrics.clearPhase(CompressionMetrics::Phase::Decoding);
+        metrics.addPhase(CompressionMetrics::Phase::Decoding, timer.seconds(), decodedBases);
+
+        outfile.close();
+        if (!outfile)
+        {
+            throw std::runtime_error("Error: Failed to write output file '" + outputFilename + "'.");
+        }
+
+        std::cout << "Decompression successful.\n Output file: " << outputFilename << "\n";
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR(std::string("Exception during RLE decoding: ") + e.what());
+        // Leave no partial output behind, and let the caller see the failure
+        if (inputFilename != outputFilename)
+        {
+            std::remove(outputFilename.c_str());
+        }
+        throw CompressionException(e.what());
+    }
 }
 
 CompressionMetrics RLEGenome::getMetrics() const
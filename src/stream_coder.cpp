@@ -0,0 +1,271 @@
+#include "StreamCoder.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "BitIO.h"
+
+// Stream layout (version 2): magic, version, u8 method name length, method name, then
+// frames of u64 size, u8 flags and one complete codec archive each, ended by a zero size.
+// The end marker tells a finished stream from one cut off in the pipe.
+// Flags: bit 0 set when a FASTA frame continues the last record of the frame before it;
+// its archive then starts with a stand-in header line that is not part of the output.
+const char FORMAT_MAGIC = 'S';
+const char FORMAT_VERSION = 2;
+const size_t FRAME_SIZE_FIELD = 8;
+const size_t FRAME_FLAGS_SIZE = 1;
+const unsigned char FRAME_CONTINUES = 0x01;
+const size_t READ_BUFFER_SIZE = 1024 * 1024;
+
+const char *const StreamCoder::FASTA_METHOD = "fasta";
+
+namespace
+{
+    // Passes everything after the first line end through to `out`
+    class SkipFirstLine : public std::streambuf
+    {
+    public:
+        explicit SkipFirstLine(std::ostream &out) : out(out), skipping(true) {}
+
+    protected:
+        int overflow(int ch) override
+        {
+            if (ch == EOF)
+            {
+                return 0;
+            }
+            char c = static_cast<char>(ch);
+            return xsputn(&c, 1) == 1 ? ch : EOF;
+        }
+
+        std::streamsize xsputn(const char *data, std::streamsize count) override
+        {
+            std::streamsize from = 0;
+            if (skipping)
+            {
+                const char *found = static_cast<const char *>(std::memchr(data, '\n', static_cast<size_t>(count)));
+                if (!found)
+                {
+                    return count;
+                }
+                skipping = false;
+                from = found - data + 1;
+            }
+            out.write(data + from, count - from);
+            return out ? count : 0;
+        }
+
+    private:
+        std::ostream &out;
+        bool skipping;
+    };
+}
+
+StreamCoder::StreamCoder(Compressor &codec, const std::string &method, size_t chunkSize)
+    : codec(codec), method(method), chunkSize(std::max<size_t>(chunkSize, 1)), out(nullptr), sourceName(),
+      buffer(), fasta(method == FASTA_METHOD), lineEnd(), searched(0), inputBytes(0), outputBytes(0), metrics()
+{
+    if (!codec.supportsSequenceCoding())
+    {
+        throw std::runtime_error("Error: Method '" + method + "' cannot stream. Use huffmangenome, pack2 or cm.");
+    }
+}
+
+void StreamCoder::begin(std::ostream &output, const std::string &name)
+{
+    out = &output;
+    sourceName = name;
+    buffer.clear();
+    lineEnd.clear();
+    searched = 0;
+    inputBytes = 0;
+    outputBytes = 2 + 1 + method.size();
+    metrics = CompressionMetrics();
+
+    out->put(FORMAT_MAGIC);
+    out->put(FORMAT_VERSION);
+    out->put(static_cast<char>(method.size()));
+    out->write(method.data(), static_cast<std::streamsize>(method.size()));
+}
+
+bool StreamCoder::feed(const char *data, size_t size)
+{
+    buffer.append(data, size);
+    if (fasta && lineEnd.empty())
+    {
+        size_t at = buffer.find('\n');
+        if (at != std::string::npos)
+        {
+            lineEnd = at > 0 && buffer[at - 1] == '\r' ? "\r\n" : "\n";
+        }
+    }
+    while (buffer.size() >= chunkSize)
+    {
+        size_t cut = chunkSize;
+        if (fasta)
+        {
+            // Cut after the first line end at or past the chunk size
+            size_t at = buffer.find('\n', std::max(searched, chunkSize - 1));
+            if (at != std::string::npos)
+            {
+                cut = at + 1;
+            }
+            else
+            {
+                searched = buffer.size();
+                if (buffer.size() < 2 * chunkSize)
+                {
+                    break;
+                }
+                // A line of two chunks is cut at the chunk size, which only a sequence line allows
+                size_t lineStart = buffer.rfind('\n', chunkSize - 1);
+                lineStart = lineStart == std::string::npos ? 0 : lineStart + 1;
+                if (buffer[lineStart] == '>')
+                {
+                    throw std::runtime_error("Error: A header line in '" + sourceName + "' is longer than " +
+                                             std::to_string(2 * chunkSize) + " bytes and cannot be streamed.");
+                }
+                if (buffer[cut - 1] == '\r' && cut - 1 > lineStart)
+                {
+                    --cut;
+                }
+            }
+        }
+        if (!writeFrame(cut))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StreamCoder::finish()
+{
+    if (!buffer.empty() && !writeFrame(buffer.size()))
+    {
+        return false;
+    }
+    CompressionMetrics::PhaseTimer timer;
+    BitIO::writeUInt(*out, 0, FRAME_SIZE_FIELD);
+    outputBytes += FRAME_SIZE_FIELD;
+    out->flush();
+    metrics.addPhase(CompressionMetrics::Phase::Io, timer.seconds(), FRAME_SIZE_FIELD);
+
+    metrics.calculateOriginalSize(static_cast<long long>(inputBytes) * 8);
+    metrics.calculateCompressedSize(static_cast<long long>(outputBytes) * 8);
+    return static_cast<bool>(*out);
+}
+
+bool StreamCoder::writeFrame(size_t size)
+{
+    // Every FASTA archive starts with a header line, so a frame inside a record borrows one
+    const bool continues = fasta && inputBytes > 0 && buffer[0] != '>';
+    std::ostringstream frame;
+    bool accepted;
+    if (continues)
+    {
+        const std::string text = ">" + lineEnd + buffer.substr(0, size);
+        accepted = codec.encodeSequence(text.data(), text.size(), frame, sourceName);
+    }
+    else
+    {
+        accepted = codec.encodeSequence(buffer.data(), size, frame, sourceName);
+    }
+    if (!accepted)
+    {
+        return false;
+    }
+    metrics.addPhases(codec.getMetrics());
+    const std::string bytes = frame.str();
+    CompressionMetrics::PhaseTimer timer;
+    BitIO::writeUInt(*out, bytes.size(), FRAME_SIZE_FIELD);
+    out->put(static_cast<char>(continues ? FRAME_CONTINUES : 0));
+    out->write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    const uint64_t frameBytes = FRAME_SIZE_FIELD + FRAME_FLAGS_SIZE + bytes.size();
+    metrics.addPhase(CompressionMetrics::Phase::Io, timer.seconds(), frameBytes);
+    inputBytes += size;
+    outputBytes += frameBytes;
+    buffer.erase(0, size);
+    searched = 0;
+    return true;
+}
+
+CompressionMetrics StreamCoder::getMetrics() const
+{
+    return metrics;
+}
+
+std::string StreamCoder::readHeader(std::istream &in)
+{
+    char magic[2];
+    if (!in.read(magic, 2) || magic[0] != FORMAT_MAGIC || magic[1] != FORMAT_VERSION)
+    {
+        throw std::runtime_error("Error: Input is not a stream archive.");
+    }
+    size_t length = static_cast<size_t>(BitIO::readUInt(in, 1));
+    std::string name(length, '\0');
+    if (!in.read(&name[0], static_cast<std::streamsize>(length)))
+    {
+        throw std::runtime_error("Error: Unexpected end of archive header.");
+    }
+    return name;
+}
+
+CompressionMetrics StreamCoder::decodeFrames(Compressor &codec, std::istream &in, std::ostream &out)
+{
+    CompressionMetrics metrics;
+    std::vector<unsigned char> frame;
+    for (;;)
+    {
+        uint64_t size = BitIO::readUInt(in, FRAME_SIZE_FIELD);
+        if (size == 0)
+        {
+            break;
+        }
+        const int flags = in.get();
+        if (flags == EOF)
+        {
+            throw std::runtime_error("Error: Stream archive is truncated.");
+        }
+        if ((flags & ~FRAME_CONTINUES) != 0)
+        {
+            throw std::runtime_error("Error: Unknown frame flags in stream archive.");
+        }
+
+        // Grow as the bytes arrive, so a corrupt size fails on the missing data instead of the allocation
+        frame.clear();
+        while (frame.size() < size)
+        {
+            size_t piece = static_cast<size_t>(std::min<uint64_t>(size - frame.size(), READ_BUFFER_SIZE));
+            size_t at = frame.size();
+            frame.resize(at + piece);
+            if (!in.read(reinterpret_cast<char *>(frame.data() + at), static_cast<std::streamsize>(piece)))
+            {
+                throw std::runtime_error("Error: Stream archive is truncated.");
+            }
+        }
+        if (flags & FRAME_CONTINUES)
+        {
+            SkipFirstLine rest(out);
+            std::ostream restStream(&rest);
+            codec.decodeSequence(frame.data(), frame.size(), restStream);
+        }
+        else
+        {
+            codec.decodeSequence(frame.data(), frame.size(), out);
+        }
+        // Each frame replaces the codec's decoding phase, so the frames are summed here
+        metrics.addPhases(codec.getMetrics());
+    }
+    out.flush();
+    return metrics;
+}
+
+bool StreamCoder::isStreamArchive(const std::string &filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    char magic[2];
+    return in.read(magic, 2) && magic[0] == FORMAT_MAGIC && magic[1] == FORMAT_VERSION;
+}
@@ -0,0 +1,92 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threads)
+    : threadCount(threads == 0 ? 1 : threads), stopping(false)
+{
+    if (threadCount > 1)
+    {
+        workers.reserve(threadCount);
+        for (unsigned int i = 0; i < threadCount; ++i)
+        {
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+unsigned int ThreadPool::defaultThreadCount()
+{
+    unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware == 0 ? 1 : hardware;
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty())
+            {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)> &body)
+{
+    if (workers.empty() || count <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            body(i);
+        }
+        return;
+    }
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        pending.push_back(submit([&body, i]() { body(i); }));
+    }
+
+    // Wait for every task before rethrowing so none is left referencing `body`
+    std::exception_ptr firstError;
+    for (auto &task : pending)
+    {
+        try
+        {
+            task.get();
+        }
+        catch (...)
+        {
+            if (!firstError)
+            {
+                firstError = std::current_exception();
+            }
+        }
+    }
+    if (firstError)
+    {
+        std::rethrow_exception(firstError);
+    }
+}
@@ -165,3 +165,73 @@ TEST_F(SuppressOutputRLECompressionTest, ValidateDecodedFile)
     std::remove(compressedFile.c_str());
     std::remove(decompressedFile.c_str());
 }
+
+TEST_F(SuppressOutputRLECompressionTest, EncodeRejectsInvalidCharacter)
+{
+    RLEGenome genome;
+
+    std::string inputFile = "test_input.txt";
+    std::ofstream input(inputFile);
+    input << std::string(60000, 'A') << "CCGT" << "X" << "ACGT";
+    input.close();
+
+    std::string outputFile = "test_output.rle";
+
+    // Validation happens during the run scan and leaves no partial archive behind
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, outputFile));
+    EXPECT_FALSE(std::ifstream(outputFile).good());
+
+    std::remove(inputFile.c_str());
+}
+
+TEST_F(SuppressOutputRLECompressionTest, LongRunsRoundTrip)
+{
+    RLEGenome genome;
+
+    // Runs on both sides of the 63-base token limit, and one far past the old 65535 cap
+    std::string expected = "A" + std::string(63, 'C') + std::string(64, 'G') + std::string(200000, 'T') + "ACGT";
+    std::string inputFile = "test_input.txt";
+    std::ofstream input(inputFile);
+    input << expected;
+    input.close();
+
+    std::string compressedFile = "test_output.rle";
+    std::string decompressedFile = "test_decoded.txt";
+
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+    EXPECT_NO_THROW(genome.decodeFromFile(compressedFile, decompressedFile));
+
+    std::ifstream decompressed(decompressedFile);
+    std::ostringstream content;
+    content << decompressed.rdbuf();
+    EXPECT_EQ(content.str(), expected);
+
+    // Magic and version, one token per short run, a 3-byte escape for the long run,
+    // and the size field of the empty case mask
+    std::ifstream compressed(compressedFile, std::ios::binary | std::ios::ate);
+    EXPECT_EQ(static_cast<long>(compressed.tellg()), 2 + 1 + 1 + 2 + 4 + 4 + 8);
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputRLECompressionTest, SoftMaskedRoundTrip)
+{
+    RLEGenome genome;
+
+    // Case changes inside runs, at run edges, and a lower-case run across the chunk size
+    std::string expected = "AAaaCCccGT" + std::string(1024 * 1024 + 100, 'a') + "ACGTacgt" + std::string(70, 'T') + "t";
+    std::string inputFile = "test_input.txt";
+    std::ofstream(inputFile, std::ios::binary) << expected;
+    std::string compressedFile = "test_output.rle";
+    std::string decompressedFile = "test_decoded.txt";
+
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+    EXPECT_NO_THROW(genome.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(genome.validateDecodedFile(inputFile, decompressedFile));
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
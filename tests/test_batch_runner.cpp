@@ -0,0 +1,172 @@
+// BatchRunnerTest.cpp
+#include <gtest/gtest.h>
+#include "../include/BatchRunner.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <logger.h>
+
+namespace fs = std::filesystem;
+
+// Encapsulate the Test Fixture in an Anonymous Namespace
+namespace {
+    class SuppressOutputBatchRunnerTest : public ::testing::Test {
+    protected:
+        std::streambuf* original_cout;
+        std::streambuf* original_cerr;
+        std::ofstream null_stream;
+
+        void SetUp() override {
+            // Disable logging before any test code runs
+            Logger::getInstance().enableLogging(false);
+
+            // Open the null device based on the operating system
+        #ifdef _WIN32
+            null_stream.open("nul");
+        #else
+            null_stream.open("/dev/null");
+        #endif
+            if (!null_stream.is_open()) {
+                FAIL() << "Failed to open null device for output suppression.";
+            }
+
+            // Redirect std::cout and std::cerr to the null device
+            original_cout = std::cout.rdbuf(null_stream.rdbuf());
+            original_cerr = std::cerr.rdbuf(null_stream.rdbuf());
+        }
+
+        void TearDown() override {
+            // Restore the original buffers
+            std::cout.rdbuf(original_cout);
+            std::cerr.rdbuf(original_cerr);
+
+            // Close the null device
+            null_stream.close();
+        }
+    };
+
+    std::string randomBases(size_t length, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        const char bases[] = {'A', 'C', 'G', 'T'};
+        std::string sequence(length, 'A');
+        for (auto &ch : sequence) {
+            ch = bases[rng() % 4];
+        }
+        return sequence;
+    }
+
+    std::string readFile(const std::string &filename)
+    {
+        std::ifstream in(filename, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+}
+
+TEST_F(SuppressOutputBatchRunnerTest, ExpandsDirectoryGlobAndManifest)
+{
+    fs::remove_all("batch_inputs");
+    fs::create_directories("batch_inputs");
+    for (const std::string name : {"a.txt", "b.txt", "c.fa", "b.txt.pack2"}) {
+        std::ofstream("batch_inputs/" + name) << "ACGT";
+    }
+    std::ofstream("batch_manifest.list") << "# samples\nbatch_inputs/c.fa\n\n  batch_inputs/a.txt \r\n";
+
+    EXPECT_EQ(BatchRunner::expandInputs("batch_inputs").size(), 4u);
+    EXPECT_EQ(BatchRunner::expandInputs("batch_inputs", ".pack2"),
+              std::vector<std::string>({"batch_inputs/b.txt.pack2"}));
+    EXPECT_EQ(BatchRunner::expandInputs("batch_inputs/?.txt"),
+              std::vector<std::string>({"batch_inputs/a.txt", "batch_inputs/b.txt"}));
+    EXPECT_EQ(BatchRunner::expandInputs("batch_manifest.list"),
+              std::vector<std::string>({"batch_inputs/c.fa", "batch_inputs/a.txt"}));
+    EXPECT_THROW(BatchRunner::expandInputs("batch_inputs/*.gz"), std::runtime_error);
+    EXPECT_THROW(BatchRunner::expandInputs("no_such_batch_input"), std::runtime_error);
+
+    fs::remove_all("batch_inputs");
+    std::remove("batch_manifest.list");
+}
+
+TEST_F(SuppressOutputBatchRunnerTest, RoundTripWithReport)
+{
+    fs::remove_all("batch_inputs");
+    fs::remove_all("batch_archives");
+    fs::remove_all("batch_decoded");
+    fs::create_directories("batch_inputs");
+    std::vector<std::string> inputs;
+    for (int i = 0; i < 6; ++i) {
+        std::string name = "batch_inputs/sample" + std::to_string(i) + ".txt";
+        std::ofstream(name) << randomBases(1000 + 7000 * static_cast<size_t>(i % 3), static_cast<unsigned>(i));
+        inputs.push_back(name);
+    }
+    std::ofstream("batch_inputs/record.fa") << ">r1\nACGTNN\nAC\n";
+    inputs.push_back("batch_inputs/record.fa");
+    std::ofstream("batch_inputs/bad.txt") << "ACGTXX";
+    inputs.push_back("batch_inputs/bad.txt");
+
+    BatchRunner compress(BatchRunner::Mode::Compress, "pack2", "batch_archives");
+    compress.setThreadCount(3);
+    std::vector<BatchRunner::Job> jobs = compress.run(inputs);
+    ASSERT_EQ(jobs.size(), inputs.size());
+    for (size_t i = 0; i + 1 < jobs.size(); ++i) {
+        EXPECT_TRUE(jobs[i].succeeded) << jobs[i].input;
+        EXPECT_GT(jobs[i].metrics.getCompressedSize(), 0);
+    }
+    EXPECT_FALSE(jobs.back().succeeded);
+    EXPECT_FALSE(fs::exists("batch_archives/bad.txt.pack2"));
+
+    std::ostringstream report;
+    BatchRunner::writeReport(jobs, compress.getWallSeconds(), report);
+    std::string text = report.str();
+    EXPECT_EQ(std::count(text.begin(), text.end(), '\n'), static_cast<long>(inputs.size() + 2));
+    EXPECT_NE(text.find("total\t7/8 files\tfailed"), std::string::npos);
+
+    BatchRunner decompress(BatchRunner::Mode::Decompress, "pack2", "batch_decoded");
+    jobs = decompress.run(BatchRunner::expandInputs("batch_archives", ".pack2"));
+    ASSERT_EQ(jobs.size(), inputs.size() - 1);
+    for (const BatchRunner::Job &job : jobs) {
+        EXPECT_TRUE(job.succeeded) << job.input;
+        EXPECT_TRUE(job.metrics.hasPhase(CompressionMetrics::Phase::Decoding)) << job.input;
+        std::string name = fs::path(job.output).filename().string();
+        EXPECT_EQ(readFile(job.output), readFile("batch_inputs/" + name));
+    }
+
+    fs::remove_all("batch_inputs");
+    fs::remove_all("batch_archives");
+    fs::remove_all("batch_decoded");
+}
+
+TEST_F(SuppressOutputBatchRunnerTest, TruncatedArchiveFailsItsJob)
+{
+    fs::remove_all("batch_inputs");
+    fs::remove_all("batch_archives");
+    fs::remove_all("batch_decoded");
+    fs::create_directories("batch_inputs");
+    std::ofstream("batch_inputs/good.txt") << randomBases(5000, 1);
+    std::ofstream("batch_inputs/cut.txt") << randomBases(5000, 2);
+
+    // A codec without in-memory coding decodes through decodeFromFile
+    BatchRunner compress(BatchRunner::Mode::Compress, "huffman", "batch_archives");
+    std::vector<BatchRunner::Job> jobs = compress.run(BatchRunner::expandInputs("batch_inputs"));
+    ASSERT_EQ(jobs.size(), 2u);
+    std::string archive = readFile("batch_archives/cut.txt.huffman");
+    std::ofstream("batch_archives/cut.txt.huffman", std::ios::binary) << archive.substr(0, 10);
+
+    BatchRunner decompress(BatchRunner::Mode::Decompress, "huffman", "batch_decoded");
+    jobs = decompress.run(BatchRunner::expandInputs("batch_archives", ".huffman"));
+    ASSERT_EQ(jobs.size(), 2u);
+    EXPECT_FALSE(jobs[0].succeeded) << jobs[0].input;
+    EXPECT_FALSE(fs::exists("batch_decoded/cut.txt"));
+    EXPECT_TRUE(jobs[1].succeeded) << jobs[1].input;
+    EXPECT_EQ(readFile("batch_decoded/good.txt"), readFile("batch_inputs/good.txt"));
+
+    std::ostringstream report;
+    BatchRunner::writeReport(jobs, decompress.getWallSeconds(), report);
+    EXPECT_NE(report.str().find("total\t1/2 files\tfailed"), std::string::npos);
+    EXPECT_GE(decompress.getWallSeconds(), std::max(jobs[0].seconds, jobs[1].seconds));
+
+    fs::remove_all("batch_inputs");
+    fs::remove_all("batch_archives");
+    fs::remove_all("batch_decoded");
+}
@@ -156,3 +156,144 @@ TEST_F(SuppressOutputCombinedCompressorTest, ValidateDecodedFileLarge)
     std::remove(compressedFile.c_str());
     std::remove(decompressedFile.c_str());
 }
+
+TEST_F(SuppressOutputCombinedCompressorTest, MultiBlockRoundTripWithoutTempFiles)
+{
+    CombinedCompressor compressor;
+
+    // Enough random runs for several ~1 MB token chunks, so the pipeline queue cycles
+    std::string inputFile = "large_test_input.txt";
+    {
+        std::mt19937 rng(7);
+        const char bases[] = {'A', 'C', 'G', 'T'};
+        std::ofstream file(inputFile);
+        for (int i = 0; i < 3000000; ++i)
+        {
+            file << bases[rng() % 4];
+        }
+    }
+    std::string compressedFile = "large_test_output.combined";
+    std::string decompressedFile = "large_test_decoded.txt";
+
+    EXPECT_NO_THROW(compressor.encodeFromFile(inputFile, compressedFile));
+    EXPECT_NO_THROW(compressor.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(compressor.validateDecodedFile(inputFile, decompressedFile));
+
+    // The stages talk through memory, not the working directory
+    EXPECT_FALSE(std::ifstream("temp_rle_output.bin").good());
+    EXPECT_FALSE(std::ifstream("temp_rle_decoded.bin").good());
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputCombinedCompressorTest, InvalidInputLeavesNoArchive)
+{
+    CombinedCompressor compressor;
+
+    std::string inputFile = "invalid_test_input.txt";
+    std::ofstream(inputFile) << "ACGTACGTNNACGT";
+    std::string outputFile = "invalid_test_output.combined";
+
+    EXPECT_NO_THROW(compressor.encodeFromFile(inputFile, outputFile));
+    EXPECT_FALSE(std::ifstream(outputFile).good());
+
+    std::remove(inputFile.c_str());
+}
+
+TEST_F(SuppressOutputCombinedCompressorTest, RansRoundTrip)
+{
+    CombinedCompressor compressor;
+    compressor.setEntropyCoder(EntropyCoder::Rans);
+
+    std::string inputFile = "rans_test_input.txt";
+    {
+        std::mt19937 rng(11);
+        const char bases[] = {'A', 'C', 'G', 'T'};
+        std::ofstream file(inputFile);
+        for (int i = 0; i < 200000; ++i)
+        {
+            file << std::string(1 + rng() % 5, bases[rng() % 4]);
+        }
+    }
+    std::string compressedFile = "rans_test_output.combined";
+    std::string decompressedFile = "rans_test_decoded.txt";
+
+    EXPECT_NO_THROW(compressor.encodeFromFile(inputFile, compressedFile));
+
+    CombinedCompressor decoder;
+    EXPECT_NO_THROW(decoder.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile));
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputCombinedCompressorTest, DecodeRangeAcrossBlocks)
+{
+    // Runs of 1-5 bases fill several ~1 MB token blocks
+    std::string bases;
+    {
+        std::mt19937 rng(3);
+        const char symbols[] = {'A', 'C', 'G', 'T'};
+        while (bases.size() < 4000000)
+        {
+            bases += std::string(1 + rng() % 5, symbols[rng() % 4]);
+        }
+    }
+    std::string inputFile = "range_test_input.txt";
+    std::ofstream(inputFile) << bases;
+    std::string compressedFile = "range_test_output.combined";
+
+    CombinedCompressor compressor;
+    EXPECT_NO_THROW(compressor.encodeFromFile(inputFile, compressedFile));
+
+    CombinedCompressor reader;
+    EXPECT_EQ(reader.decodeRange(compressedFile, 0, 10), bases.substr(0, 10));
+    EXPECT_EQ(reader.decodeRange(compressedFile, 1000000, 1000), bases.substr(1000000, 1000));
+    EXPECT_EQ(reader.decodeRange(compressedFile, 2500000, 1200000), bases.substr(2500000, 1200000));
+    EXPECT_EQ(reader.decodeRange(compressedFile, bases.size() - 5, 100), bases.substr(bases.size() - 5));
+    EXPECT_THROW(reader.decodeRange(compressedFile, bases.size() + 1, 1), std::out_of_range);
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+}
+
+TEST_F(SuppressOutputCombinedCompressorTest, SoftMaskedRoundTrip)
+{
+    // Lower-case stretches inside runs, at run edges, and across the ~1 MB token blocks
+    std::string bases;
+    {
+        std::mt19937 rng(5);
+        const char symbols[] = {'A', 'C', 'G', 'T', 'a', 'c', 'g', 't'};
+        while (bases.size() < 3000000)
+        {
+            bases += std::string(1 + rng() % 5, symbols[(rng() % 4) + (bases.size() / 100000 % 2) * 4]);
+        }
+        bases += "AAaaCCccGt";
+    }
+    std::string inputFile = "softmask_test_input.txt";
+    std::ofstream(inputFile, std::ios::binary) << bases;
+    std::string compressedFile = "softmask_test_output.combined";
+    std::string decompressedFile = "softmask_test_decoded.txt";
+
+    for (EntropyCoder coder : {EntropyCoder::Huffman, EntropyCoder::Rans})
+    {
+        CombinedCompressor compressor;
+        compressor.setEntropyCoder(coder);
+        EXPECT_NO_THROW(compressor.encodeFromFile(inputFile, compressedFile));
+
+        CombinedCompressor decoder;
+        EXPECT_NO_THROW(decoder.decodeFromFile(compressedFile, decompressedFile));
+        EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile));
+        EXPECT_EQ(decoder.decodeRange(compressedFile, 99990, 20), bases.substr(99990, 20));
+        EXPECT_EQ(decoder.decodeRange(compressedFile, 1500000, 1200000), bases.substr(1500000, 1200000));
+        EXPECT_EQ(decoder.decodeRange(compressedFile, bases.size() - 8, 100), "aaCCccGt");
+    }
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
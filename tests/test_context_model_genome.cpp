@@ -0,0 +1,223 @@
+// ContextModelGenomeTest.cpp
+#include <gtest/gtest.h>
+#include "../include/ContextModelGenome.h"
+#include "../include/CompressionException.h"
+#include <fstream>
+#include <cctype>
+#include <random>
+#include <vector>
+#include <logger.h>
+
+// Encapsulate the Test Fixture in an Anonymous Namespace
+namespace {
+    class SuppressOutputContextModelGenomeTest : public ::testing::Test {
+    protected:
+        std::streambuf* original_cout;
+        std::streambuf* original_cerr;
+        std::ofstream null_stream;
+
+        void SetUp() override {
+            // Disable logging before any test code runs
+            Logger::getInstance().enableLogging(false);
+
+            // Open the null device based on the operating system
+        #ifdef _WIN32
+            null_stream.open("nul");
+        #else
+            null_stream.open("/dev/null");
+        #endif
+            if (!null_stream.is_open()) {
+                FAIL() << "Failed to open null device for output suppression.";
+            }
+
+            // Redirect std::cout and std::cerr to the null device
+            original_cout = std::cout.rdbuf(null_stream.rdbuf());
+            original_cerr = std::cerr.rdbuf(null_stream.rdbuf());
+        }
+
+        void TearDown() override {
+            // Restore the original buffers
+            std::cout.rdbuf(original_cout);
+            std::cerr.rdbuf(original_cerr);
+
+            // Close the null device
+            null_stream.close();
+        }
+    };
+
+    std::string randomBases(size_t length, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        const char bases[] = {'A', 'C', 'G', 'T'};
+        std::string sequence(length, 'A');
+        for (auto &ch : sequence) {
+            ch = bases[rng() % 4];
+        }
+        return sequence;
+    }
+
+    void writeFile(const std::string &filename, const std::string &content)
+    {
+        std::ofstream out(filename, std::ios::binary);
+        out << content;
+    }
+}
+
+TEST_F(SuppressOutputContextModelGenomeTest, Constructor)
+{
+    ContextModelGenome genome;
+    EXPECT_EQ(genome.getContextOrder(), ContextModelGenome::DEFAULT_ORDER);
+}
+
+TEST_F(SuppressOutputContextModelGenomeTest, RejectsOrderOutOfRange)
+{
+    ContextModelGenome genome;
+    EXPECT_THROW(genome.setContextOrder(0), std::invalid_argument);
+    EXPECT_THROW(genome.setContextOrder(ContextModelGenome::MAX_ORDER + 1), std::invalid_argument);
+    EXPECT_NO_THROW(genome.setContextOrder(11));
+    EXPECT_EQ(genome.getContextOrder(), 11);
+}
+
+TEST_F(SuppressOutputContextModelGenomeTest, EncodeDecodeFromFile)
+{
+    std::string inputFile = "test_input.txt";
+    std::string compressedFile = "test_output.cm";
+    std::string decompressedFile = "test_decoded.txt";
+    writeFile(inputFile, randomBases(50001, 42));
+
+    // Direct tables only, then hashed high orders
+    for (int order : {3, 11, 16}) {
+        ContextModelGenome genome;
+        genome.setContextOrder(order);
+        EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+
+        // The decoder takes the order from the archive, not from its own setting
+        ContextModelGenome decoder;
+        EXPECT_NO_THROW(decoder.decodeFromFile(compressedFile, decompressedFile));
+        EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile)) << "order " << order;
+    }
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputContextModelGenomeTest, RepeatsCompressBelowTwoBitsPerBase)
+{
+    ContextModelGenome genome;
+
+    // The same 20 kb segment three times: the high orders should pick up the copies
+    std::string segment = randomBases(20000, 7);
+    std::string inputFile = "test_input.txt";
+    std::string compressedFile = "test_output.cm";
+    std::string decompressedFile = "test_decoded.txt";
+    writeFile(inputFile, segment + segment + segment);
+
+    genome.encodeFromFile(inputFile, compressedFile);
+    genome.decodeFromFile(compressedFile, decompressedFile);
+    EXPECT_TRUE(genome.validateDecodedFile(inputFile, decompressedFile));
+
+    CompressionMetrics metrics = genome.getMetrics();
+    EXPECT_EQ(metrics.getOriginalSize(), 60000LL * 8);
+    EXPECT_LT(metrics.getCompressedSize(), 60000LL * 1);
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputContextModelGenomeTest, EmptyInputRoundTrip)
+{
+    ContextModelGenome genome;
+
+    std::string inputFile = "test_input.txt";
+    std::string compressedFile = "test_output.cm";
+    std::string decompressedFile = "test_decoded.txt";
+    writeFile(inputFile, "");
+
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+    EXPECT_NO_THROW(genome.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(genome.validateDecodedFile(inputFile, decompressedFile));
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputContextModelGenomeTest, AmbiguityCodesRoundTrip)
+{
+    std::string inputFile = "test_input.txt";
+    std::string compressedFile = "test_output.cm";
+    std::string decompressedFile = "test_decoded.txt";
+    writeFile(inputFile, "NN" + randomBases(3000, 4) + std::string(100000, 'N') + "RY" + randomBases(3000, 5) + "n");
+
+    ContextModelGenome genome;
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+    EXPECT_LT(genome.getMetrics().getCompressedSize(), 6000LL * 2 + 400);
+    EXPECT_NO_THROW(genome.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(genome.validateDecodedFile(inputFile, decompressedFile));
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputContextModelGenomeTest, InvalidInputLeavesNoArchive)
+{
+    ContextModelGenome genome;
+
+    std::string inputFile = "test_input.txt";
+    std::string compressedFile = "test_output.cm";
+    writeFile(inputFile, "ACGTACGTXACGT");
+
+    genome.encodeFromFile(inputFile, compressedFile);
+    std::ifstream archive(compressedFile);
+    EXPECT_FALSE(archive.good());
+
+    std::remove(inputFile.c_str());
+}
+
+TEST_F(SuppressOutputContextModelGenomeTest, TruncatedArchiveIsRejected)
+{
+    ContextModelGenome genome;
+
+    std::string inputFile = "test_input.txt";
+    std::string compressedFile = "test_output.cm";
+    std::string decompressedFile = "test_decoded.txt";
+    writeFile(inputFile, randomBases(20000, 3));
+    genome.encodeFromFile(inputFile, compressedFile);
+
+    std::ifstream in(compressedFile, std::ios::binary);
+    std::string archive((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    writeFile(compressedFile, archive.substr(0, archive.size() / 2));
+
+    EXPECT_THROW(genome.decodeFromFile(compressedFile, decompressedFile), CompressionException);
+    EXPECT_FALSE(std::ifstream(decompressedFile).good());
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputContextModelGenomeTest, SoftMaskedRoundTrip)
+{
+    std::string inputFile = "test_input.txt";
+    std::string compressedFile = "test_output.cm";
+    std::string decompressedFile = "test_decoded.txt";
+    std::string bases = randomBases(3000, 6);
+    for (auto &ch : bases) {
+        ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    }
+    std::string text = "acgt" + randomBases(3000, 7) + bases + "NNnn" + bases.substr(0, 10) + "A";
+    writeFile(inputFile, text);
+
+    ContextModelGenome genome;
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+    EXPECT_NO_THROW(genome.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(genome.validateDecodedFile(inputFile, decompressedFile));
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
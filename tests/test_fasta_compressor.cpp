@@ -0,0 +1,251 @@
+// FastaCompressorTest.cpp
+#include <gtest/gtest.h>
+#include "../include/FastaCompressor.h"
+#include "../include/CompressionException.h"
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <logger.h>
+
+// Encapsulate the Test Fixture in an Anonymous Namespace
+namespace {
+    class SuppressOutputFastaCompressorTest : public ::testing::Test {
+    protected:
+        std::streambuf* original_cout;
+        std::streambuf* original_cerr;
+        std::ofstream null_stream;
+
+        void SetUp() override {
+            // Disable logging before any test code runs
+            Logger::getInstance().enableLogging(false);
+
+            // Open the null device based on the operating system
+        #ifdef _WIN32
+            null_stream.open("nul");
+        #else
+            null_stream.open("/dev/null");
+        #endif
+            if (!null_stream.is_open()) {
+                FAIL() << "Failed to open null device for output suppression.";
+            }
+
+            // Redirect std::cout and std::cerr to the null device
+            original_cout = std::cout.rdbuf(null_stream.rdbuf());
+            original_cerr = std::cerr.rdbuf(null_stream.rdbuf());
+        }
+
+        void TearDown() override {
+            // Restore the original buffers
+            std::cout.rdbuf(original_cout);
+            std::cerr.rdbuf(original_cerr);
+
+            // Close the null device
+            null_stream.close();
+        }
+    };
+
+    std::string randomBases(size_t length, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        const char bases[] = {'A', 'C', 'G', 'T'};
+        std::string sequence(length, 'A');
+        for (auto &ch : sequence) {
+            ch = bases[rng() % 4];
+        }
+        return sequence;
+    }
+
+    // Records of irregular length wrapped at `width`, with a short last line per record
+    std::string makeFasta(const std::string &newline, bool finalNewline)
+    {
+        std::ostringstream out;
+        const size_t lengths[] = {1000, 61, 0, 12345};
+        for (size_t r = 0; r < 4; ++r) {
+            out << ">chr" << r + 1 << " test record " << r << newline;
+            std::string bases = randomBases(lengths[r], static_cast<unsigned>(r));
+            size_t width = r == 1 ? 7 : 60;
+            for (size_t pos = 0; pos < bases.size(); pos += width) {
+                out << bases.substr(pos, width);
+                if (r < 3 || pos + width < bases.size() || finalNewline) {
+                    out << newline;
+                }
+            }
+        }
+        return out.str();
+    }
+
+    std::string readFile(const std::string &filename)
+    {
+        std::ifstream in(filename, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    void roundTrip(const std::string &method, const std::string &text)
+    {
+        std::string inputFile = "test_input.fa";
+        std::ofstream(inputFile, std::ios::binary) << text;
+        std::string compressedFile = "test_output.fa.bin";
+        std::string decompressedFile = "test_decoded.fa";
+
+        FastaCompressor compressor(method);
+        EXPECT_NO_THROW(compressor.encodeFromFile(inputFile, compressedFile));
+        EXPECT_TRUE(FastaCompressor::isFastaArchive(compressedFile));
+
+        // Decoding takes the codec from the archive, not from the constructor
+        FastaCompressor decoder("");
+        EXPECT_NO_THROW(decoder.decodeFromFile(compressedFile, decompressedFile));
+        EXPECT_EQ(readFile(decompressedFile), text) << method;
+
+        std::remove(inputFile.c_str());
+        std::remove(compressedFile.c_str());
+        std::remove(decompressedFile.c_str());
+    }
+}
+
+TEST_F(SuppressOutputFastaCompressorTest, RoundTripIsByteExact)
+{
+    for (const std::string method : {"huffmangenome", "pack2", "cm"}) {
+        roundTrip(method, makeFasta("\n", true));
+    }
+}
+
+TEST_F(SuppressOutputFastaCompressorTest, RoundTripKeepsLineEnds)
+{
+    roundTrip("huffmangenome", makeFasta("\r\n", true));
+    roundTrip("huffmangenome", makeFasta("\n", false));
+    roundTrip("pack2", makeFasta("\r\n", false));
+    roundTrip("huffmangenome", ">only a header");
+    roundTrip("huffmangenome", ">a\nACGT\n\n>b\n\nAC\n");
+    roundTrip("huffmangenome", "");
+}
+
+TEST_F(SuppressOutputFastaCompressorTest, DecodesBlocksStraightIntoRecords)
+{
+    // Blocks of 100 bases end mid-line and mid-record, and arrive a batch at a time
+    std::string text = makeFasta("\n", false);
+    std::string inputFile = "test_input.fa";
+    std::ofstream(inputFile, std::ios::binary) << text;
+    std::string compressedFile = "test_output.fa.bin";
+    std::string decompressedFile = "test_decoded.fa";
+
+    FastaCompressor compressor("huffmangenome");
+    compressor.setBlockSize(100);
+    EXPECT_NO_THROW(compressor.encodeFromFile(inputFile, compressedFile));
+
+    FastaCompressor decoder("");
+    decoder.setThreadCount(3);
+    decoder.setMemoryLimit(250);
+    EXPECT_NO_THROW(decoder.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_EQ(readFile(decompressedFile), text);
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputFastaCompressorTest, KeepsAmbiguityCodes)
+{
+    std::string text = ">scaffold1\nNNNNACGTRYAC\nGTNNNNNNNNNN\nNNNNNNACGTAC\nGT\n>scaffold2\nnnnnACGT\n";
+    for (const std::string method : {"huffmangenome", "pack2", "cm"}) {
+        roundTrip(method, text);
+    }
+
+    std::string inputFile = "test_input.fa";
+    std::ofstream(inputFile, std::ios::binary) << text;
+    std::string compressedFile = "test_output.fa.bin";
+    FastaCompressor compressor("pack2");
+    EXPECT_NO_THROW(compressor.encodeFromFile(inputFile, compressedFile));
+    EXPECT_EQ(compressor.extractRecord(compressedFile, "scaffold2"), ">scaffold2\nnnnnACGT\n");
+    EXPECT_EQ(compressor.decodeRange(compressedFile, 8, 20), "RYACGTNNNNNNNNNNNNNN");
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+}
+
+TEST_F(SuppressOutputFastaCompressorTest, ExtractRecordByName)
+{
+    std::string text = makeFasta("\n", true);
+    std::string inputFile = "test_input.fa";
+    std::ofstream(inputFile, std::ios::binary) << text;
+    std::string compressedFile = "test_output.fa.bin";
+
+    FastaCompressor compressor("huffmangenome");
+    compressor.setBlockSize(256);
+    EXPECT_NO_THROW(compressor.encodeFromFile(inputFile, compressedFile));
+
+    // Each record comes back exactly as it appears in the file
+    size_t second = text.find(">chr2");
+    size_t third = text.find(">chr3");
+    size_t fourth = text.find(">chr4");
+    EXPECT_EQ(compressor.extractRecord(compressedFile, "chr2"), text.substr(second, third - second));
+    EXPECT_EQ(compressor.extractRecord(compressedFile, "chr3"), text.substr(third, fourth - third));
+    EXPECT_EQ(compressor.extractRecord(compressedFile, "chr4"), text.substr(fourth));
+    EXPECT_THROW(compressor.extractRecord(compressedFile, "chr5"), std::out_of_range);
+
+    // Ranges address the bases of all records concatenated
+    std::string bases = randomBases(1000, 0) + randomBases(61, 1);
+    EXPECT_EQ(compressor.decodeRange(compressedFile, 990, 20), bases.substr(990, 20));
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+}
+
+TEST_F(SuppressOutputFastaCompressorTest, RejectsMethodWithoutSequenceCoding)
+{
+    std::string inputFile = "test_input.fa";
+    std::ofstream(inputFile, std::ios::binary) << ">a\nACGT\n";
+    std::string compressedFile = "test_output.fa.bin";
+
+    FastaCompressor compressor("rle");
+    EXPECT_THROW(compressor.encodeFromFile(inputFile, compressedFile), CompressionException);
+    EXPECT_FALSE(std::ifstream(compressedFile).good());
+
+    std::remove(inputFile.c_str());
+}
+
+TEST_F(SuppressOutputFastaCompressorTest, ValidateInputFile)
+{
+    FastaCompressor compressor("huffmangenome");
+
+    std::string validFile = "valid_test.fasta";
+    std::ofstream(validFile) << ">a\nACGT\n";
+    std::string headerless = "headerless_test.fasta";
+    std::ofstream(headerless) << "ACGT\n";
+    std::string textFile = "valid_test.txt";
+    std::ofstream(textFile) << ">a\nACGT\n";
+
+    EXPECT_TRUE(compressor.validateInputFile(validFile));
+    EXPECT_FALSE(compressor.validateInputFile(headerless));
+    EXPECT_FALSE(compressor.validateInputFile(textFile));
+
+    // Bases outside the codec's alphabet leave no archive behind
+    std::string invalidFile = "invalid_test.fa";
+    std::ofstream(invalidFile) << ">a\nACGTXXXX\n";
+    std::string compressedFile = "test_output.fa.bin";
+    EXPECT_NO_THROW(compressor.encodeFromFile(invalidFile, compressedFile));
+    EXPECT_FALSE(std::ifstream(compressedFile).good());
+
+    std::remove(validFile.c_str());
+    std::remove(headerless.c_str());
+    std::remove(textFile.c_str());
+    std::remove(invalidFile.c_str());
+}
+
+TEST_F(SuppressOutputFastaCompressorTest, KeepsSoftMasking)
+{
+    std::string text = ">chr1\nACGTacgtacgtNNnnACGT\nacgtACGTACGTACGTACGT\n>chr2\nggggggggggCCCC\n";
+    for (const std::string method : {"huffmangenome", "pack2", "cm"}) {
+        roundTrip(method, text);
+    }
+
+    std::string inputFile = "test_input.fa";
+    std::ofstream(inputFile, std::ios::binary) << text;
+    std::string compressedFile = "test_output.fa.bin";
+    FastaCompressor compressor("huffmangenome");
+    EXPECT_NO_THROW(compressor.encodeFromFile(inputFile, compressedFile));
+    EXPECT_EQ(compressor.extractRecord(compressedFile, "chr2"), ">chr2\nggggggggggCCCC\n");
+    EXPECT_EQ(compressor.decodeRange(compressedFile, 2, 20), "GTacgtacgtNNnnACGTac");
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+}
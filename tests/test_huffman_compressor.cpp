@@ -1,8 +1,10 @@
 // HuffmanCompressorTest.cpp
 #include <gtest/gtest.h>
 #include "../include/HuffmanCompressor.h"
+#include "../include/ByteHistogram.h"
 #include <fstream>
 #include <string>
+#include <vector>
 #include <logger.h>
 
 // Encapsulate the Test Fixture in an Anonymous Namespace
@@ -159,3 +161,234 @@ TEST_F(SuppressOutputHuffmanCompressorTest, ValidateDecodedFile)
     std::remove((compressedFile + ".freq").c_str()); // Frequency map file
     std::remove(decompressedFile.c_str());
 }
+
+TEST_F(SuppressOutputHuffmanCompressorTest, DecodeLengthLimitedCodes)
+{
+    HuffmanCompressor compressor;
+
+    // Fibonacci-like frequencies would give a tree far deeper than the table width
+    std::string inputFile = "test_input.txt";
+    std::string original;
+    long long a = 1, b = 1;
+    for (int symbol = 0; symbol < 20; ++symbol)
+    {
+        original.append(static_cast<size_t>(a), static_cast<char>('a' + symbol));
+        long long next = a + b;
+        a = b;
+        b = next;
+    }
+    std::ofstream input(inputFile, std::ios::binary);
+    input << original;
+    input.close();
+
+    std::string compressedFile = "test_output.huff";
+    std::string decompressedFile = "test_output_decoded.txt";
+
+    EXPECT_NO_THROW(compressor.encodeFromFile(inputFile, compressedFile));
+    EXPECT_NO_THROW(compressor.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(compressor.validateDecodedFile(inputFile, decompressedFile));
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove((compressedFile + ".freq").c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanCompressorTest, DecodeSingleSymbolFile)
+{
+    HuffmanCompressor compressor;
+
+    std::string inputFile = "test_input.txt";
+    std::ofstream input(inputFile);
+    input << "GGGGGGGGGGGGGGGGGGGGG";
+    input.close();
+
+    std::string compressedFile = "test_output.huff";
+    std::string decompressedFile = "test_output_decoded.txt";
+
+    EXPECT_NO_THROW(compressor.encodeFromFile(inputFile, compressedFile));
+    EXPECT_NO_THROW(compressor.decodeFromFile(compressedFile, decompressedFile));
+
+    std::ifstream decompressed(decompressedFile);
+    std::ostringstream content;
+    content << decompressed.rdbuf();
+    EXPECT_EQ(content.str(), "GGGGGGGGGGGGGGGGGGGGG");
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove((compressedFile + ".freq").c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanCompressorTest, ArchiveIsSelfContained)
+{
+    HuffmanCompressor compressor;
+
+    std::string inputFile = "test_input.txt";
+    std::ofstream input(inputFile);
+    input << "AAAABBBCCD";
+    input.close();
+
+    std::string compressedFile = "test_output.huff";
+    std::string decompressedFile = "test_output_decoded.txt";
+
+    EXPECT_NO_THROW(compressor.encodeFromFile(inputFile, compressedFile));
+    EXPECT_FALSE(std::ifstream(compressedFile + ".freq").good());
+
+    // A fresh instance has no state from the encoder
+    HuffmanCompressor decoder;
+    EXPECT_NO_THROW(decoder.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile));
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanCompressorTest, RansRoundTripBeatsHuffmanOnSkewedInput)
+{
+    // 90% one byte: Huffman cannot go below 1 bit per symbol, rANS gets close to the entropy.
+    // Longer than one rANS block, so several blocks share the table.
+    std::string inputFile = "test_input.txt";
+    {
+        std::ofstream input(inputFile, std::ios::binary);
+        unsigned state = 12345;
+        for (int i = 0; i < 1500000; ++i)
+        {
+            state = state * 1103515245u + 12345u;
+            unsigned roll = (state >> 16) % 100;
+            input.put(roll < 90 ? 'A' : static_cast<char>('B' + roll % 5));
+        }
+    }
+
+    std::string huffmanFile = "test_output.huff";
+    std::string ransFile = "test_output.rans";
+    std::string decompressedFile = "test_output_decoded.txt";
+
+    HuffmanCompressor huffman;
+    huffman.encodeFromFile(inputFile, huffmanFile);
+
+    HuffmanCompressor rans;
+    rans.setEntropyCoder(EntropyCoder::Rans);
+    EXPECT_NO_THROW(rans.encodeFromFile(inputFile, ransFile));
+    EXPECT_LT(rans.getMetrics().getCompressedSize(), huffman.getMetrics().getCompressedSize() * 3 / 4);
+
+    // The decoder picks the coder up from the archive
+    HuffmanCompressor decoder;
+    EXPECT_NO_THROW(decoder.decodeFromFile(ransFile, decompressedFile));
+    EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile));
+
+    std::remove(inputFile.c_str());
+    std::remove(huffmanFile.c_str());
+    std::remove(ransFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanCompressorTest, ByteHistogramMatchesNaiveCount)
+{
+    // Odd length, so the slices and the 8-byte loop both leave a tail
+    std::vector<unsigned char> data(3 * ByteHistogram::PARALLEL_THRESHOLD + 13);
+    unsigned state = 777;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        state = state * 1103515245u + 12345u;
+        data[i] = static_cast<unsigned char>(i % 7 == 0 ? 'A' : state >> 24);
+    }
+    ByteHistogram::Counts expected{};
+    for (unsigned char byte : data)
+    {
+        expected[byte]++;
+    }
+
+    EXPECT_EQ(ByteHistogram::count(data.data(), data.size(), 1), expected);
+    EXPECT_EQ(ByteHistogram::count(data.data(), data.size(), 4), expected);
+
+    // add() accumulates into the counts it is given
+    ByteHistogram::Counts twice = expected;
+    ByteHistogram::add(data.data(), data.size(), twice);
+    EXPECT_EQ(twice['A'], 2 * expected['A']);
+}
+
+TEST_F(SuppressOutputHuffmanCompressorTest, BlockModelsRoundTrip)
+{
+    // Text in the first megabyte, then binary noise: each block gets the code that suits it
+    std::string inputFile = "test_input.txt";
+    {
+        std::ofstream input(inputFile, std::ios::binary);
+        unsigned state = 4242;
+        for (int i = 0; i < 2500000; ++i)
+        {
+            state = state * 1103515245u + 12345u;
+            input.put(i < 1100000 ? "the quick brown fox "[i % 20] : static_cast<char>(state >> 24));
+        }
+    }
+
+    for (EntropyCoder coder : {EntropyCoder::Huffman, EntropyCoder::Rans})
+    {
+        std::string globalFile = "test_output.global";
+        std::string compressedFile = "test_output.huff";
+        std::string decompressedFile = "test_output_decoded.txt";
+        HuffmanCompressor global;
+        global.setEntropyCoder(coder);
+        global.encodeFromFile(inputFile, globalFile);
+
+        HuffmanCompressor encoder;
+        encoder.setEntropyCoder(coder);
+        encoder.setModelScope(ModelScope::Block);
+        EXPECT_NO_THROW(encoder.encodeFromFile(inputFile, compressedFile));
+        EXPECT_LT(encoder.getMetrics().getCompressedSize(), global.getMetrics().getCompressedSize());
+        // The per-block counts add up to the whole-input histogram
+        EXPECT_EQ(encoder.frequencyMap, global.frequencyMap);
+        EXPECT_EQ(encoder.getMetrics().getPhaseBytes(CompressionMetrics::Phase::Counting), 2500000u);
+
+        HuffmanCompressor decoder;
+        EXPECT_NO_THROW(decoder.decodeFromFile(compressedFile, decompressedFile));
+        EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile));
+
+        std::remove(globalFile.c_str());
+        std::remove(compressedFile.c_str());
+        std::remove(decompressedFile.c_str());
+    }
+    std::remove(inputFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanCompressorTest, SplitStreamsRoundTrip)
+{
+    // Two full blocks and a short one of text and noise
+    std::string inputFile = "test_input.txt";
+    {
+        std::ofstream input(inputFile, std::ios::binary);
+        unsigned state = 4242;
+        for (int i = 0; i < 2500003; ++i)
+        {
+            state = state * 1103515245u + 12345u;
+            input.put(i % 300000 < 200000 ? "the quick brown fox "[i % 20] : static_cast<char>(state >> 24));
+        }
+    }
+
+    for (ModelScope scope : {ModelScope::Global, ModelScope::Block})
+    {
+        std::string singleFile = "test_output.single";
+        std::string compressedFile = "test_output.huff";
+        std::string decompressedFile = "test_output_decoded.txt";
+        HuffmanCompressor single;
+        single.setModelScope(scope);
+        single.encodeFromFile(inputFile, singleFile);
+
+        HuffmanCompressor encoder;
+        encoder.setModelScope(scope);
+        encoder.setStreamCount(HuffmanTable::STREAM_COUNT);
+        EXPECT_NO_THROW(encoder.encodeFromFile(inputFile, compressedFile));
+        // The same codes, plus a small stream table per block
+        EXPECT_LT(encoder.getMetrics().getCompressedSize(), single.getMetrics().getCompressedSize() + 8 * 200);
+
+        HuffmanCompressor decoder;
+        EXPECT_NO_THROW(decoder.decodeFromFile(compressedFile, decompressedFile));
+        EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile));
+
+        std::remove(singleFile.c_str());
+        std::remove(compressedFile.c_str());
+        std::remove(decompressedFile.c_str());
+    }
+    std::remove(inputFile.c_str());
+}
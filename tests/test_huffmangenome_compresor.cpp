@@ -1,7 +1,12 @@
 // HuffmanGenomeTest.cpp
 #include <gtest/gtest.h>
 #include "../include/HuffmanGenome.h"
+#include "../include/CompressionException.h"
+#include <cctype>
 #include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
 #include <logger.h>
 
 // Encapsulate the Test Fixture in an Anonymous Namespace
@@ -139,3 +144,489 @@ TEST_F(SuppressOutputHuffmanGenomeTest, ValidateInputFile)
     std::remove(validFile.c_str());
     std::remove(invalidFile.c_str());
 }
+
+TEST_F(SuppressOutputHuffmanGenomeTest, ArchiveIsSelfContained)
+{
+    HuffmanGenome genome;
+
+    std::string inputFile = "test_input.txt";
+    std::ofstream input(inputFile);
+    input << "AAAAAAAACCCCGGT";
+    input.close();
+
+    std::string compressedFile = "test_output.huff";
+    std::string decompressedFile = "test_decoded.txt";
+
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+    EXPECT_FALSE(std::ifstream(compressedFile + ".freq").good());
+
+    // A fresh instance has no state from the encoder
+    HuffmanGenome decoder;
+    EXPECT_NO_THROW(decoder.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile));
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanGenomeTest, BlockParallelRoundTrip)
+{
+    std::string inputFile = "test_input.txt";
+    std::ofstream input(inputFile);
+    const char bases[] = {'A', 'C', 'G', 'T'};
+    for (int i = 0; i < 10007; ++i)
+    {
+        input << bases[(i * 7 + i / 13) % 4];
+    }
+    input.close();
+
+    std::string compressedFile = "test_output.huff";
+    std::string decompressedFile = "test_decoded.txt";
+
+    // Small blocks on several threads give many batches and a short last block
+    HuffmanGenome encoder;
+    encoder.setThreadCount(3);
+    encoder.setBlockSize(1000);
+    EXPECT_NO_THROW(encoder.encodeFromFile(inputFile, compressedFile));
+
+    HuffmanGenome decoder;
+    decoder.setThreadCount(2);
+    EXPECT_NO_THROW(decoder.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile));
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanGenomeTest, RejectsZeroBlockSize)
+{
+    HuffmanGenome genome;
+    EXPECT_THROW(genome.setBlockSize(0), std::invalid_argument);
+}
+
+TEST_F(SuppressOutputHuffmanGenomeTest, ValidatesWhileCounting)
+{
+    std::string inputFile = "test_input.txt";
+    std::string compressedFile = "test_output.huff";
+
+    // Long enough for the vector classifier, with mixed case and an uneven tail
+    std::string bases;
+    for (int i = 0; i < 1000; ++i)
+    {
+        bases += "ACGTacgtAAC";
+    }
+    std::ofstream(inputFile) << bases;
+
+    HuffmanGenome genome;
+    genome.setBlockSize(777);
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+    EXPECT_EQ(genome.frequencyMap[HuffmanGenome::A], 4000u);
+    EXPECT_EQ(genome.frequencyMap[HuffmanGenome::C], 3000u);
+    EXPECT_EQ(genome.frequencyMap[HuffmanGenome::G], 2000u);
+    EXPECT_EQ(genome.frequencyMap[HuffmanGenome::T], 2000u);
+    std::remove(compressedFile.c_str());
+
+    // A stray byte deep inside a later block aborts before any output is written
+    bases[9000] = 'X';
+    std::ofstream(inputFile) << bases;
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+    EXPECT_FALSE(std::ifstream(compressedFile).good());
+
+    std::remove(inputFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanGenomeTest, RansBlockParallelRoundTrip)
+{
+    // AT-rich input with some lower case: about 1.72 bits/base of entropy, where Huffman needs 1.8
+    std::string inputFile = "test_input.txt";
+    {
+        std::ofstream input(inputFile);
+        const char bases[] = {'A', 'T', 'A', 'T', 'A', 'T', 'C', 'G', 'a', 't'};
+        for (int i = 0; i < 20011; ++i)
+        {
+            input << bases[(i * 7 + i / 13) % 10];
+        }
+    }
+
+    std::string huffmanFile = "test_output.huff";
+    std::string ransFile = "test_output.rans";
+    std::string decompressedFile = "test_decoded.txt";
+
+    HuffmanGenome huffman;
+    huffman.setBlockSize(5000);
+    huffman.encodeFromFile(inputFile, huffmanFile);
+
+    HuffmanGenome encoder;
+    encoder.setThreadCount(3);
+    encoder.setBlockSize(5000);
+    encoder.setEntropyCoder(EntropyCoder::Rans);
+    EXPECT_NO_THROW(encoder.encodeFromFile(inputFile, ransFile));
+    EXPECT_LT(encoder.getMetrics().getCompressedSize(), huffman.getMetrics().getCompressedSize());
+
+    HuffmanGenome decoder;
+    decoder.setThreadCount(2);
+    EXPECT_NO_THROW(decoder.decodeFromFile(ransFile, decompressedFile));
+
+    // Lower case comes back as it was
+    EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile));
+
+    std::remove(inputFile.c_str());
+    std::remove(huffmanFile.c_str());
+    std::remove(ransFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanGenomeTest, DecodeRangeMatchesInput)
+{
+    std::string inputFile = "test_input.txt";
+    std::string bases;
+    const char symbols[] = {'A', 'C', 'G', 'T'};
+    for (int i = 0; i < 10007; ++i)
+    {
+        bases += symbols[(i * 7 + i / 13) % 4];
+    }
+    std::ofstream(inputFile) << bases;
+
+    for (EntropyCoder coder : {EntropyCoder::Huffman, EntropyCoder::Rans})
+    {
+        std::string compressedFile = "test_output.huff";
+        HuffmanGenome encoder;
+        encoder.setBlockSize(1000);
+        encoder.setEntropyCoder(coder);
+        encoder.encodeFromFile(inputFile, compressedFile);
+
+        // Inside one block, across several blocks, and clipped at the end
+        HuffmanGenome decoder;
+        decoder.setThreadCount(3);
+        EXPECT_EQ(decoder.decodeRange(compressedFile, 1200, 300), bases.substr(1200, 300));
+        EXPECT_EQ(decoder.decodeRange(compressedFile, 999, 3002), bases.substr(999, 3002));
+        EXPECT_EQ(decoder.decodeRange(compressedFile, 9990, 100), bases.substr(9990));
+        EXPECT_EQ(decoder.decodeRange(compressedFile, 10007, 5), "");
+        EXPECT_THROW(decoder.decodeRange(compressedFile, 10008, 1), std::out_of_range);
+
+        std::remove(compressedFile.c_str());
+    }
+    std::remove(inputFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanGenomeTest, AmbiguityCodesRoundTrip)
+{
+    // A long N gap, scattered IUPAC codes, and Ns at both ends
+    std::string inputFile = "test_input.txt";
+    std::string bases = "NNNACGT";
+    const char symbols[] = {'A', 'C', 'G', 'T'};
+    for (int i = 0; i < 5000; ++i)
+    {
+        bases += symbols[(i * 7 + i / 13) % 4];
+    }
+    bases += std::string(200000, 'N') + "ACRYGTnnACGTKMACGT" + std::string(77, 'N');
+    std::ofstream(inputFile) << bases;
+
+    std::string compressedFile = "test_output.huff";
+    std::string decompressedFile = "test_decoded.txt";
+    HuffmanGenome genome;
+    genome.setBlockSize(1000);
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+    EXPECT_NO_THROW(genome.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(genome.validateDecodedFile(inputFile, decompressedFile));
+
+    // The gap stays in the exception stream: the archive is about the size of the core bases alone
+    std::ifstream archive(compressedFile, std::ios::binary | std::ios::ate);
+    EXPECT_LT(static_cast<long long>(archive.tellg()), 2000);
+
+    // Ranges starting and ending inside runs and between them
+    for (uint64_t start : {0ull, 2ull, 4990ull, 5005ull, 204000ull, 205008ull})
+    {
+        EXPECT_EQ(genome.decodeRange(compressedFile, start, 30), bases.substr(start, 30)) << start;
+    }
+    EXPECT_EQ(genome.decodeRange(compressedFile, 100, 205000), bases.substr(100, 205000));
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanGenomeTest, SoftMaskedRoundTrip)
+{
+    // Lower-case stretches inside a block, across block boundaries, and next to an N gap
+    std::string inputFile = "test_input.txt";
+    std::string bases;
+    const char symbols[] = {'A', 'C', 'G', 'T'};
+    for (int i = 0; i < 10007; ++i)
+    {
+        bases += symbols[(i * 7 + i / 13) % 4];
+    }
+    for (size_t i = 10; i < 20; ++i)
+        bases[i] = static_cast<char>(bases[i] | 0x20);
+    for (size_t i = 990; i < 3010; ++i)
+        bases[i] = static_cast<char>(bases[i] | 0x20);
+    bases.replace(5000, 50, std::string(50, 'N'));
+    for (size_t i = 5050; i < 5100; ++i)
+        bases[i] = static_cast<char>(bases[i] | 0x20);
+    bases.back() = 'g';
+    std::ofstream(inputFile) << bases;
+
+    for (EntropyCoder coder : {EntropyCoder::Huffman, EntropyCoder::Rans})
+    {
+        std::string compressedFile = "test_output.huff";
+        std::string decompressedFile = "test_decoded.txt";
+        HuffmanGenome encoder;
+        encoder.setBlockSize(1000);
+        encoder.setEntropyCoder(coder);
+        encoder.setThreadCount(3);
+        EXPECT_NO_THROW(encoder.encodeFromFile(inputFile, compressedFile));
+
+        HuffmanGenome decoder;
+        decoder.setThreadCount(2);
+        EXPECT_NO_THROW(decoder.decodeFromFile(compressedFile, decompressedFile));
+        EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile));
+
+        EXPECT_EQ(decoder.decodeRange(compressedFile, 5, 20), bases.substr(5, 20));
+        EXPECT_EQ(decoder.decodeRange(compressedFile, 980, 2100), bases.substr(980, 2100));
+        EXPECT_EQ(decoder.decodeRange(compressedFile, 4990, 200), bases.substr(4990, 200));
+        EXPECT_EQ(decoder.decodeRange(compressedFile, 10000, 10), bases.substr(10000));
+
+        std::remove(compressedFile.c_str());
+        std::remove(decompressedFile.c_str());
+    }
+    std::remove(inputFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanGenomeTest, RecordsPhaseTimings)
+{
+    std::string inputFile = "test_input.txt";
+    std::string bases;
+    for (int i = 0; i < 5000; ++i)
+        bases.push_back("ACGT"[(i * 5 + i / 11) % 4]);
+    std::ofstream(inputFile) << bases;
+
+    std::string compressedFile = "test_output.huff";
+    std::string decompressedFile = "test_decoded.txt";
+    HuffmanGenome genome;
+    genome.setBlockSize(1000);
+    genome.encodeFromFile(inputFile, compressedFile);
+
+    using Phase = CompressionMetrics::Phase;
+    CompressionMetrics metrics = genome.getMetrics();
+    for (Phase phase : {Phase::Validation, Phase::Counting, Phase::ModelBuild, Phase::Encoding, Phase::Io})
+    {
+        EXPECT_TRUE(metrics.hasPhase(phase)) << CompressionMetrics::phaseName(phase);
+    }
+    EXPECT_FALSE(metrics.hasPhase(Phase::Decoding));
+    EXPECT_EQ(metrics.getPhaseBytes(Phase::Counting), bases.size());
+    EXPECT_EQ(metrics.getPhaseBytes(Phase::Encoding), bases.size());
+    std::ifstream archive(compressedFile, std::ios::binary | std::ios::ate);
+    EXPECT_EQ(metrics.getPhaseBytes(Phase::Io), static_cast<uint64_t>(archive.tellg()));
+
+    // Decoding adds its own phase and keeps the sizes of the encode
+    genome.decodeFromFile(compressedFile, decompressedFile);
+    metrics = genome.getMetrics();
+    EXPECT_EQ(metrics.getPhaseBytes(Phase::Decoding), bases.size());
+    EXPECT_EQ(metrics.getOriginalSize(), static_cast<long long>(bases.size()) * 8);
+
+    std::ostringstream json;
+    metrics.printJson(json);
+    EXPECT_EQ(json.str().find("{\"original_bits\": " + std::to_string(bases.size() * 8)), 0u);
+    EXPECT_NE(json.str().find("\"decoding\": {\"seconds\": "), std::string::npos);
+    EXPECT_EQ(json.str().back(), '\n');
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanGenomeTest, BlockModelsRoundTrip)
+{
+    // An A/T-only half and a C/G-only half: a code per block needs about 1 bit/base where
+    // one code for the whole input needs 2. Soft-masked and N bases go in the middle.
+    std::string inputFile = "test_input.txt";
+    std::string bases;
+    for (int i = 0; i < 20000; ++i)
+    {
+        bases += (i < 10000 ? "AT" : "CG")[(i * 7 + i / 13) % 2];
+    }
+    for (size_t i = 9000; i < 11000; ++i)
+    {
+        bases[i] = static_cast<char>(bases[i] | 0x20);
+    }
+    bases.replace(12000, 300, std::string(300, 'N'));
+    std::ofstream(inputFile) << bases;
+
+    for (EntropyCoder coder : {EntropyCoder::Huffman, EntropyCoder::Rans})
+    {
+        std::string globalFile = "test_output.global";
+        std::string blockFile = "test_output.block";
+        std::string decompressedFile = "test_decoded.txt";
+        HuffmanGenome global;
+        global.setBlockSize(5000);
+        global.setEntropyCoder(coder);
+        global.encodeFromFile(inputFile, globalFile);
+
+        HuffmanGenome encoder;
+        encoder.setThreadCount(3);
+        encoder.setBlockSize(5000);
+        encoder.setEntropyCoder(coder);
+        encoder.setModelScope(ModelScope::Block);
+        EXPECT_NO_THROW(encoder.encodeFromFile(inputFile, blockFile));
+        EXPECT_LT(encoder.getMetrics().getCompressedSize(), global.getMetrics().getCompressedSize() * 3 / 4);
+        // Counting is part of the one pass, so it is reported as encoding
+        EXPECT_FALSE(encoder.getMetrics().hasPhase(CompressionMetrics::Phase::Counting));
+        EXPECT_EQ(encoder.getMetrics().getPhaseBytes(CompressionMetrics::Phase::Encoding), bases.size());
+
+        // The decoder picks the scope up from the archive
+        HuffmanGenome decoder;
+        decoder.setThreadCount(2);
+        EXPECT_NO_THROW(decoder.decodeFromFile(blockFile, decompressedFile));
+        EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile));
+        EXPECT_EQ(decoder.decodeRange(blockFile, 4990, 5020), bases.substr(4990, 5020));
+
+        std::remove(globalFile.c_str());
+        std::remove(blockFile.c_str());
+        std::remove(decompressedFile.c_str());
+    }
+    std::remove(inputFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanGenomeTest, SplitStreamsRoundTrip)
+{
+    // A/T-rich bases give the variable-length code, the uniform stretch balanced block
+    // codes; the short last block leaves segments of unequal length
+    std::string inputFile = "test_input.txt";
+    std::string bases;
+    for (int i = 0; i < 23003; ++i)
+    {
+        bases += i < 12000 ? "AATTACGTAT"[(i * 7 + i / 13) % 10] : "ACGT"[(i * 7 + i / 13) % 4];
+    }
+    for (size_t i = 3000; i < 3500; ++i)
+    {
+        bases[i] = static_cast<char>(bases[i] | 0x20);
+    }
+    bases.replace(8000, 200, std::string(200, 'N'));
+    std::ofstream(inputFile) << bases;
+
+    for (ModelScope scope : {ModelScope::Global, ModelScope::Block})
+    {
+        std::string compressedFile = "test_output.bin";
+        std::string decompressedFile = "test_decoded.txt";
+        HuffmanGenome encoder;
+        encoder.setBlockSize(5000);
+        encoder.setModelScope(scope);
+        encoder.setStreamCount(HuffmanTable::STREAM_COUNT);
+        EXPECT_NO_THROW(encoder.encodeFromFile(inputFile, compressedFile));
+
+        HuffmanGenome decoder;
+        decoder.setThreadCount(2);
+        EXPECT_NO_THROW(decoder.decodeFromFile(compressedFile, decompressedFile));
+        EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile));
+        EXPECT_EQ(decoder.decodeRange(compressedFile, 4990, 11020), bases.substr(4990, 11020));
+        EXPECT_EQ(decoder.decodeRange(compressedFile, 22990, 100), bases.substr(22990));
+
+        std::remove(compressedFile.c_str());
+        std::remove(decompressedFile.c_str());
+    }
+    std::remove(inputFile.c_str());
+
+    HuffmanGenome genome;
+    EXPECT_THROW(genome.setStreamCount(3), std::invalid_argument);
+}
+
+TEST_F(SuppressOutputHuffmanGenomeTest, MemoryLimitBoundsDecoding)
+{
+    std::string inputFile = "test_input.txt";
+    std::string bases;
+    for (int i = 0; i < 10007; ++i)
+    {
+        bases += "ACGT"[(i * 7 + i / 13) % 4];
+    }
+    std::ofstream(inputFile) << bases;
+
+    std::string compressedFile = "test_output.huff";
+    std::string decompressedFile = "test_decoded.txt";
+    HuffmanGenome encoder;
+    encoder.setBlockSize(1000);
+    encoder.encodeFromFile(inputFile, compressedFile);
+
+    // Room for two decoded blocks: eight threads decode in batches of two
+    HuffmanGenome decoder;
+    decoder.setThreadCount(8);
+    decoder.setMemoryLimit(2500);
+    EXPECT_NO_THROW(decoder.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(decoder.validateDecodedFile(inputFile, decompressedFile));
+    std::remove(decompressedFile.c_str());
+
+    // Exactly one block decodes a block at a time
+    HuffmanGenome single;
+    single.setThreadCount(8);
+    single.setMemoryLimit(1000);
+    EXPECT_NO_THROW(single.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(single.validateDecodedFile(inputFile, decompressedFile));
+    std::remove(decompressedFile.c_str());
+
+    // Less than one block is refused rather than exceeded, and leaves no output behind
+    HuffmanGenome starved;
+    starved.setMemoryLimit(999);
+    EXPECT_THROW(starved.decodeFromFile(compressedFile, decompressedFile), CompressionException);
+    EXPECT_FALSE(std::ifstream(decompressedFile).good());
+
+    // With the default block size the only block is the whole, short sequence, and the
+    // limit is measured against that rather than the nominal 4M bases
+    HuffmanGenome defaults;
+    defaults.encodeFromFile(inputFile, compressedFile);
+    HuffmanGenome small;
+    small.setMemoryLimit(12000);
+    EXPECT_NO_THROW(small.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(small.validateDecodedFile(inputFile, decompressedFile));
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputHuffmanGenomeTest, BaseCodeShapesRoundTrip)
+{
+    // Balanced, skewed, and the codes of three bases and of one, at lengths that leave
+    // every kind of tail after the wide loops
+    const std::array<std::array<uint64_t, 4>, 4> shapes = {{{25, 25, 25, 25}, {50, 25, 13, 12}, {50, 0, 25, 25}, {0, 0, 7, 0}}};
+    for (const std::array<uint64_t, 4> &weights : shapes)
+    {
+        std::array<uint64_t, HuffmanTable::ALPHABET_SIZE> counts{};
+        std::string alphabet;
+        for (int i = 0; i < 4; ++i)
+        {
+            counts[static_cast<unsigned char>("ACGT"[i])] = weights[i];
+            alphabet.append(static_cast<size_t>(weights[i]), "ACGT"[i]);
+        }
+        HuffmanTable table;
+        table.buildFromCounts(counts);
+        BaseCode code(table);
+        EXPECT_EQ(code.isBalanced(), weights[0] == 25);
+
+        for (size_t length : {0, 1, 7, 15, 16, 17, 100, 1001})
+        {
+            std::string bases;
+            for (size_t i = 0; i < length; ++i)
+            {
+                char base = alphabet[(i * 37 + i / 7) % alphabet.size()];
+                bases.push_back(i % 5 == 0 ? static_cast<char>(base | 0x20) : base);
+            }
+            std::vector<unsigned char> stream;
+            BitWriter writer(stream);
+            code.encode(bases.data(), bases.size(), writer);
+            uint64_t bits = writer.bitsWritten();
+            writer.finish();
+
+            std::vector<char> decoded(length + HuffmanTable::DECODE_SLACK);
+            ASSERT_EQ(code.decode(stream.data(), bits, decoded.data(), length), length);
+            for (size_t i = 0; i < length; ++i)
+            {
+                ASSERT_EQ(decoded[i], static_cast<char>(bases[i] & ~0x20)) << length << " " << i;
+            }
+            if (length > 0)
+            {
+                EXPECT_THROW(code.decode(stream.data(), bits, decoded.data(), length - 1), std::runtime_error);
+            }
+        }
+    }
+}
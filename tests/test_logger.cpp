@@ -0,0 +1,102 @@
+// LoggerTest.cpp
+#include <gtest/gtest.h>
+#include <logger.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    class SuppressOutputLoggerTest : public ::testing::Test {
+    protected:
+        const std::string logFile = "test_logger.log";
+
+        void SetUp() override {
+            std::remove(logFile.c_str());
+            Logger::getInstance().setSink(Logger::Sink::File, logFile);
+            Logger::getInstance().setLevel(LogLevel::Info);
+            Logger::getInstance().enableLogging(true);
+        }
+
+        void TearDown() override {
+            // The other suites run with logging off
+            Logger::getInstance().enableLogging(false);
+            Logger::getInstance().setSink(Logger::Sink::Stderr);
+            std::remove(logFile.c_str());
+        }
+
+        std::vector<std::string> readLines() {
+            Logger::getInstance().flush();
+            std::vector<std::string> lines;
+            std::ifstream in(logFile);
+            std::string line;
+            while (std::getline(in, line)) {
+                lines.push_back(line);
+            }
+            return lines;
+        }
+    };
+}
+
+TEST_F(SuppressOutputLoggerTest, WritesLevelAndMessage)
+{
+    LOG_INFO("first message");
+    LOG_ERROR("second message");
+
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_NE(lines[0].find("INFO  first message"), std::string::npos);
+    EXPECT_NE(lines[1].find("ERROR second message"), std::string::npos);
+    EXPECT_EQ(lines[0].front(), '[');
+}
+
+TEST_F(SuppressOutputLoggerTest, FiltersBelowLevel)
+{
+    Logger::getInstance().setLevel(LogLevel::Warning);
+    LOG_INFO("dropped by the runtime level");
+    LOG_WARNING("kept");
+    Logger::getInstance().enableLogging(false);
+    LOG_ERROR("dropped while disabled");
+
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_NE(lines[0].find("WARN  kept"), std::string::npos);
+}
+
+TEST_F(SuppressOutputLoggerTest, ConcurrentProducersLoseNothingBelowCapacity)
+{
+    const int THREADS = 4;
+    const int PER_THREAD = 500; // fewer than the ring holds, so none is dropped
+    uint64_t droppedBefore = Logger::getInstance().droppedMessages();
+    std::vector<std::thread> producers;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        producers.emplace_back([t]()
+        {
+            for (int i = 0; i < PER_THREAD; ++i)
+            {
+                LOG_INFO("thread " + std::to_string(t) + " message " + std::to_string(i));
+            }
+        });
+    }
+    for (std::thread &producer : producers)
+    {
+        producer.join();
+    }
+
+    std::vector<std::string> lines = readLines();
+    EXPECT_EQ(Logger::getInstance().droppedMessages(), droppedBefore);
+    EXPECT_EQ(lines.size(), static_cast<size_t>(THREADS * PER_THREAD));
+
+    // Each producer's messages keep their order
+    std::vector<int> next(THREADS, 0);
+    for (const std::string &line : lines)
+    {
+        size_t at = line.find("thread ");
+        ASSERT_NE(at, std::string::npos);
+        int thread = std::stoi(line.substr(at + 7));
+        int message = std::stoi(line.substr(line.find("message ") + 8));
+        EXPECT_EQ(message, next[thread]++);
+    }
+}
@@ -0,0 +1,250 @@
+// Pack2GenomeTest.cpp
+#include <gtest/gtest.h>
+#include "../include/Pack2Genome.h"
+#include <fstream>
+#include <random>
+#include <vector>
+#include <logger.h>
+
+// Encapsulate the Test Fixture in an Anonymous Namespace
+namespace {
+    class SuppressOutputPack2GenomeTest : public ::testing::Test {
+    protected:
+        std::streambuf* original_cout;
+        std::streambuf* original_cerr;
+        std::ofstream null_stream;
+
+        void SetUp() override {
+            // Disable logging before any test code runs
+            Logger::getInstance().enableLogging(false);
+
+            // Open the null device based on the operating system
+        #ifdef _WIN32
+            null_stream.open("nul");
+        #else
+            null_stream.open("/dev/null");
+        #endif
+            if (!null_stream.is_open()) {
+                FAIL() << "Failed to open null device for output suppression.";
+            }
+
+            // Redirect std::cout and std::cerr to the null device
+            original_cout = std::cout.rdbuf(null_stream.rdbuf());
+            original_cerr = std::cerr.rdbuf(null_stream.rdbuf());
+        }
+
+        void TearDown() override {
+            // Restore the original buffers
+            std::cout.rdbuf(original_cout);
+            std::cerr.rdbuf(original_cerr);
+
+            // Close the null device
+            null_stream.close();
+        }
+    };
+
+    std::string randomBases(size_t length, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        const char bases[] = {'A', 'C', 'G', 'T'};
+        std::string sequence(length, 'A');
+        for (auto &ch : sequence) {
+            ch = bases[rng() % 4];
+        }
+        return sequence;
+    }
+}
+
+TEST_F(SuppressOutputPack2GenomeTest, Constructor)
+{
+    EXPECT_NO_THROW(Pack2Genome genome);
+}
+
+TEST_F(SuppressOutputPack2GenomeTest, PackUnpackKernelsRoundTrip)
+{
+    // Lengths around the 16/32-byte vector widths and their tails
+    for (size_t length : {0u, 1u, 3u, 4u, 15u, 16u, 31u, 33u, 127u, 128u, 129u, 1000u, 4099u}) {
+        std::string sequence = randomBases(length, static_cast<unsigned>(length));
+        std::vector<unsigned char> packed((length + 3) / 4 + 1);
+        ASSERT_EQ(Pack2Genome::packBases(sequence.data(), length, packed.data()), length);
+
+        std::string unpacked(length, '\0');
+        Pack2Genome::unpackBases(packed.data(), length, &unpacked[0]);
+        EXPECT_EQ(unpacked, sequence) << "length " << length;
+    }
+}
+
+TEST_F(SuppressOutputPack2GenomeTest, PackReportsFirstInvalidOffset)
+{
+    std::string sequence = randomBases(200, 7);
+    sequence[77] = 'N';
+    sequence[150] = '\n';
+    std::vector<unsigned char> packed(sequence.size() / 4 + 1);
+    EXPECT_EQ(Pack2Genome::packBases(sequence.data(), sequence.size(), packed.data()), 77u);
+}
+
+TEST_F(SuppressOutputPack2GenomeTest, PackAcceptsLowercase)
+{
+    std::string lower = "acgtacgtacgtacgtacgtacgtacgtacgtacgtac";
+    std::string upper = "ACGTACGTACGTACGTACGTACGTACGTACGTACGTAC";
+    std::vector<unsigned char> packedLower(lower.size() / 4 + 1);
+    std::vector<unsigned char> packedUpper(upper.size() / 4 + 1);
+    ASSERT_EQ(Pack2Genome::packBases(lower.data(), lower.size(), packedLower.data()), lower.size());
+    ASSERT_EQ(Pack2Genome::packBases(upper.data(), upper.size(), packedUpper.data()), upper.size());
+    EXPECT_EQ(packedLower, packedUpper);
+}
+
+TEST_F(SuppressOutputPack2GenomeTest, EncodeDecodeFromFile)
+{
+    Pack2Genome genome;
+
+    std::string inputFile = "test_input.txt";
+    std::ofstream input(inputFile, std::ios::binary);
+    input << randomBases(100003, 42);
+    input.close();
+
+    std::string compressedFile = "test_output.pack2";
+    std::string decompressedFile = "test_decoded.txt";
+
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+    EXPECT_NO_THROW(genome.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(genome.validateDecodedFile(inputFile, decompressedFile));
+
+    // Exactly 2 bits per base
+    CompressionMetrics metrics = genome.getMetrics();
+    EXPECT_EQ(metrics.getOriginalSize(), 100003LL * 8);
+    EXPECT_EQ(metrics.getCompressedSize(), 100003LL * 2 + 16);
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputPack2GenomeTest, EmptyInputRoundTrip)
+{
+    Pack2Genome genome;
+
+    // An empty file cannot be memory-mapped, so the input path has to cope without a mapping
+    std::string inputFile = "test_input.txt";
+    std::ofstream(inputFile, std::ios::binary).close();
+
+    std::string compressedFile = "test_output.pack2";
+    std::string decompressedFile = "test_decoded.txt";
+
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+    EXPECT_NO_THROW(genome.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(genome.validateDecodedFile(inputFile, decompressedFile));
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputPack2GenomeTest, ValidateInputFile)
+{
+    Pack2Genome genome;
+
+    std::string validFile = "valid_test.txt";
+    std::ofstream valid(validFile);
+    valid << "ACGTACGT";
+    valid.close();
+
+    std::string invalidFile = "invalid_test.txt";
+    std::ofstream invalid(invalidFile);
+    invalid << "ACGT1234";
+    invalid.close();
+
+    EXPECT_TRUE(genome.validateInputFile(validFile));
+    EXPECT_FALSE(genome.validateInputFile(invalidFile));
+
+    std::remove(validFile.c_str());
+    std::remove(invalidFile.c_str());
+}
+
+TEST_F(SuppressOutputPack2GenomeTest, DecodeRangeMatchesInput)
+{
+    Pack2Genome genome;
+
+    std::string bases = randomBases(100003, 5);
+    std::string inputFile = "test_input.txt";
+    std::ofstream(inputFile, std::ios::binary) << bases;
+    std::string compressedFile = "test_output.pack2";
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+
+    // Every alignment of the first base within its byte
+    for (uint64_t start = 1000; start < 1004; ++start)
+    {
+        EXPECT_EQ(genome.decodeRange(compressedFile, start, 77), bases.substr(start, 77));
+    }
+    EXPECT_EQ(genome.decodeRange(compressedFile, 99990, 1000), bases.substr(99990));
+    EXPECT_THROW(genome.decodeRange(compressedFile, 100004, 1), std::out_of_range);
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+}
+
+TEST_F(SuppressOutputPack2GenomeTest, AmbiguityCodesRoundTrip)
+{
+    Pack2Genome genome;
+
+    // Exceptions in the first and a later chunk shift the core off byte alignment
+    std::string bases = "N" + randomBases(1024 * 1024 + 5, 9) + std::string(3000000, 'N') + "RYKM" +
+                        randomBases(1001, 10) + "nnn";
+    std::string inputFile = "test_input.txt";
+    std::ofstream(inputFile, std::ios::binary) << bases;
+    std::string compressedFile = "test_output.pack2";
+    std::string decompressedFile = "test_decoded.txt";
+
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+    EXPECT_NO_THROW(genome.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(genome.validateDecodedFile(inputFile, decompressedFile));
+
+    // Core bases at 2 bits each plus a few bytes for the seven runs
+    uint64_t coreBases = 1024 * 1024 + 5 + 1001;
+    EXPECT_LT(genome.getMetrics().getCompressedSize(), static_cast<long long>(coreBases * 2 + 16 + 64 * 8));
+
+    for (uint64_t start : {0ull, 1048570ull, 4048575ull, 4049570ull})
+    {
+        EXPECT_EQ(genome.decodeRange(compressedFile, start, 20), bases.substr(start, 20)) << start;
+    }
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
+
+TEST_F(SuppressOutputPack2GenomeTest, SoftMaskedRoundTrip)
+{
+    Pack2Genome genome;
+
+    // Lower-case stretches inside a chunk, across a chunk boundary, next to exception runs and at the end
+    std::string bases = randomBases(2 * 1024 * 1024 + 9, 11);
+    for (size_t i = 100; i < 5000; ++i)
+        bases[i] = static_cast<char>(bases[i] | 0x20);
+    for (size_t i = 1024 * 1024 - 37; i < 1024 * 1024 + 3; ++i)
+        bases[i] = static_cast<char>(bases[i] | 0x20);
+    bases.replace(1500000, 300, std::string(300, 'N'));
+    for (size_t i = 1500300; i < 1500400; ++i)
+        bases[i] = static_cast<char>(bases[i] | 0x20);
+    bases.back() = static_cast<char>(bases.back() | 0x20);
+    std::string inputFile = "test_input.txt";
+    std::ofstream(inputFile, std::ios::binary) << bases;
+    std::string compressedFile = "test_output.pack2";
+    std::string decompressedFile = "test_decoded.txt";
+
+    EXPECT_NO_THROW(genome.encodeFromFile(inputFile, compressedFile));
+    EXPECT_NO_THROW(genome.decodeFromFile(compressedFile, decompressedFile));
+    EXPECT_TRUE(genome.validateDecodedFile(inputFile, decompressedFile));
+
+    // Eight toggles cost a few bytes on top of the packed bases
+    EXPECT_LT(genome.getMetrics().getCompressedSize(), static_cast<long long>(bases.size() * 2 + 64 * 8));
+
+    for (uint64_t start : {90ull, 4990ull, 1048540ull, 1500290ull, bases.size() - 5ull})
+    {
+        EXPECT_EQ(genome.decodeRange(compressedFile, start, 20), bases.substr(start, 20)) << start;
+    }
+
+    std::remove(inputFile.c_str());
+    std::remove(compressedFile.c_str());
+    std::remove(decompressedFile.c_str());
+}
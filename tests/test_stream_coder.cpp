@@ -0,0 +1,190 @@
+// StreamCoderTest.cpp
+#include <gtest/gtest.h>
+#include "../include/StreamCoder.h"
+#include "../include/CompressorFactory.h"
+#include "../include/FastaCompressor.h"
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <logger.h>
+
+// Encapsulate the Test Fixture in an Anonymous Namespace
+namespace {
+    class SuppressOutputStreamCoderTest : public ::testing::Test {
+    protected:
+        std::streambuf* original_cout;
+        std::streambuf* original_cerr;
+        std::ofstream null_stream;
+
+        void SetUp() override {
+            // Disable logging before any test code runs
+            Logger::getInstance().enableLogging(false);
+
+            // Open the null device based on the operating system
+        #ifdef _WIN32
+            null_stream.open("nul");
+        #else
+            null_stream.open("/dev/null");
+        #endif
+            if (!null_stream.is_open()) {
+                FAIL() << "Failed to open null device for output suppression.";
+            }
+
+            // Redirect std::cout and std::cerr to the null device
+            original_cout = std::cout.rdbuf(null_stream.rdbuf());
+            original_cerr = std::cerr.rdbuf(null_stream.rdbuf());
+        }
+
+        void TearDown() override {
+            // Restore the original buffers
+            std::cout.rdbuf(original_cout);
+            std::cerr.rdbuf(original_cerr);
+
+            // Close the null device
+            null_stream.close();
+        }
+    };
+
+    std::string randomBases(size_t length, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        const char bases[] = {'A', 'C', 'G', 'T'};
+        std::string sequence(length, 'A');
+        for (auto &ch : sequence) {
+            ch = bases[rng() % 4];
+        }
+        return sequence;
+    }
+
+    // Feeds `input` in uneven pieces and returns the stream archive
+    std::string encodeStream(Compressor &codec, const std::string &method, const std::string &input, size_t chunkSize)
+    {
+        StreamCoder coder(codec, method, chunkSize);
+        std::ostringstream out;
+        coder.begin(out, "test input");
+        for (size_t pos = 0; pos < input.size(); pos += 777) {
+            EXPECT_TRUE(coder.feed(input.data() + pos, std::min<size_t>(777, input.size() - pos)));
+        }
+        EXPECT_TRUE(coder.finish());
+        return out.str();
+    }
+
+    std::string decodeStream(const std::string &archive)
+    {
+        std::istringstream in(archive);
+        std::string method = StreamCoder::readHeader(in);
+        std::unique_ptr<Compressor> codec;
+        if (method == StreamCoder::FASTA_METHOD) {
+            codec = std::make_unique<FastaCompressor>("");
+        } else {
+            codec = CompressorFactory::createCompressor(method);
+        }
+        std::ostringstream out;
+        StreamCoder::decodeFrames(*codec, in, out);
+        return out.str();
+    }
+}
+
+TEST_F(SuppressOutputStreamCoderTest, RoundTripAcrossFrames)
+{
+    std::string input = randomBases(100003, 1) + "NNNNacgt" + randomBases(5000, 2);
+    for (const std::string method : {"huffmangenome", "pack2", "cm"}) {
+        std::unique_ptr<Compressor> codec = CompressorFactory::createCompressor(method);
+        std::string archive = encodeStream(*codec, method, input, 4096);
+        EXPECT_EQ(decodeStream(archive), input) << method;
+    }
+}
+
+TEST_F(SuppressOutputStreamCoderTest, DecodeFramesSumsTheirPhases)
+{
+    std::string input = randomBases(20000, 4);
+    std::unique_ptr<Compressor> codec = CompressorFactory::createCompressor("pack2");
+    std::istringstream in(encodeStream(*codec, "pack2", input, 4096));
+    StreamCoder::readHeader(in);
+
+    std::ostringstream out;
+    CompressionMetrics metrics = StreamCoder::decodeFrames(*codec, in, out);
+    EXPECT_EQ(out.str(), input);
+    EXPECT_EQ(metrics.getPhaseBytes(CompressionMetrics::Phase::Decoding), input.size());
+}
+
+TEST_F(SuppressOutputStreamCoderTest, EmptyInputRoundTrip)
+{
+    std::unique_ptr<Compressor> codec = CompressorFactory::createCompressor("pack2");
+    std::string archive = encodeStream(*codec, "pack2", "", 4096);
+    EXPECT_EQ(decodeStream(archive), "");
+}
+
+TEST_F(SuppressOutputStreamCoderTest, FastaFramesCutAtLineEnds)
+{
+    std::ostringstream text;
+    for (int r = 0; r < 20; ++r) {
+        text << ">chr" << r << " record\n";
+        std::string bases = randomBases(r == 7 ? 20000 : 900, static_cast<unsigned>(r));
+        for (size_t pos = 0; pos < bases.size(); pos += 60) {
+            text << bases.substr(pos, 60) << "\n";
+        }
+    }
+    FastaCompressor codec("pack2");
+    std::string archive = encodeStream(codec, StreamCoder::FASTA_METHOD, text.str(), 2000);
+    EXPECT_EQ(decodeStream(archive), text.str());
+}
+
+TEST_F(SuppressOutputStreamCoderTest, LongRecordSpansFrames)
+{
+    // One wrapped record of many chunks, one unwrapped line of many chunks, with both line ends
+    std::string bases = randomBases(30000, 5);
+    bases.replace(12000, 8, "acgtNNNN");
+    for (const std::string newline : {"\n", "\r\n"}) {
+        std::string wrapped = ">chr1 one long record" + newline;
+        for (size_t pos = 0; pos < bases.size(); pos += 60) {
+            wrapped += bases.substr(pos, 60) + newline;
+        }
+        std::string unwrapped = ">chr1" + newline + bases + newline + ">chr2" + newline + "ACGT";
+        for (const std::string &text : {wrapped, unwrapped}) {
+            FastaCompressor codec("huffmangenome");
+            std::string archive = encodeStream(codec, StreamCoder::FASTA_METHOD, text, 1000);
+            EXPECT_EQ(decodeStream(archive), text);
+        }
+    }
+
+    // A header line cannot be cut, so one still open after two chunks is refused
+    FastaCompressor codec("pack2");
+    StreamCoder coder(codec, StreamCoder::FASTA_METHOD, 1000);
+    std::ostringstream out;
+    coder.begin(out, "test input");
+    std::string header = ">" + std::string(2500, 'x');
+    EXPECT_THROW(coder.feed(header.data(), header.size()), std::runtime_error);
+}
+
+TEST_F(SuppressOutputStreamCoderTest, RejectsMethodWithoutSequenceCoding)
+{
+    std::unique_ptr<Compressor> codec = CompressorFactory::createCompressor("rle");
+    EXPECT_THROW(StreamCoder(*codec, "rle"), std::runtime_error);
+}
+
+TEST_F(SuppressOutputStreamCoderTest, InvalidByteInLaterFrameFails)
+{
+    std::string input = randomBases(10000, 3);
+    input[9000] = 'X';
+    std::unique_ptr<Compressor> codec = CompressorFactory::createCompressor("pack2");
+    StreamCoder coder(*codec, "pack2", 4096);
+    std::ostringstream out;
+    coder.begin(out, "test input");
+    EXPECT_FALSE(coder.feed(input.data(), input.size()) && coder.finish());
+}
+
+TEST_F(SuppressOutputStreamCoderTest, TruncatedStreamIsRejected)
+{
+    std::unique_ptr<Compressor> codec = CompressorFactory::createCompressor("huffmangenome");
+    std::string archive = encodeStream(*codec, "huffmangenome", randomBases(10000, 4), 4096);
+
+    // Without the end marker, and cut inside a frame
+    EXPECT_THROW(decodeStream(archive.substr(0, archive.size() - 8)), std::runtime_error);
+    EXPECT_THROW(decodeStream(archive.substr(0, archive.size() / 2)), std::runtime_error);
+
+    std::istringstream notStream("Pxxxx");
+    EXPECT_THROW(StreamCoder::readHeader(notStream), std::runtime_error);
+}